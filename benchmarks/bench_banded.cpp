@@ -0,0 +1,55 @@
+//
+//  bench_banded.cpp
+//  Created by Ben Westcott on 10/17/26.
+//
+
+/*
+ * The 1-D Poisson matrix (-1, 2, -1) at n = 10^6, which as a dense matrix
+ * would need 8 TB. Every routine is linear in n, bytes are those of the
+ * band (and of the widened band for the factorizations).
+ */
+void bench_banded(void)
+{
+    using namespace transformation::banded;
+
+    size_t n = 1000000;
+    size_t reps = 5;
+
+    tridiagonal_matrix<double> A(n);
+    for(size_t i=0; i < n; i++)
+    {
+        A.diag(i) = 2.0;
+        if(i > 0)
+        {
+            A.sub(i) = -1.0;
+        }
+        if(i + 1 < n)
+        {
+            A.super(i) = -1.0;
+        }
+    }
+
+    matrix<double> x = random_matrix::dense<double>(n, 1, -1, 1, 1, bench_pool);
+    matrix<double> b = band_mat_vec(A, x);
+    matrix<double> y(n, 1);
+    size_t bytes = 3 * n * sizeof(double);
+
+    std::cout << " n = " << n << " tridiagonal\n";
+
+    report("band_mat_vec", bytes + 2 * n * sizeof(double), best_of(reps, [&]() { band_mat_vec(1.0, A, x, 0.0, y.view()); }));
+    report("tridiagonal_solve", bytes + 3 * n * sizeof(double), best_of(reps, [&]() { y = tridiagonal_solve(A, b); }));
+
+    result::band_LU<double> lu = LU(A);
+    report("LU", 4 * n * sizeof(double), best_of(reps, [&]() { lu = LU(A); }));
+    report("LU solve", 5 * n * sizeof(double), best_of(reps, [&]() { y = solve(lu, b); }));
+
+    banded_matrix<double> L = cholesky(A);
+    report("cholesky", 2 * n * sizeof(double), best_of(reps, [&]() { L = cholesky(A); }));
+    report("cholesky_solve", 4 * n * sizeof(double), best_of(reps, [&]() { y = cholesky_solve(L, b); }));
+
+    banded_matrix<double> F = transformation::givens::band_QRfast(A);
+    report("band_QRfast", 4 * n * sizeof(double), best_of(reps, [&]() { F = transformation::givens::band_QRfast(A); }));
+    report("band_QR_solve", 5 * n * sizeof(double), best_of(reps, [&]() { y = transformation::givens::band_QR_solve(F, b); }));
+
+    std::cout << "  max error " << std::scientific << matrix<double>::abs_max_err(y, x) << std::fixed << "\n";
+}
@@ -0,0 +1,59 @@
+//
+//  bench_elementwise.cpp
+//  Created by Ben Westcott on 10/17/26.
+//
+
+/*
+ * Streaming elementwise members at every available instruction set, from
+ * cache resident to well past the last level cache, where they should sit
+ * at memcpy bandwidth. abs and absdiff return a new matrix, so their times
+ * include allocating and zeroing it.
+ */
+template<typename T>
+void bench_elementwise_size(size_t M, size_t N, size_t reps)
+{
+    std::cout << " " << M << " x " << N << " (" << sizeof(T) << "B elements)\n";
+
+    matrix<T> A = random_matrix::dense<T>(M, N, -1, 1, 1, bench_pool);
+    matrix<T> B = random_matrix::dense<T>(M, N, -1, 1, 2, bench_pool);
+    matrix<T> C(A);
+    matrix<T> out;
+    size_t bytes = M * N * sizeof(T);
+    bool eq = false;
+
+    report_memcpy(2 * bytes, reps);
+
+    simd::isa best = simd::detected_isa();
+    for(simd::isa level : {simd::isa::scalar, simd::isa::sse2, simd::isa::avx2, simd::isa::avx512})
+    {
+        if(level > best)
+        {
+            continue;
+        }
+        simd::set_isa(level);
+        std::string isa = std::string(simd::isa_name(level)) + " ";
+
+        report(isa + "fill", bytes, best_of(reps, [&]() { C.fill(static_cast<T>(1)); }));
+        report(isa + "+=", 3 * bytes, best_of(reps, [&]() { C += B; }));
+        report(isa + "*=", 2 * bytes, best_of(reps, [&]() { C *= 0.5; }));
+        report(isa + "abs", 2 * bytes, best_of(reps, [&]() { out = matrix<T>::abs(A); }));
+        report(isa + "absdiff", 3 * bytes, best_of(reps, [&]() { out = matrix<T>::absdiff(A, B); }));
+
+        C = A;
+        report(isa + "content_equals", 2 * bytes, best_of(reps, [&]() { eq = C.content_equals(A); }));
+    }
+    simd::set_isa(best);
+
+    if(!eq)
+    {
+        std::cout << "  content_equals failed\n";
+    }
+}
+
+void bench_elementwise(void)
+{
+    bench_elementwise_size<double>(64, 64, 200);
+    bench_elementwise_size<double>(4096, 4096, 5);
+    bench_elementwise_size<float>(4096, 4096, 5);
+    bench_elementwise_size<int>(4096, 4096, 5);
+}
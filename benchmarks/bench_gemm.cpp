@@ -0,0 +1,96 @@
+//
+//  bench_gemm.cpp
+//  Created by Ben Westcott on 10/17/26.
+//
+
+/*
+ * C <- A * B for square n x n operands at every available instruction set,
+ * reported in GFLOP/s (2 n^3 flops). Past the smallest size the operands
+ * no longer fit in cache, so anything far below the small size figure is
+ * a blocking problem, not a kernel one.
+ */
+void report_gflops(std::string const& name, size_t flops, uint64_t ns)
+{
+    std::cout << "  " << std::left << std::setw(36) << name << std::right
+              << std::setw(12) << std::fixed << std::setprecision(3) << ns * 1e-6 << " ms"
+              << std::setw(10) << std::setprecision(2) << static_cast<double>(flops)/ns << " GFLOP/s\n";
+}
+
+template<typename T>
+void bench_gemm_size(size_t n, size_t reps)
+{
+    std::cout << " " << n << " x " << n << " (" << sizeof(T) << "B elements)\n";
+
+    matrix<T> A = random_matrix::dense<T>(n, n, -1, 1, 1, bench_pool);
+    matrix<T> B = random_matrix::dense<T>(n, n, -1, 1, 2, bench_pool);
+    matrix<T> C(n, n);
+    size_t flops = 2 * n * n * n;
+
+    simd::isa best = simd::detected_isa();
+    for(simd::isa level : {simd::isa::scalar, simd::isa::sse2, simd::isa::avx2, simd::isa::avx512})
+    {
+        // the scalar kernels take minutes at the large sizes
+        if(level > best || (level < simd::isa::avx2 && n > 1024))
+        {
+            continue;
+        }
+        simd::set_isa(level);
+        std::string isa = std::string(simd::isa_name(level)) + " ";
+
+        report_gflops(isa + "mat_mul", flops, best_of(reps, [&]() { mat_mul(static_cast<T>(1), A, B, static_cast<T>(0), C.view()); }));
+    }
+    simd::set_isa(best);
+
+    matrix<T, layout_left> Af(A);
+    report_gflops("column-major A", flops, best_of(reps, [&]() { mat_mul(static_cast<T>(1), Af, B, static_cast<T>(0), C.view()); }));
+    report_gflops("pool", flops, best_of(reps, [&]() { mat_mul(static_cast<T>(1), A, B, static_cast<T>(0), C.view(), bench_pool); }));
+}
+
+void bench_gemm(void)
+{
+    bench_gemm_size<double>(256, 20);
+    bench_gemm_size<double>(1024, 3);
+    bench_gemm_size<double>(2048, 2);
+    bench_gemm_size<float>(256, 20);
+    bench_gemm_size<float>(2048, 2);
+}
+
+/*
+ * Strong scaling of the pool overload: the same product on pools of 1, 2,
+ * 4, ... workers, up to 64 or the hardware threads, with the speedup and
+ * the parallel efficiency against one worker. Shapes are square, a
+ * tall-skinny block update (M >> N = K) and a short-wide one (N >> M),
+ * which has few row blocks and leans on the column tiling.
+ */
+template<typename T>
+void bench_gemm_scaling_shape(size_t M, size_t N, size_t K, size_t reps)
+{
+    std::cout << " " << M << " x " << K << " times " << K << " x " << N << " (" << sizeof(T) << "B elements)\n";
+
+    matrix<T> A = random_matrix::dense<T>(M, K, -1, 1, 1, bench_pool);
+    matrix<T> B = random_matrix::dense<T>(K, N, -1, 1, 2, bench_pool);
+    matrix<T> C(M, N);
+    size_t flops = 2 * M * N * K;
+    size_t max_threads = std::min<size_t>(64, std::max(1u, std::thread::hardware_concurrency()));
+
+    uint64_t one = 0;
+    for(size_t threads=1; threads <= max_threads; threads *= 2)
+    {
+        tdpool pool(threads);
+        uint64_t ns = best_of(reps, [&]() { mat_mul(static_cast<T>(1), A, B, static_cast<T>(0), C.view(), pool); });
+        one = (threads == 1) ? ns : one;
+
+        double speedup = static_cast<double>(one)/ns;
+        report_gflops(std::to_string(threads) + " threads", flops, ns);
+        std::cout << "    speedup " << std::setprecision(2) << speedup
+                  << ", efficiency " << std::setprecision(0) << 100 * speedup/threads << "%\n";
+    }
+}
+
+void bench_gemm_scaling(void)
+{
+    bench_gemm_scaling_shape<double>(4096, 4096, 4096, 2);
+    bench_gemm_scaling_shape<double>(65536, 256, 256, 3);
+    bench_gemm_scaling_shape<double>(256, 65536, 256, 3);
+    bench_gemm_scaling_shape<float>(4096, 4096, 4096, 2);
+}
@@ -0,0 +1,91 @@
+//
+//  bench_gemv.cpp
+//  Created by Ben Westcott on 10/17/26.
+//
+
+/*
+ * gemv in both layouts and both ops. Bytes are those of A, so streaming A
+ * once runs at about memcpy bandwidth once A is out of cache. The
+ * element-wise loop is what inner_left_prod used to do, column by column.
+ */
+template<typename T>
+void bench_gemv_size(size_t m, size_t n, size_t reps)
+{
+    std::cout << " " << m << " x " << n << " (" << sizeof(T) << "B elements)\n";
+
+    matrix<T> A = random_matrix::dense<T>(m, n, -1, 1, 1, bench_pool);
+    matrix<T, layout_left> Af(A);
+    matrix<T> x = random_matrix::dense<T>(std::max(m, n), 1, -1, 1, 2, bench_pool);
+    matrix<T> y(std::max(m, n), 1);
+    size_t bytes = m * n * sizeof(T);
+
+    auto xn = x.view().sub_matrix(0, n, 0, 1);
+    auto xt = x.view().sub_matrix(0, m, 0, 1);
+    auto yn = y.view().sub_matrix(0, m, 0, 1);
+    auto yt = y.view().sub_matrix(0, n, 0, 1);
+
+    report_memcpy(bytes, reps);
+    report("row-major, N", bytes, best_of(reps, [&]() { gemv(static_cast<T>(1), A, xn, static_cast<T>(0), yn); }));
+    report("row-major, T", bytes, best_of(reps, [&]() { gemv(static_cast<T>(1), A, xt, static_cast<T>(0), yt, trans::T); }));
+    report("column-major, N", bytes, best_of(reps, [&]() { gemv(static_cast<T>(1), Af, xn, static_cast<T>(0), yn); }));
+    report("column-major, T", bytes, best_of(reps, [&]() { gemv(static_cast<T>(1), Af, xt, static_cast<T>(0), yt, trans::T); }));
+
+    report("row-major, T, element loop", bytes, best_of(reps, [&]()
+    {
+        for(size_t c=0; c < n; c++)
+        {
+            T s = static_cast<T>(0);
+            for(size_t r=0; r < m; r++)
+            {
+                s += xt(r, 0) * A(r, c);
+            }
+            yt(c, 0) = s;
+        }
+    }));
+}
+
+void bench_gemv(void)
+{
+    bench_gemv_size<double>(256, 256, 200);
+    bench_gemv_size<double>(4096, 4096, 5);
+    bench_gemv_size<float>(4096, 4096, 5);
+}
+
+/*
+ * One reflector applied to A from the left, fused against the two passes
+ * it replaced (v^T A into a scratch row, then A -= beta v w), and a whole
+ * QR. Bytes are those of A read and written once.
+ */
+void bench_reflector_size(size_t m, size_t n, size_t reps)
+{
+    std::cout << " " << m << " x " << n << "\n";
+
+    matrix<double> A = random_matrix::dense<double>(m, n, -1, 1, 1, bench_pool);
+    matrix<double, layout_left> Af(A);
+    matrix<double> v = random_matrix::dense<double>(m, 1, -1, 1, 2, bench_pool);
+    matrix<double> w(1, n);
+    double beta = 2/inner_prod_1D(v, v);
+    size_t bytes = 2 * m * n * sizeof(double);
+
+    report_memcpy(bytes, reps);
+    report("two passes", bytes, best_of(reps, [&]()
+    {
+        inner_left_prod(v, A, w.view());
+        A.view() -= beta * outer(v, w);
+    }));
+    report("apply_reflector", bytes, best_of(reps, [&]() { apply_reflector(A.view(), v, beta); }));
+    report("apply_reflector, column-major", bytes, best_of(reps, [&]() { apply_reflector(Af.view(), v, beta); }));
+    report("apply_reflector, right", bytes, best_of(reps, [&]() { apply_reflector(A.view().transpose(), v, beta, side::right); }));
+}
+
+void bench_reflector(void)
+{
+    bench_reflector_size(512, 512, 100);
+    bench_reflector_size(4096, 4096, 5);
+
+    size_t n = 1024;
+    matrix<double> A = random_matrix::dense<double>(n, n, -1, 1, 3, bench_pool);
+    matrix<double> F;
+    uint64_t ns = best_of(3, [&]() { F = A; transformation::house::QRfast(F); });
+    std::cout << " QRfast " << n << " x " << n << ": " << std::setprecision(3) << ns * 1e-6 << " ms\n";
+}
@@ -0,0 +1,118 @@
+//
+//  bench_main.cpp
+//  Created by Ben Westcott on 10/17/26.
+//
+
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <thread>
+#include <random>
+#include <cmath>
+
+#include "matrix.h"
+#include "banded_matrix.h"
+#include "csr_matrix.h"
+#include "random_matrix.h"
+#include "gemm.h"
+#include "products.h"
+#include "householder.h"
+#include "givens.h"
+#include "simd_kernels.h"
+#include "stats.h"
+#include "tdpool.h"
+
+/*
+ * Throughput benchmarks, run as
+ *
+ *      bench [name ...]
+ *
+ * with no names running everything. Each case reports the best of a few
+ * repetitions, both as time and as effective bandwidth (bytes read plus
+ * bytes written over time), next to memcpy of the same number of bytes as
+ * the ceiling for anything memory bound.
+ */
+
+size_t bench_pool_size = std::max(1u, std::thread::hardware_concurrency());
+tdpool bench_pool(bench_pool_size);
+
+// best wall time over reps runs of f, in ns
+template<typename F>
+uint64_t best_of(size_t reps, F&& f)
+{
+    uint64_t best = UINT64_MAX;
+    for(size_t i=0; i < reps; i++)
+    {
+        uint64_t elapsed = 0;
+        time_exec(elapsed, [&]() { f(); return 0; });
+        best = std::min(best, elapsed);
+    }
+    return best;
+}
+
+void report(std::string const& name, size_t bytes, uint64_t ns)
+{
+    std::cout << "  " << std::left << std::setw(36) << name << std::right
+              << std::setw(12) << std::fixed << std::setprecision(3) << ns * 1e-6 << " ms"
+              << std::setw(10) << std::setprecision(2) << static_cast<double>(bytes)/ns << " GB/s\n";
+}
+
+// memcpy reference for a move of bytes/2 bytes (read + write = bytes)
+void report_memcpy(size_t bytes, size_t reps)
+{
+    std::vector<char> src(bytes/2, 1), dst(bytes/2);
+    report("memcpy", bytes, best_of(reps, [&]() { std::memcpy(dst.data(), src.data(), src.size()); }));
+}
+
+#include "bench_transpose.cpp"
+#include "bench_elementwise.cpp"
+#include "bench_banded.cpp"
+#include "bench_sparse.cpp"
+#include "bench_gemm.cpp"
+#include "bench_strassen.cpp"
+#include "bench_gemv.cpp"
+
+struct bench_case
+{
+    char const* name;
+    void (*run)(void);
+};
+
+int main(int argc, char** argv)
+{
+    bench_case cases[] =
+    {
+        {"transpose", bench_transpose},
+        {"elementwise", bench_elementwise},
+        {"banded", bench_banded},
+        {"sparse", bench_sparse},
+        {"gemm", bench_gemm},
+        {"gemm_scaling", bench_gemm_scaling},
+        {"strassen", bench_strassen},
+        {"gemv", bench_gemv},
+        {"reflector", bench_reflector},
+    };
+
+    std::cout << "pool threads: " << bench_pool_size << ", simd: " << simd::isa_name(simd::detected_isa()) << "\n";
+
+    for(auto& bc : cases)
+    {
+        bool selected = (argc == 1);
+        for(int i=1; i < argc; i++)
+        {
+            selected |= (std::strcmp(argv[i], bc.name) == 0);
+        }
+
+        if(selected)
+        {
+            std::cout << bc.name << ":\n";
+            bc.run();
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,73 @@
+//
+//  bench_sparse.cpp
+//  Created by Ben Westcott on 10/17/26.
+//
+
+/*
+ * SpMV and SpMM on two synthetic patterns of about the same nonzero count:
+ *
+ *  - banded: 2k + 1 diagonals, like a 1-D FEM stiffness matrix. Rows are
+ *    all alike and x is read almost sequentially.
+ *  - power law: row i has about d (n/(i+1))^(1/2) nonzeros at random
+ *    columns, like a graph Laplacian with hubs. A few rows hold a large
+ *    share of the nonzeros and x is gathered at random.
+ *
+ * Bytes are those of the matrix (values, columns, row pointers) plus x and
+ * y, so the figure is comparable to memcpy.
+ */
+template<typename T>
+void bench_sparse_pattern(std::string const& name, csr_matrix<T> const& A, size_t reps)
+{
+    size_t n = A.rows();
+    std::cout << " " << name << ", n = " << n << ", nnz = " << A.nnz() << "\n";
+
+    matrix<T> x = random_matrix::dense<T>(n, 1, -1, 1, 1, bench_pool);
+    matrix<T> y(n, 1);
+    size_t bytes = A.nnz() * (sizeof(T) + sizeof(size_t)) + (n + 1) * sizeof(size_t) + 2 * n * sizeof(T);
+
+    report_memcpy(bytes, reps);
+    report("spmv", bytes, best_of(reps, [&]() { sp_mat_vec(static_cast<T>(1.0), A, x, static_cast<T>(0.0), y.view()); }));
+    report("spmv, pool", bytes, best_of(reps, [&]() { sp_mat_vec(static_cast<T>(1.0), A, x, static_cast<T>(0.0), y.view(), bench_pool); }));
+
+    size_t K = 8;
+    matrix<T> B = random_matrix::dense<T>(n, K, -1, 1, 2, bench_pool);
+    matrix<T> C;
+    size_t mm_bytes = A.nnz() * (sizeof(T) + sizeof(size_t)) + (n + 1) * sizeof(size_t) + 2 * n * K * sizeof(T);
+    report("spmm, 8 columns", mm_bytes, best_of(reps, [&]() { C = sp_mat_mul(A, B); }));
+    report("spmm, 8 columns, pool", mm_bytes, best_of(reps, [&]() { C = sp_mat_mul(A, B, bench_pool); }));
+
+    csr_matrix<T> At;
+    report("transpose", 2 * A.nnz() * (sizeof(T) + sizeof(size_t)), best_of(reps, [&]() { At = A.transpose(); }));
+}
+
+void bench_sparse(void)
+{
+    size_t n = 1 << 20;
+    size_t k = 5;
+    size_t reps = 5;
+
+    std::vector<triplet<double>> entries;
+    entries.reserve(n * (2 * k + 1));
+    for(size_t i=0; i < n; i++)
+    {
+        for(size_t j = (i > k) ? i - k : 0; j < std::min(n, i + k + 1); j++)
+        {
+            entries.push_back({i, j, (i == j) ? 2.0 * k : -1.0});
+        }
+    }
+    bench_sparse_pattern("banded", csr_matrix<double>(n, n, entries), reps);
+
+    std::minstd_rand gen(7);
+    std::uniform_int_distribution<size_t> col(0, n - 1);
+    double d = 2.0;
+    entries.clear();
+    for(size_t i=0; i < n; i++)
+    {
+        size_t deg = 1 + static_cast<size_t>(d * std::sqrt(static_cast<double>(n)/(i + 1)));
+        for(size_t c=0; c < deg; c++)
+        {
+            entries.push_back({i, col(gen), 1.0});
+        }
+    }
+    bench_sparse_pattern("power law", csr_matrix<double>(n, n, entries), reps);
+}
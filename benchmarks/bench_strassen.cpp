@@ -0,0 +1,48 @@
+//
+//  bench_strassen.cpp
+//  Created by Ben Westcott on 10/17/26.
+//
+
+/*
+ * mat_mul_strassen against mat_mul for a few leaf sizes. Rates are
+ * effective, 2 n^3 over the time, so they are comparable with mat_mul's.
+ * The error is the largest difference from mat_mul relative to
+ * n max|A| max|B| (= n here), the scale of the normwise bound.
+ */
+template<typename T>
+void bench_strassen_size(size_t n, size_t reps)
+{
+    std::cout << " " << n << " x " << n << " (" << sizeof(T) << "B elements)\n";
+
+    matrix<T> A = random_matrix::dense<T>(n, n, -1, 1, 1, bench_pool);
+    matrix<T> B = random_matrix::dense<T>(n, n, -1, 1, 2, bench_pool);
+    matrix<T> C(n, n), S(n, n);
+    size_t flops = 2 * n * n * n;
+
+    report_gflops("mat_mul", flops, best_of(reps, [&]() { mat_mul(static_cast<T>(1), A, B, static_cast<T>(0), C.view()); }));
+
+    for(size_t leaf : {256, 512, 1024})
+    {
+        std::string name = "strassen, leaf " + std::to_string(leaf);
+        report_gflops(name, flops, best_of(reps, [&]() { mat_mul_strassen(A, B, S.view(), leaf); }));
+        report_gflops(name + ", pool", flops, best_of(reps, [&]() { mat_mul_strassen(A, B, S.view(), bench_pool, leaf); }));
+
+        double err = 0;
+        for(size_t i=0; i < n; i++)
+        {
+            for(size_t j=0; j < n; j++)
+            {
+                err = std::max(err, std::abs(static_cast<double>(S(i, j)) - static_cast<double>(C(i, j))));
+            }
+        }
+        std::cout << "    levels " << strassen_detail::levels(n, n, n, leaf)
+                  << ", error vs mat_mul " << std::scientific << std::setprecision(2) << err/n << std::fixed << "\n";
+    }
+}
+
+void bench_strassen(void)
+{
+    bench_strassen_size<double>(2048, 2);
+    bench_strassen_size<double>(4096, 1);
+    bench_strassen_size<float>(4096, 1);
+}
@@ -0,0 +1,54 @@
+//
+//  bench_transpose.cpp
+//  Created by Ben Westcott on 10/17/26.
+//
+
+template<typename T>
+matrix<T> naive_transpose(matrix<T> const& A)
+{
+    matrix<T> tm(A.cols(), A.rows());
+    for(size_t r=0; r < A.rows(); r++)
+    {
+        for(size_t c=0; c < A.cols(); c++)
+        {
+            tm(c, r) = A(r, c);
+        }
+    }
+    return tm;
+}
+
+template<typename T>
+void bench_transpose_size(size_t M, size_t N, size_t reps)
+{
+    std::cout << " " << M << " x " << N << " (" << sizeof(T) << "B elements)\n";
+
+    matrix<T> A = random_matrix::dense<T>(M, N, -1, 1, 1, bench_pool);
+    size_t bytes = 2 * M * N * sizeof(T);
+
+    // keep the results alive so nothing is optimized out
+    matrix<T> out;
+
+    report_memcpy(bytes, reps);
+    report("naive", bytes, best_of(reps, [&]() { out = naive_transpose(A); }));
+    report("blocked", bytes, best_of(reps, [&]() { out = A.transpose(); }));
+    report("blocked, pool", bytes, best_of(reps, [&]() { out = A.transpose(bench_pool); }));
+
+    // the above include allocating (and zeroing) the result, this is the kernel alone
+    matrix<T> dst(N, M);
+    report("blocked, kernel only", bytes, best_of(reps, [&]() { transpose_block(A.data(), A.stride(), dst.data(), dst.stride(), M, N); }));
+    report("blocked, kernel only, pool", bytes, best_of(reps, [&]() { transpose_block(A.data(), A.stride(), dst.data(), dst.stride(), M, N, bench_pool); }));
+
+    if(M == N)
+    {
+        report("in place", bytes, best_of(reps, [&]() { A.transpose_in_place(); }));
+        report("in place, pool", bytes, best_of(reps, [&]() { A.transpose_in_place(bench_pool); }));
+    }
+}
+
+void bench_transpose(void)
+{
+    bench_transpose_size<double>(512, 512, 20);
+    bench_transpose_size<double>(4096, 4096, 5);
+    bench_transpose_size<double>(3000, 5000, 5);
+    bench_transpose_size<float>(4096, 4096, 5);
+}
@@ -0,0 +1,63 @@
+//
+//  aligned_allocator.h
+//  Created by Ben Westcott on 10/17/26.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <new>
+
+using std::size_t;
+
+/*
+ * Default storage policy for matrix<T>.
+ *
+ * Hands out raw (unconstructed) storage aligned to Align bytes, so row
+ * starts of a padded matrix (see matrix<T>::padded) land on cache line
+ * and vector register boundaries. Construction/destruction of the elements
+ * is done by matrix.
+ *
+ * Any type with the same allocate/deallocate interface can be used as the
+ * allocator policy of a matrix.
+ */
+template<typename T, size_t Align = 64>
+struct aligned_allocator
+{
+    using value_type = T;
+    
+    static constexpr size_t alignment = (Align < alignof(T)) ? alignof(T) : Align;
+
+    template<typename U>
+    struct rebind
+    {
+        using other = aligned_allocator<U, Align>;
+    };
+    
+    aligned_allocator(void) = default;
+    
+    template<typename U>
+    aligned_allocator(aligned_allocator<U, Align> const&) noexcept {}
+
+    T* allocate(size_t n)
+    {
+        return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(alignment)));
+    }
+
+    void deallocate(T* p, size_t) noexcept
+    {
+        ::operator delete(p, std::align_val_t(alignment));
+    }
+    
+    // number of elements of T spanning one alignment boundary
+    static constexpr size_t elements_per_line(void)
+    {
+        return (alignment % sizeof(T) == 0) ? alignment / sizeof(T) : 1;
+    }
+};
+
+template<typename T, typename U, size_t Align>
+bool operator==(aligned_allocator<T, Align> const&, aligned_allocator<U, Align> const&) { return true; }
+
+template<typename T, typename U, size_t Align>
+bool operator!=(aligned_allocator<T, Align> const&, aligned_allocator<U, Align> const&) { return false; }
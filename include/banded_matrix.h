@@ -0,0 +1,545 @@
+//
+//  banded_matrix.h
+//  Created by Ben Westcott on 10/17/26.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <stdexcept>
+#include <utility>
+#include "matrix.h"
+#include "matrix_expr.h"
+#include "matrix_view.h"
+#include "workspace.h"
+
+using std::size_t;
+
+/*
+ * n x n matrix with kl sub and ku super diagonals, storing only the band.
+ * Row i of the storage holds A(i, i - kl) ... A(i, i + ku), so
+ *
+ *      A(i, j) = band(i, j - i + kl)
+ *
+ * and every row of the band is contiguous, which is the order mat-vec,
+ * elimination and row rotations walk it in. Slots falling outside of A in
+ * the first kl and last ku rows are kept zero.
+ *
+ * operator() may only be used inside the band, entry() reads anywhere.
+ */
+template<typename T, typename Alloc = aligned_allocator<T>>
+class banded_matrix
+{
+public:
+    using value_type = T;
+
+    banded_matrix(size_t n, size_t kl, size_t ku);
+
+    // the band of a square matrix or view, everything outside is not read
+    template<typename M>
+        requires matrix_like<M>
+    banded_matrix(M const& full, size_t kl, size_t ku);
+
+    size_t size(void) const { return m_n * m_n; }
+    size_t rows(void) const { return m_n; }
+    size_t cols(void) const { return m_n; }
+
+    size_t lower_bandwidth(void) const { return m_kl; }
+    size_t upper_bandwidth(void) const { return m_ku; }
+    size_t width(void) const { return m_kl + m_ku + 1; }
+
+    bool in_band(size_t i, size_t j) const { return j + m_kl >= i && i + m_ku >= j; }
+
+    // columns of the band in row i, [first_col, last_col)
+    size_t first_col(size_t i) const { return (i > m_kl) ? i - m_kl : 0; }
+    size_t last_col(size_t i) const { return std::min(m_n, i + m_ku + 1); }
+
+    T& operator()(size_t i, size_t j) { return m_band.data()[i * width() + j + m_kl - i]; }
+    T const& operator()(size_t i, size_t j) const { return m_band.data()[i * width() + j + m_kl - i]; }
+
+    T entry(size_t i, size_t j) const { return in_band(i, j) ? (*this)(i, j) : static_cast<T>(0.0); }
+
+    // the band storage, n x (kl + ku + 1)
+    matrix_view<T> band_view(void) { return m_band.view(); }
+    matrix_view<T const> band_view(void) const { return m_band.view(); }
+
+    void zero(void) { m_band.fill(static_cast<T>(0.0)); }
+
+    template<typename R>
+    banded_matrix<T, Alloc>& operator*=(R scalar);
+
+    matrix<T> full(void) const;
+
+    // same matrix with room for wider bands, e.g. for the fill-in of a factorization
+    banded_matrix<T, Alloc> widened(size_t kl, size_t ku) const;
+
+private:
+
+    size_t m_n;
+    size_t m_kl;
+    size_t m_ku;
+    matrix<T, layout_right, Alloc> m_band;
+};
+
+template<typename T, typename Alloc>
+banded_matrix<T, Alloc>::banded_matrix(size_t n, size_t kl, size_t ku)
+: m_n(n), m_kl(kl), m_ku(ku), m_band(n, kl + ku + 1)
+{
+}
+
+template<typename T, typename Alloc>
+template<typename M>
+    requires matrix_like<M>
+banded_matrix<T, Alloc>::banded_matrix(M const& full, size_t kl, size_t ku)
+: banded_matrix<T, Alloc>(full.rows(), kl, ku)
+{
+    if(full.rows() != full.cols())
+    {
+        throw std::range_error("banded_matrix: matrix must be square.");
+    }
+
+    for(size_t i=0; i < m_n; i++)
+    {
+        for(size_t j=first_col(i); j < last_col(i); j++)
+        {
+            (*this)(i, j) = static_cast<T>(full(i, j));
+        }
+    }
+}
+
+template<typename T, typename Alloc>
+template<typename R>
+banded_matrix<T, Alloc>& banded_matrix<T, Alloc>::operator*=(R scalar)
+{
+    m_band *= scalar;
+    return *this;
+}
+
+template<typename T, typename Alloc>
+matrix<T> banded_matrix<T, Alloc>::full(void) const
+{
+    matrix<T> res(m_n, m_n);
+    for(size_t i=0; i < m_n; i++)
+    {
+        for(size_t j=first_col(i); j < last_col(i); j++)
+        {
+            res(i, j) = (*this)(i, j);
+        }
+    }
+    return res;
+}
+
+template<typename T, typename Alloc>
+banded_matrix<T, Alloc> banded_matrix<T, Alloc>::widened(size_t kl, size_t ku) const
+{
+    if(kl < m_kl || ku < m_ku)
+    {
+        throw std::range_error("widened: bandwidths can not shrink.");
+    }
+
+    banded_matrix<T, Alloc> res(m_n, kl, ku);
+    for(size_t i=0; i < m_n; i++)
+    {
+        size_t j0 = first_col(i);
+        std::copy(&(*this)(i, j0), &(*this)(i, j0) + (last_col(i) - j0), &res(i, j0));
+    }
+    return res;
+}
+
+/*
+ * The two most common bandwidths. They are banded_matrix, so every banded
+ * routine takes them, and add the names of their diagonals plus an O(n)
+ * solve without the generality (and the pivoting) of banded LU.
+ */
+template<typename T, typename Alloc = aligned_allocator<T>>
+class tridiagonal_matrix : public banded_matrix<T, Alloc>
+{
+public:
+    explicit tridiagonal_matrix(size_t n)
+    : banded_matrix<T, Alloc>(n, 1, 1) {}
+
+    template<typename M>
+        requires matrix_like<M>
+    explicit tridiagonal_matrix(M const& full)
+    : banded_matrix<T, Alloc>(full, 1, 1) {}
+
+    // A(i, i - 1), A(i, i), A(i, i + 1)
+    T& sub(size_t i) { return (*this)(i, i - 1); }
+    T& diag(size_t i) { return (*this)(i, i); }
+    T& super(size_t i) { return (*this)(i, i + 1); }
+
+    T const& sub(size_t i) const { return (*this)(i, i - 1); }
+    T const& diag(size_t i) const { return (*this)(i, i); }
+    T const& super(size_t i) const { return (*this)(i, i + 1); }
+};
+
+// upper bidiagonal
+template<typename T, typename Alloc = aligned_allocator<T>>
+class bidiagonal_matrix : public banded_matrix<T, Alloc>
+{
+public:
+    explicit bidiagonal_matrix(size_t n)
+    : banded_matrix<T, Alloc>(n, 0, 1) {}
+
+    template<typename M>
+        requires matrix_like<M>
+    explicit bidiagonal_matrix(M const& full)
+    : banded_matrix<T, Alloc>(full, 0, 1) {}
+
+    // A(i, i), A(i, i + 1)
+    T& diag(size_t i) { return (*this)(i, i); }
+    T& super(size_t i) { return (*this)(i, i + 1); }
+
+    T const& diag(size_t i) const { return (*this)(i, i); }
+    T const& super(size_t i) const { return (*this)(i, i + 1); }
+};
+
+/*
+ * y <- alpha * A * x + beta * y, O(n * (kl + ku + 1)).
+ *
+ * Each y(i) is the inner product of the contiguous row i of the band with
+ * a contiguous run of x.
+ */
+template<typename T, typename Alloc, typename X>
+void band_mat_vec(T alpha, banded_matrix<T, Alloc> const& A, X const& x, T beta, matrix_view<T> const& y)
+{
+    size_t n = A.rows();
+    if(x.size() != n || y.size() != n)
+    {
+        throw std::range_error("band_mat_vec: incorrect dimensions.");
+    }
+
+    for(size_t i=0; i < n; i++)
+    {
+        size_t j0 = A.first_col(i);
+        size_t j1 = A.last_col(i);
+        T const* row = &A(i, j0);
+
+        T acc = static_cast<T>(0.0);
+        for(size_t j=j0; j < j1; j++)
+        {
+            acc += row[j - j0] * x[j];
+        }
+
+        y[i] = (beta == static_cast<T>(0.0)) ? alpha * acc : alpha * acc + beta * y[i];
+    }
+}
+
+// A * x as a column vector
+template<typename T, typename Alloc, typename X>
+matrix<T> band_mat_vec(banded_matrix<T, Alloc> const& A, X const& x)
+{
+    matrix<T> y(A.rows(), 1);
+    band_mat_vec(static_cast<T>(1.0), A, x, static_cast<T>(0.0), y.view());
+    return y;
+}
+
+namespace result
+{
+
+/*
+ * Banded LU with partial pivoting. Row interchanges widen U to kl + ku
+ * super diagonals, so F is A widened to (kl, kl + ku): U in and above the
+ * diagonal, the multipliers of step i below it in column i. P(0, i) is
+ * the row swapped with row i at step i.
+ */
+template<typename T>
+struct band_LU
+{
+    banded_matrix<T> F;
+    matrix<size_t> P;
+    bool degenerate;
+
+    band_LU(banded_matrix<T> const& f, matrix<size_t> const& p, bool deg)
+    : F(f), P(p), degenerate(deg) {}
+};
+
+}
+
+namespace transformation
+{
+
+namespace banded
+{
+
+// refs:
+// [1] Matrix Computations 4th ed. Golub, Van Loan, 4.3
+
+/*
+ * O(n * kl * (kl + ku)). Like LU in lu_decomp.h, a column without a
+ * nonzero pivot marks the factorization degenerate and is skipped.
+ */
+template<typename T, typename Alloc>
+result::band_LU<T> LU(banded_matrix<T, Alloc> const& A)
+{
+    size_t n = A.rows();
+    size_t kl = A.lower_bandwidth();
+    size_t ku = A.upper_bandwidth() + kl;
+
+    banded_matrix<T> F(n, kl, ku);
+    for(size_t i=0; i < n; i++)
+    {
+        for(size_t j=A.first_col(i); j < A.last_col(i); j++)
+        {
+            F(i, j) = A(i, j);
+        }
+    }
+
+    matrix<size_t> P(1, n);
+    bool degenerate = false;
+
+    for(size_t i=0; i < n; i++)
+    {
+        size_t last = std::min(n, i + kl + 1);
+        size_t jend = std::min(n, i + ku + 1);
+
+        size_t p = i;
+        for(size_t r=i+1; r < last; r++)
+        {
+            if(std::abs(F(r, i)) > std::abs(F(p, i)))
+            {
+                p = r;
+            }
+        }
+
+        P(0, i) = p;
+
+        // rows i and p are both zero right of i + ku
+        if(p != i)
+        {
+            std::swap_ranges(&F(i, i), &F(i, i) + (jend - i), &F(p, i));
+        }
+
+        if(F(i, i) == static_cast<T>(0.0))
+        {
+            degenerate = true;
+            continue;
+        }
+
+        T const* urow = &F(i, i);
+        for(size_t r=i+1; r < last; r++)
+        {
+            T* row = &F(r, i);
+            T l = row[0]/urow[0];
+            row[0] = l;
+
+            for(size_t j=1; j < jend - i; j++)
+            {
+                row[j] -= l * urow[j];
+            }
+        }
+    }
+
+    return result::band_LU<T>(F, P, degenerate);
+}
+
+// solves U x = b in place, U is the upper part of a band
+template<typename T, typename Alloc>
+void back_substitution(banded_matrix<T, Alloc> const& U, matrix<T>& x)
+{
+    for(size_t i=U.rows(); i-- > 0;)
+    {
+        size_t jend = U.last_col(i);
+        T const* row = &U(i, i);
+
+        T sum = x(i, 0);
+        for(size_t j=i+1; j < jend; j++)
+        {
+            sum -= row[j - i] * x(j, 0);
+        }
+
+        x(i, 0) = sum/row[0];
+    }
+}
+
+// x with A x = b for b a column vector, from the factors of LU(A)
+template<typename T>
+matrix<T> solve(result::band_LU<T> const& lu, matrix<T> const& b)
+{
+    banded_matrix<T> const& F = lu.F;
+    size_t n = F.rows();
+    size_t kl = F.lower_bandwidth();
+
+    if(b.rows() != n || b.cols() != 1)
+    {
+        throw std::range_error("solve: incorrect dimensions.");
+    }
+    if(lu.degenerate)
+    {
+        throw std::range_error("solve: matrix is singular.");
+    }
+
+    matrix<T> x(b);
+    for(size_t i=0; i < n; i++)
+    {
+        std::swap(x(i, 0), x(lu.P(0, i), 0));
+
+        for(size_t r=i+1; r < std::min(n, i + kl + 1); r++)
+        {
+            x(r, 0) -= F(r, i) * x(i, 0);
+        }
+    }
+
+    back_substitution(F, x);
+    return x;
+}
+
+/*
+ * A = L L^T for a symmetric positive definite A, read from its lower band,
+ * L has the lower bandwidth of A and no super diagonals. O(n * kl^2).
+ *
+ *      L(i, j) = (A(i, j) - sum_k L(i, k) L(j, k))/L(j, j)
+ *
+ * where the sum runs over the columns both rows have in the band, which
+ * are contiguous in each.
+ */
+template<typename T, typename Alloc>
+banded_matrix<T> cholesky(banded_matrix<T, Alloc> const& A)
+{
+    size_t n = A.rows();
+    size_t kl = A.lower_bandwidth();
+
+    banded_matrix<T> L(n, kl, 0);
+
+    for(size_t i=0; i < n; i++)
+    {
+        size_t j0 = L.first_col(i);
+        T* li = &L(i, j0);
+
+        for(size_t j=j0; j <= i; j++)
+        {
+            size_t k0 = L.first_col(j);
+            T const* lj = &L(j, k0);
+
+            // row i starts at j0 >= k0
+            T sum = A(i, j);
+            for(size_t k=j0; k < j; k++)
+            {
+                sum -= li[k - j0] * lj[k - k0];
+            }
+
+            if(j < i)
+            {
+                li[j - j0] = sum/L(j, j);
+            }
+            else if(sum > static_cast<T>(0.0))
+            {
+                li[j - j0] = std::sqrt(sum);
+            }
+            else
+            {
+                throw std::range_error("cholesky: matrix is not positive definite.");
+            }
+        }
+    }
+
+    return L;
+}
+
+// x with L L^T x = b, L from cholesky
+template<typename T, typename Alloc>
+matrix<T> cholesky_solve(banded_matrix<T, Alloc> const& L, matrix<T> const& b)
+{
+    size_t n = L.rows();
+    if(b.rows() != n || b.cols() != 1)
+    {
+        throw std::range_error("cholesky_solve: incorrect dimensions.");
+    }
+
+    matrix<T> x(b);
+
+    // L y = b
+    for(size_t i=0; i < n; i++)
+    {
+        size_t j0 = L.first_col(i);
+        T const* row = &L(i, j0);
+
+        T sum = x(i, 0);
+        for(size_t j=j0; j < i; j++)
+        {
+            sum -= row[j - j0] * x(j, 0);
+        }
+        x(i, 0) = sum/row[i - j0];
+    }
+
+    // L^T x = y, column i of L^T is row i of L
+    for(size_t i=n; i-- > 0;)
+    {
+        size_t j0 = L.first_col(i);
+        T const* row = &L(i, j0);
+
+        x(i, 0) /= row[i - j0];
+        for(size_t j=j0; j < i; j++)
+        {
+            x(j, 0) -= row[j - j0] * x(i, 0);
+        }
+    }
+
+    return x;
+}
+
+/*
+ * Thomas algorithm, O(n). No pivoting, so A should be diagonally dominant
+ * or positive definite, otherwise use LU.
+ */
+template<typename T, typename Alloc>
+matrix<T> tridiagonal_solve(tridiagonal_matrix<T, Alloc> const& A, matrix<T> const& b)
+{
+    size_t n = A.rows();
+    if(b.rows() != n || b.cols() != 1)
+    {
+        throw std::range_error("tridiagonal_solve: incorrect dimensions.");
+    }
+
+    workspace::frame frame;
+
+    // super diagonal of the eliminated system, scaled to a unit diagonal
+    ws_matrix<T> c(n ? n : 1, 1);
+    matrix<T> x(b);
+
+    T d = static_cast<T>(0.0);
+    for(size_t i=0; i < n; i++)
+    {
+        d = A.diag(i);
+        if(i > 0)
+        {
+            d -= A.sub(i) * c(i - 1, 0);
+            x(i, 0) -= A.sub(i) * x(i - 1, 0);
+        }
+
+        if(d == static_cast<T>(0.0))
+        {
+            throw std::range_error("tridiagonal_solve: zero pivot, use LU.");
+        }
+
+        c(i, 0) = (i + 1 < n) ? A.super(i)/d : static_cast<T>(0.0);
+        x(i, 0) /= d;
+    }
+
+    for(size_t i=n; i-- > 1;)
+    {
+        x(i - 1, 0) -= c(i - 1, 0) * x(i, 0);
+    }
+
+    return x;
+}
+
+// x with A x = b, O(n)
+template<typename T, typename Alloc>
+matrix<T> bidiagonal_solve(bidiagonal_matrix<T, Alloc> const& A, matrix<T> const& b)
+{
+    if(b.rows() != A.rows() || b.cols() != 1)
+    {
+        throw std::range_error("bidiagonal_solve: incorrect dimensions.");
+    }
+
+    matrix<T> x(b);
+    back_substitution(A, x);
+    return x;
+}
+
+}
+
+}
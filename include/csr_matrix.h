@@ -0,0 +1,393 @@
+//
+//  csr_matrix.h
+//  Created by Ben Westcott on 10/17/26.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <future>
+#include <stdexcept>
+#include <vector>
+#include "aligned_allocator.h"
+#include "matrix.h"
+#include "matrix_expr.h"
+#include "matrix_view.h"
+#include "tdpool.h"
+
+using std::size_t;
+
+// one entry of a sparse matrix, for building a csr_matrix
+template<typename T>
+struct triplet
+{
+    size_t row;
+    size_t col;
+    T value;
+};
+
+/*
+ * Compressed sparse row storage: the nonzeros of row i are
+ *
+ *      values[row_ptr[i]] ... values[row_ptr[i + 1] - 1]
+ *
+ * in increasing column order, with their columns in col_idx. Storage is
+ * O(rows + nnz), independent of cols.
+ *
+ * Built from triplets (in any order, duplicates are summed) or from a
+ * dense matrix, and converted back with full(). The structure is fixed
+ * once built, values can be changed in place.
+ */
+template<typename T, typename Alloc = aligned_allocator<T>>
+class csr_matrix
+{
+public:
+    using value_type = T;
+
+    csr_matrix(void) : csr_matrix(0, 0) {}
+    csr_matrix(size_t rows, size_t cols);
+    csr_matrix(size_t rows, size_t cols, std::vector<triplet<T>> const& entries);
+
+    // the nonzeros of a matrix or view
+    template<typename M>
+        requires matrix_like<M>
+    explicit csr_matrix(M const& dense);
+
+    size_t rows(void) const { return m_rows; }
+    size_t cols(void) const { return m_cols; }
+    size_t nnz(void) const { return m_values.size(); }
+
+    std::vector<size_t> const& row_ptr(void) const { return m_row_ptr; }
+    std::vector<size_t> const& col_idx(void) const { return m_col_idx; }
+    std::vector<T, Alloc> const& values(void) const { return m_values; }
+    std::vector<T, Alloc>& values(void) { return m_values; }
+
+    // A(i, j), zero if not stored. O(log nnz in row i)
+    T entry(size_t i, size_t j) const;
+
+    matrix<T> full(void) const;
+
+    // O(rows + cols + nnz), rows of the result are sorted by construction
+    csr_matrix<T, Alloc> transpose(void) const;
+
+    template<typename R>
+    csr_matrix<T, Alloc>& operator*=(R scalar);
+
+private:
+
+    size_t m_rows;
+    size_t m_cols;
+    std::vector<size_t> m_row_ptr;
+    std::vector<size_t> m_col_idx;
+    std::vector<T, Alloc> m_values;
+};
+
+template<typename T, typename Alloc>
+csr_matrix<T, Alloc>::csr_matrix(size_t rows, size_t cols)
+: m_rows(rows), m_cols(cols), m_row_ptr(rows + 1, 0)
+{
+}
+
+template<typename T, typename Alloc>
+csr_matrix<T, Alloc>::csr_matrix(size_t rows, size_t cols, std::vector<triplet<T>> const& entries)
+: csr_matrix<T, Alloc>(rows, cols)
+{
+    // counting sort by row
+    for(auto const& e : entries)
+    {
+        if(e.row >= rows || e.col >= cols)
+        {
+            throw std::range_error("csr_matrix: entry out of range.");
+        }
+        m_row_ptr[e.row + 1]++;
+    }
+    for(size_t i=0; i < rows; i++)
+    {
+        m_row_ptr[i + 1] += m_row_ptr[i];
+    }
+
+    std::vector<size_t> next(m_row_ptr.begin(), m_row_ptr.end() - 1);
+    std::vector<triplet<T>> sorted(entries.size());
+    for(auto const& e : entries)
+    {
+        sorted[next[e.row]++] = e;
+    }
+
+    // sort each row by column and sum duplicates, compacting as we go
+    m_col_idx.reserve(entries.size());
+    m_values.reserve(entries.size());
+    for(size_t i=0; i < rows; i++)
+    {
+        auto first = sorted.begin() + m_row_ptr[i];
+        auto last = sorted.begin() + m_row_ptr[i + 1];
+        std::sort(first, last, [](triplet<T> const& a, triplet<T> const& b) { return a.col < b.col; });
+
+        m_row_ptr[i] = m_values.size();
+        for(auto it = first; it != last; ++it)
+        {
+            if(m_values.size() > m_row_ptr[i] && m_col_idx.back() == it->col)
+            {
+                m_values.back() += it->value;
+            }
+            else
+            {
+                m_col_idx.push_back(it->col);
+                m_values.push_back(it->value);
+            }
+        }
+    }
+    m_row_ptr[rows] = m_values.size();
+}
+
+template<typename T, typename Alloc>
+template<typename M>
+    requires matrix_like<M>
+csr_matrix<T, Alloc>::csr_matrix(M const& dense)
+: csr_matrix<T, Alloc>(dense.rows(), dense.cols())
+{
+    for(size_t i=0; i < m_rows; i++)
+    {
+        for(size_t j=0; j < m_cols; j++)
+        {
+            T v = static_cast<T>(dense(i, j));
+            if(v != static_cast<T>(0.0))
+            {
+                m_col_idx.push_back(j);
+                m_values.push_back(v);
+            }
+        }
+        m_row_ptr[i + 1] = m_values.size();
+    }
+}
+
+template<typename T, typename Alloc>
+T csr_matrix<T, Alloc>::entry(size_t i, size_t j) const
+{
+    auto first = m_col_idx.begin() + m_row_ptr[i];
+    auto last = m_col_idx.begin() + m_row_ptr[i + 1];
+    auto it = std::lower_bound(first, last, j);
+
+    return (it != last && *it == j) ? m_values[it - m_col_idx.begin()] : static_cast<T>(0.0);
+}
+
+template<typename T, typename Alloc>
+matrix<T> csr_matrix<T, Alloc>::full(void) const
+{
+    matrix<T> res(m_rows, m_cols);
+    for(size_t i=0; i < m_rows; i++)
+    {
+        for(size_t k=m_row_ptr[i]; k < m_row_ptr[i + 1]; k++)
+        {
+            res(i, m_col_idx[k]) = m_values[k];
+        }
+    }
+    return res;
+}
+
+template<typename T, typename Alloc>
+csr_matrix<T, Alloc> csr_matrix<T, Alloc>::transpose(void) const
+{
+    csr_matrix<T, Alloc> res(m_cols, m_rows);
+    res.m_col_idx.resize(nnz());
+    res.m_values.resize(nnz());
+
+    for(size_t k=0; k < nnz(); k++)
+    {
+        res.m_row_ptr[m_col_idx[k] + 1]++;
+    }
+    for(size_t j=0; j < m_cols; j++)
+    {
+        res.m_row_ptr[j + 1] += res.m_row_ptr[j];
+    }
+
+    // walking rows in order appends to each column in increasing row order
+    std::vector<size_t> next(res.m_row_ptr.begin(), res.m_row_ptr.end() - 1);
+    for(size_t i=0; i < m_rows; i++)
+    {
+        for(size_t k=m_row_ptr[i]; k < m_row_ptr[i + 1]; k++)
+        {
+            size_t dst = next[m_col_idx[k]]++;
+            res.m_col_idx[dst] = i;
+            res.m_values[dst] = m_values[k];
+        }
+    }
+
+    return res;
+}
+
+template<typename T, typename Alloc>
+template<typename R>
+csr_matrix<T, Alloc>& csr_matrix<T, Alloc>::operator*=(R scalar)
+{
+    simd::scale(m_values.data(), m_values.size(), static_cast<T>(scalar));
+    return *this;
+}
+
+namespace sparse_detail
+{
+
+// nonzeros per pool task, rows are split so tasks get about as many each
+constexpr size_t nnz_per_task = 1 << 15;
+
+// y(i) <- alpha * A(i, :) x + beta * y(i) for rows [rb, re)
+template<typename T, typename Alloc, typename X>
+void sp_mat_vec_rows(T alpha, csr_matrix<T, Alloc> const& A, X const& x, T beta, matrix_view<T> const& y, size_t rb, size_t re)
+{
+    size_t const* rp = A.row_ptr().data();
+    size_t const* ci = A.col_idx().data();
+    T const* v = A.values().data();
+
+    for(size_t i=rb; i < re; i++)
+    {
+        T acc = static_cast<T>(0.0);
+        for(size_t k=rp[i]; k < rp[i + 1]; k++)
+        {
+            acc += v[k] * x[ci[k]];
+        }
+
+        y[i] = (beta == static_cast<T>(0.0)) ? alpha * acc : alpha * acc + beta * y[i];
+    }
+}
+
+// C(i, :) <- A(i, :) B for rows [rb, re), C is zero on entry
+template<typename T, typename Alloc, typename M>
+void sp_mat_mul_rows(csr_matrix<T, Alloc> const& A, M const& B, matrix_view<T> const& C, size_t rb, size_t re)
+{
+    size_t const* rp = A.row_ptr().data();
+    size_t const* ci = A.col_idx().data();
+    T const* v = A.values().data();
+    size_t N = B.cols();
+
+    for(size_t i=rb; i < re; i++)
+    {
+        T* crow = &C(i, 0);
+        for(size_t k=rp[i]; k < rp[i + 1]; k++)
+        {
+            T a = v[k];
+            size_t r = ci[k];
+            for(size_t j=0; j < N; j++)
+            {
+                crow[j] += a * B(r, j);
+            }
+        }
+    }
+}
+
+// calls f(rb, re) on pool for row ranges of about nnz_per_task nonzeros (or rows), waits for all
+template<typename T, typename Alloc, typename F>
+void for_row_chunks(csr_matrix<T, Alloc> const& A, tdpool& pool, F const& f)
+{
+    std::vector<size_t> const& rp = A.row_ptr();
+    std::vector<std::future<void>> results;
+
+    size_t rb = 0;
+    while(rb < A.rows())
+    {
+        // first row end at which the chunk has its nonzeros, empty rows count too
+        auto it = std::lower_bound(rp.begin() + rb + 1, rp.end(), rp[rb] + nnz_per_task);
+        size_t re = std::min({static_cast<size_t>(it - rp.begin()), A.rows(), rb + nnz_per_task});
+
+        results.emplace_back(pool.enqueue([=, &f]() { f(rb, re); }));
+        rb = re;
+    }
+
+    for(auto& r : results)
+    {
+        r.get();
+    }
+}
+
+}
+
+/*
+ * y <- alpha * A * x + beta * y, O(rows + nnz). Each y(i) is a gather
+ * over x along row i, so the access pattern to x is that of the columns.
+ */
+template<typename T, typename Alloc, typename X>
+void sp_mat_vec(T alpha, csr_matrix<T, Alloc> const& A, X const& x, T beta, matrix_view<T> const& y)
+{
+    if(x.size() != A.cols() || y.size() != A.rows())
+    {
+        throw std::range_error("sp_mat_vec: incorrect dimensions.");
+    }
+
+    sparse_detail::sp_mat_vec_rows(alpha, A, x, beta, y, 0, A.rows());
+}
+
+/*
+ * Same as above with the rows split over pool, into chunks of about equal
+ * nonzero count so skewed (e.g. power law) row lengths still balance.
+ * Tasks write disjoint parts of y.
+ */
+template<typename T, typename Alloc, typename X>
+void sp_mat_vec(T alpha, csr_matrix<T, Alloc> const& A, X const& x, T beta, matrix_view<T> const& y, tdpool& pool)
+{
+    if(x.size() != A.cols() || y.size() != A.rows())
+    {
+        throw std::range_error("sp_mat_vec: incorrect dimensions.");
+    }
+
+    sparse_detail::for_row_chunks(A, pool, [&](size_t rb, size_t re)
+    {
+        sparse_detail::sp_mat_vec_rows(alpha, A, x, beta, y, rb, re);
+    });
+}
+
+// A * x as a column vector
+template<typename T, typename Alloc, typename X>
+matrix<T> sp_mat_vec(csr_matrix<T, Alloc> const& A, X const& x)
+{
+    matrix<T> y(A.rows(), 1);
+    sp_mat_vec(static_cast<T>(1.0), A, x, static_cast<T>(0.0), y.view());
+    return y;
+}
+
+template<typename T, typename Alloc, typename X>
+matrix<T> sp_mat_vec(csr_matrix<T, Alloc> const& A, X const& x, tdpool& pool)
+{
+    matrix<T> y(A.rows(), 1);
+    sp_mat_vec(static_cast<T>(1.0), A, x, static_cast<T>(0.0), y.view(), pool);
+    return y;
+}
+
+/*
+ * A * B for a dense B, O(nnz * B.cols()). Row i of the product is the
+ * combination of the rows of B picked out by row i of A, so B and the
+ * (row-major) product are both read and written along rows.
+ */
+template<typename T, typename Alloc, typename M>
+matrix<T> sp_mat_mul(csr_matrix<T, Alloc> const& A, M const& B)
+{
+    if(A.cols() != B.rows())
+    {
+        throw std::range_error("sp_mat_mul: incorrect dimensions.");
+    }
+
+    matrix<T> C(A.rows(), B.cols());
+    if(C.size())
+    {
+        sparse_detail::sp_mat_mul_rows(A, B, C.view(), 0, A.rows());
+    }
+    return C;
+}
+
+template<typename T, typename Alloc, typename M>
+matrix<T> sp_mat_mul(csr_matrix<T, Alloc> const& A, M const& B, tdpool& pool)
+{
+    if(A.cols() != B.rows())
+    {
+        throw std::range_error("sp_mat_mul: incorrect dimensions.");
+    }
+
+    matrix<T> C(A.rows(), B.cols());
+    if(C.size())
+    {
+        matrix_view<T> Cv = C.view();
+        sparse_detail::for_row_chunks(A, pool, [&](size_t rb, size_t re)
+        {
+            sparse_detail::sp_mat_mul_rows(A, B, Cv, rb, re);
+        });
+    }
+    return C;
+}
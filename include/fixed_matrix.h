@@ -0,0 +1,306 @@
+//
+//  fixed_matrix.h
+//  Created by Ben Westcott on 10/17/26.
+//
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <initializer_list>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include "matrix.h"
+#include "matrix_view.h"
+
+using std::size_t;
+
+/*
+ * Matrix with compile-time extents and inline storage, for the case of many
+ * small problems (3x3, 4x4, 6x6 pose and covariance updates) where the heap
+ * allocation, shared_ptr control block and runtime loop bounds of matrix<T>
+ * cost more than the arithmetic.
+ *
+ * Storage is row-major and packed. Elementwise arithmetic, products and
+ * transpose are unrolled at compile time. Element access is the same as for
+ * matrix<T>, and it converts to and from matrix<T> and matrix_view<T>, so the
+ * generic products and view kernels accept it too.
+ */
+
+namespace unroll_detail
+{
+
+template<typename F, size_t... I>
+constexpr void unroll(F&& f, std::index_sequence<I...>)
+{
+    (f(std::integral_constant<size_t, I>{}), ...);
+}
+
+}
+
+// calls f(0), f(1), ..., f(N - 1), with each index a compile-time constant
+template<size_t N, typename F>
+constexpr void unroll(F&& f)
+{
+    unroll_detail::unroll(f, std::make_index_sequence<N>{});
+}
+
+template<typename T, size_t M, size_t N>
+class fixed_matrix
+{
+    static_assert(M > 0 && N > 0, "fixed_matrix: extents must be non-zero.");
+
+public:
+    using value_type = T;
+
+    constexpr fixed_matrix(void) : m_data{} {}
+    constexpr fixed_matrix(std::initializer_list<T> dat);
+    constexpr fixed_matrix(std::initializer_list<std::initializer_list<T>> dat);
+
+    explicit fixed_matrix(matrix_view<T const> const& rhs);
+
+    static constexpr size_t size(void) { return M * N; }
+    static constexpr size_t rows(void) { return M; }
+    static constexpr size_t cols(void) { return N; }
+
+    static constexpr bool is_square(void) { return (M == N); }
+    static constexpr bool is_row_vector(void) { return (M == 1); }
+    static constexpr bool is_col_vector(void) { return (N == 1); }
+    static constexpr bool is_vector(void) { return is_row_vector() || is_col_vector(); }
+
+    T* data(void) { return m_data.data(); }
+    T const* data(void) const { return m_data.data(); }
+
+    constexpr T& operator[](size_t offs) { return m_data[offs]; }
+    constexpr T const& operator[](size_t offs) const { return m_data[offs]; }
+
+    constexpr T& operator()(size_t m, size_t n) { return m_data[m * N + n]; }
+    constexpr T const& operator()(size_t m, size_t n) const { return m_data[m * N + n]; }
+
+    constexpr void fill(T value);
+    constexpr void zero(void) { fill(static_cast<T>(0.0)); }
+    constexpr void fill_lower_triangle(T value);
+
+    constexpr fixed_matrix<T, 1, N> row(size_t r) const;
+    constexpr fixed_matrix<T, M, 1> col(size_t c) const;
+    constexpr fixed_matrix<T, N, M> transpose(void) const;
+
+    matrix_view<T> view(void) { return matrix_view<T>(data(), M, N, N); }
+    matrix_view<T const> view(void) const { return matrix_view<T const>(data(), M, N, N); }
+    operator matrix_view<T>(void) { return view(); }
+    operator matrix_view<T const>(void) const { return view(); }
+
+    constexpr fixed_matrix<T, M, N>& operator+=(fixed_matrix<T, M, N> const& rhs);
+    constexpr fixed_matrix<T, M, N>& operator-=(fixed_matrix<T, M, N> const& rhs);
+
+    template<typename R>
+    constexpr fixed_matrix<T, M, N>& operator*=(R scalar);
+
+    constexpr bool equals(fixed_matrix<T, M, N> const& rhs) const { return (m_data == rhs.m_data); }
+
+    static constexpr fixed_matrix<T, M, N> eye(void);
+
+private:
+
+    std::array<T, M * N> m_data;
+};
+
+// row by row, missing trailing elements are zero
+template<typename T, size_t M, size_t N>
+constexpr fixed_matrix<T, M, N>::fixed_matrix(std::initializer_list<T> dat)
+: m_data{}
+{
+    size_t i = 0;
+    for(auto it = dat.begin(); it != dat.end() && i < M * N; it++, i++)
+    {
+        m_data[i] = *it;
+    }
+}
+
+template<typename T, size_t M, size_t N>
+constexpr fixed_matrix<T, M, N>::fixed_matrix(std::initializer_list<std::initializer_list<T>> dat)
+: m_data{}
+{
+    size_t r = 0;
+    for(auto rit = dat.begin(); rit != dat.end() && r < M; rit++, r++)
+    {
+        size_t c = 0;
+        for(auto it = rit->begin(); it != rit->end() && c < N; it++, c++)
+        {
+            (*this)(r, c) = *it;
+        }
+    }
+}
+
+template<typename T, size_t M, size_t N>
+fixed_matrix<T, M, N>::fixed_matrix(matrix_view<T const> const& rhs)
+: m_data{}
+{
+    if(rhs.rows() != M || rhs.cols() != N)
+    {
+        throw std::range_error("fixed_matrix: dimensions must be equal.");
+    }
+
+    unroll<M>([&](auto r)
+    {
+        unroll<N>([&](auto c) { (*this)(r, c) = rhs(r, c); });
+    });
+}
+
+template<typename T, size_t M, size_t N>
+constexpr void fixed_matrix<T, M, N>::fill(T value)
+{
+    unroll<M * N>([&](auto i) { m_data[i] = value; });
+}
+
+template<typename T, size_t M, size_t N>
+constexpr void fixed_matrix<T, M, N>::fill_lower_triangle(T value)
+{
+    for(size_t c=0; c < N; c++)
+    {
+        for(size_t r = c + 1; r < M; r++)
+        {
+            (*this)(r, c) = value;
+        }
+    }
+}
+
+template<typename T, size_t M, size_t N>
+constexpr fixed_matrix<T, 1, N> fixed_matrix<T, M, N>::row(size_t r) const
+{
+    if(r >= M)
+    {
+        throw std::range_error("row: row index is out of range.");
+    }
+
+    fixed_matrix<T, 1, N> rvec;
+    unroll<N>([&](auto c) { rvec[c] = (*this)(r, c); });
+    return rvec;
+}
+
+template<typename T, size_t M, size_t N>
+constexpr fixed_matrix<T, M, 1> fixed_matrix<T, M, N>::col(size_t c) const
+{
+    if(c >= N)
+    {
+        throw std::range_error("col: column index is out of range.");
+    }
+
+    fixed_matrix<T, M, 1> cvec;
+    unroll<M>([&](auto r) { cvec[r] = (*this)(r, c); });
+    return cvec;
+}
+
+template<typename T, size_t M, size_t N>
+constexpr fixed_matrix<T, N, M> fixed_matrix<T, M, N>::transpose(void) const
+{
+    fixed_matrix<T, N, M> tm;
+    unroll<M>([&](auto r)
+    {
+        unroll<N>([&](auto c) { tm(c, r) = (*this)(r, c); });
+    });
+    return tm;
+}
+
+template<typename T, size_t M, size_t N>
+constexpr fixed_matrix<T, M, N>& fixed_matrix<T, M, N>::operator+=(fixed_matrix<T, M, N> const& rhs)
+{
+    unroll<M * N>([&](auto i) { m_data[i] += rhs.m_data[i]; });
+    return *this;
+}
+
+template<typename T, size_t M, size_t N>
+constexpr fixed_matrix<T, M, N>& fixed_matrix<T, M, N>::operator-=(fixed_matrix<T, M, N> const& rhs)
+{
+    unroll<M * N>([&](auto i) { m_data[i] -= rhs.m_data[i]; });
+    return *this;
+}
+
+template<typename T, size_t M, size_t N>
+template<typename R>
+constexpr fixed_matrix<T, M, N>& fixed_matrix<T, M, N>::operator*=(R scalar)
+{
+    T factor = static_cast<T>(scalar);
+    unroll<M * N>([&](auto i) { m_data[i] *= factor; });
+    return *this;
+}
+
+template<typename T, size_t M, size_t N>
+constexpr fixed_matrix<T, M, N> fixed_matrix<T, M, N>::eye(void)
+{
+    fixed_matrix<T, M, N> I;
+    unroll<(M < N) ? M : N>([&](auto i) { I(i, i) = static_cast<T>(1.0); });
+    return I;
+}
+
+/*
+ * C = AB, fully unrolled. Extents are checked at compile time.
+ */
+template<typename T, size_t M, size_t K, size_t N>
+constexpr fixed_matrix<T, M, N> mat_mul(fixed_matrix<T, M, K> const& lhs, fixed_matrix<T, K, N> const& rhs)
+{
+    fixed_matrix<T, M, N> res;
+    unroll<M>([&](auto i)
+    {
+        unroll<N>([&](auto j)
+        {
+            T sum = static_cast<T>(0.0);
+            unroll<K>([&](auto k) { sum += lhs(i, k) * rhs(k, j); });
+            res(i, j) = sum;
+        });
+    });
+    return res;
+}
+
+template<typename T, size_t M, size_t N>
+constexpr bool operator==(fixed_matrix<T, M, N> const& lhs, fixed_matrix<T, M, N> const& rhs)
+{
+    return lhs.equals(rhs);
+}
+
+template<typename T, size_t M, size_t N>
+constexpr bool operator!=(fixed_matrix<T, M, N> const& lhs, fixed_matrix<T, M, N> const& rhs)
+{
+    return !lhs.equals(rhs);
+}
+
+template<typename T, size_t M, size_t N, typename R>
+constexpr fixed_matrix<T, M, N> operator*(R scalar, fixed_matrix<T, M, N> const& rhs)
+{
+    fixed_matrix<T, M, N> res(rhs);
+    res *= scalar;
+    return res;
+}
+
+template<typename T, size_t M, size_t N>
+constexpr fixed_matrix<T, M, N> operator+(fixed_matrix<T, M, N> const& lhs, fixed_matrix<T, M, N> const& rhs)
+{
+    fixed_matrix<T, M, N> sum(lhs);
+    sum += rhs;
+    return sum;
+}
+
+template<typename T, size_t M, size_t N>
+constexpr fixed_matrix<T, M, N> operator-(fixed_matrix<T, M, N> const& lhs, fixed_matrix<T, M, N> const& rhs)
+{
+    fixed_matrix<T, M, N> diff(lhs);
+    diff -= rhs;
+    return diff;
+}
+
+template<typename T, size_t M, size_t N>
+std::ostream& operator<<(std::ostream& os, fixed_matrix<T, M, N> const& mat)
+{
+    for(size_t r=0; r < M; r++)
+    {
+        for(size_t c=0; c < N; c++)
+        {
+            os << std::setprecision(2) << std::scientific << mat(r, c) << "\t";
+        }
+        os << "\n";
+    }
+    return os;
+}
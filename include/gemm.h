@@ -0,0 +1,527 @@
+//
+//  gemm.h
+//  Created by Ben Westcott on 10/17/26.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <future>
+#include <stdexcept>
+#include <vector>
+#include "matrix.h"
+#include "matrix_view.h"
+#include "matrix_expr.h"
+#include "simd_kernels.h"
+#include "tdpool.h"
+#include "workspace.h"
+
+using std::size_t;
+
+/*
+ * C <- alpha * A * B + beta * C, blocked the usual way (Goto & van de Geijn,
+ * "Anatomy of high-performance matrix multiplication"):
+ *
+ *      for each NC wide column panel of B and C
+ *        for each KC deep slice:  pack B(KC x NC) into NR wide slivers   (L3)
+ *          for each MC block of rows:  pack A(MC x KC) into MR slivers   (L2)
+ *            for each NR sliver of B, MR sliver of A:  MR x NR micro-kernel
+ *
+ * The micro-kernel keeps its MR x NR block of C in vector registers for
+ * the whole KC loop, reading one MR column of packed A and one NR row of
+ * packed B per step, both contiguous, so it runs at the FMA throughput.
+ * Packing pays for any strides of A and B once per block, which is also
+ * what lets the operands be views of any layout, transposed or not.
+ *
+ * Kernels are written like those of simd_kernels.h, once on vector types of
+ * W bytes and instantiated per instruction set, picked by simd::active_isa.
+ * Element types other than float and double use a scalar kernel. C is
+ * written in NR wide rows, a column-major C is handled as the transposed
+ * problem C^T = B^T A^T. beta = 0 never reads C. C must not overlap A or B.
+ */
+namespace gemm_detail
+{
+
+// depth of a slice and rows of an A block, in units of MR
+constexpr size_t KC = 256;
+constexpr size_t MC_slivers = 8;
+constexpr size_t NC = 4096;
+
+/*
+ * c (row-major with leading dimension ldc) <- alpha * a * b + beta * c for
+ * an MR x NR block, a and b packed slivers kc deep.
+ */
+template<size_t MR, size_t NR, typename T>
+void micro_scalar(size_t kc, T const* a, T const* b, T* c, size_t ldc, T alpha, T beta)
+{
+    T acc[MR][NR] = {};
+    for(size_t k=0; k < kc; k++, a += MR, b += NR)
+    {
+        for(size_t i=0; i < MR; i++)
+        {
+            for(size_t j=0; j < NR; j++)
+            {
+                acc[i][j] += a[i] * b[j];
+            }
+        }
+    }
+
+    for(size_t i=0; i < MR; i++)
+    {
+        for(size_t j=0; j < NR; j++)
+        {
+            T& cij = c[i * ldc + j];
+            cij = (beta == static_cast<T>(0)) ? alpha * acc[i][j] : alpha * acc[i][j] + beta * cij;
+        }
+    }
+}
+
+#if LINALG_SIMD_X86
+
+// the same on vectors of W bytes, NR = NV vectors
+template<size_t W, size_t MR, size_t NV, typename T>
+[[gnu::always_inline]] inline void micro_vec(size_t kc, T const* a, T const* b, T* c, size_t ldc, T alpha, T beta)
+{
+    typedef T vec __attribute__((vector_size(W)));
+    constexpr size_t L = W/sizeof(T);
+
+    vec acc[MR][NV];
+#pragma GCC unroll 16
+    for(size_t i=0; i < MR; i++)
+    {
+#pragma GCC unroll 4
+        for(size_t v=0; v < NV; v++)
+        {
+            acc[i][v] = vec{};
+        }
+    }
+
+#pragma GCC unroll 4
+    for(size_t k=0; k < kc; k++, a += MR, b += NV * L)
+    {
+        vec bv[NV];
+#pragma GCC unroll 4
+        for(size_t v=0; v < NV; v++)
+        {
+            __builtin_memcpy(&bv[v], b + v * L, W);
+        }
+
+        // scalar * vector broadcasts straight from memory, vec{} + a[i] would add first
+#pragma GCC unroll 16
+        for(size_t i=0; i < MR; i++)
+        {
+#pragma GCC unroll 4
+            for(size_t v=0; v < NV; v++)
+            {
+                acc[i][v] += a[i] * bv[v];
+            }
+        }
+    }
+
+    vec va = vec{} + alpha;
+    vec vb = vec{} + beta;
+#pragma GCC unroll 16
+    for(size_t i=0; i < MR; i++)
+    {
+#pragma GCC unroll 4
+        for(size_t v=0; v < NV; v++)
+        {
+            vec cv = va * acc[i][v];
+            if(beta != static_cast<T>(0))
+            {
+                vec old;
+                __builtin_memcpy(&old, c + i * ldc + v * L, W);
+                cv += vb * old;
+            }
+            __builtin_memcpy(c + i * ldc + v * L, &cv, W);
+        }
+    }
+}
+
+/*
+ * Register budgets: 32 zmm hold 12 x 2 accumulators, 2 of B and the
+ * broadcast A, 16 ymm hold 6 x 2 and 16 xmm 4 x 2 (SSE2 has no FMA, so the
+ * add waits on the multiply and more accumulators would not help).
+ */
+template<typename T>
+[[gnu::target("avx512f,avx512bw,avx512dq,avx512vl")]] void micro_avx512(size_t kc, T const* a, T const* b, T* c, size_t ldc, T alpha, T beta)
+{
+    micro_vec<64, 12, 2>(kc, a, b, c, ldc, alpha, beta);
+}
+
+template<typename T>
+[[gnu::target("avx2,fma")]] void micro_avx2(size_t kc, T const* a, T const* b, T* c, size_t ldc, T alpha, T beta)
+{
+    micro_vec<32, 6, 2>(kc, a, b, c, ldc, alpha, beta);
+}
+
+template<typename T>
+[[gnu::target("sse2")]] void micro_sse2(size_t kc, T const* a, T const* b, T* c, size_t ldc, T alpha, T beta)
+{
+    micro_vec<16, 4, 2>(kc, a, b, c, ldc, alpha, beta);
+}
+
+#endif
+
+template<typename T>
+using micro_kernel = void (*)(size_t, T const*, T const*, T*, size_t, T, T);
+
+// a micro-kernel and its block shape
+template<typename T>
+struct kernel
+{
+    micro_kernel<T> run;
+    size_t MR;
+    size_t NR;
+};
+
+template<typename T>
+kernel<T> select_kernel(void)
+{
+#if LINALG_SIMD_X86
+    if constexpr(std::is_same_v<T, float> || std::is_same_v<T, double>)
+    {
+        switch(simd::active_isa())
+        {
+            case simd::isa::avx512: return {micro_avx512<T>, 12, 2 * 64/sizeof(T)};
+            case simd::isa::avx2:
+                if(__builtin_cpu_supports("fma"))
+                {
+                    return {micro_avx2<T>, 6, 2 * 32/sizeof(T)};
+                }
+                [[fallthrough]];
+            case simd::isa::sse2: return {micro_sse2<T>, 4, 2 * 16/sizeof(T)};
+            default: break;
+        }
+    }
+#endif
+    return {micro_scalar<4, 4, T>, 4, 4};
+}
+
+/*
+ * Packs rows [i0, i0 + mc) and columns [p0, p0 + kc) of A as MR row
+ * slivers, each column of a sliver contiguous, zero padding the last one.
+ */
+template<typename T>
+void pack_A(matrix_view<T const> const& A, size_t i0, size_t mc, size_t p0, size_t kc, size_t MR, T* dst)
+{
+    ptrdiff_t rs = A.row_stride();
+    ptrdiff_t cs = A.col_stride();
+
+    for(size_t s=0; s < mc; s += MR, dst += MR * kc)
+    {
+        size_t m = std::min(MR, mc - s);
+        T const* src = A.data() + A.offset(i0 + s, p0);
+
+        for(size_t k=0; k < kc; k++)
+        {
+            T const* col = src + k * cs;
+            T* out = dst + k * MR;
+            for(size_t i=0; i < m; i++)
+            {
+                out[i] = col[i * rs];
+            }
+            for(size_t i=m; i < MR; i++)
+            {
+                out[i] = static_cast<T>(0);
+            }
+        }
+    }
+}
+
+// columns [j0, j0 + nc) and rows [p0, p0 + kc) of B as NR column slivers, each row contiguous
+template<typename T>
+void pack_B(matrix_view<T const> const& B, size_t p0, size_t kc, size_t j0, size_t nc, size_t NR, T* dst)
+{
+    ptrdiff_t rs = B.row_stride();
+    ptrdiff_t cs = B.col_stride();
+
+    for(size_t s=0; s < nc; s += NR, dst += NR * kc)
+    {
+        size_t n = std::min(NR, nc - s);
+        T const* src = B.data() + B.offset(p0, j0 + s);
+
+        for(size_t k=0; k < kc; k++)
+        {
+            T const* row = src + k * rs;
+            T* out = dst + k * NR;
+            if(cs == 1)
+            {
+                std::copy(row, row + n, out);
+            }
+            else
+            {
+                for(size_t j=0; j < n; j++)
+                {
+                    out[j] = row[j * cs];
+                }
+            }
+            std::fill(out + n, out + NR, static_cast<T>(0));
+        }
+    }
+}
+
+// C <- beta * C, beta = 0 clears C whatever it holds
+template<typename T>
+void scale(T beta, matrix_view<T> const& C)
+{
+    for(size_t i=0; i < C.rows(); i++)
+    {
+        for(size_t j=0; j < C.cols(); j++)
+        {
+            C(i, j) = (beta == static_cast<T>(0)) ? static_cast<T>(0) : beta * C(i, j);
+        }
+    }
+}
+
+/*
+ * Columns [j0, j1) of C += the packed A block times the packed B panel, C
+ * the block of rows of A and columns of the panel. Edge blocks of C, and
+ * blocks of a C with a wider column stride, go through a tile on the stack.
+ */
+template<typename T>
+void macro_kernel(kernel<T> const& ker, size_t kc, T const* Ap, T const* Bp, size_t j0, size_t j1, T alpha, T beta, matrix_view<T> const& C)
+{
+    size_t MR = ker.MR;
+    size_t NR = ker.NR;
+    size_t mc = C.rows();
+
+    // the largest tile, 12 x 32 floats
+    alignas(64) T tile[12 * 32];
+
+    for(size_t jr=j0; jr < j1; jr += NR)
+    {
+        size_t n = std::min(NR, j1 - jr);
+        T const* bp = Bp + jr * kc;
+
+        for(size_t ir=0; ir < mc; ir += MR)
+        {
+            size_t m = std::min(MR, mc - ir);
+            T const* ap = Ap + ir * kc;
+            T* c = C.data() + C.offset(ir, jr);
+
+            if(m == MR && n == NR && C.col_stride() == 1)
+            {
+                ker.run(kc, ap, bp, c, C.row_stride(), alpha, beta);
+                continue;
+            }
+
+            ker.run(kc, ap, bp, tile, NR, static_cast<T>(1), static_cast<T>(0));
+            for(size_t i=0; i < m; i++)
+            {
+                for(size_t j=0; j < n; j++)
+                {
+                    T& cij = c[i * C.row_stride() + j * C.col_stride()];
+                    cij = (beta == static_cast<T>(0)) ? alpha * tile[i * NR + j] : alpha * tile[i * NR + j] + beta * cij;
+                }
+            }
+        }
+    }
+}
+
+// size of a packed A block, rounded to whole cache lines
+template<typename T>
+size_t packed_A_size(size_t M, size_t K, size_t MR)
+{
+    constexpr size_t line = 64/sizeof(T) ? 64/sizeof(T) : 1;
+    size_t mc = std::min(M, MC_slivers * MR);
+    size_t size = ((mc + MR - 1)/MR) * MR * std::min(K, KC);
+    return ((size + line - 1)/line) * line;
+}
+
+template<typename T>
+size_t packed_B_size(size_t N, size_t K, size_t NR)
+{
+    return ((std::min(N, NC) + NR - 1)/NR) * NR * std::min(K, KC);
+}
+
+// the loop nest on the calling thread
+template<typename T>
+void blocked(T alpha, matrix_view<T const> const& A, matrix_view<T const> const& B, T beta, matrix_view<T> const& C)
+{
+    size_t M = C.rows();
+    size_t N = C.cols();
+    size_t K = A.cols();
+
+    kernel<T> ker = select_kernel<T>();
+    size_t MC = MC_slivers * ker.MR;
+
+    workspace::frame frame;
+    ws_matrix<T> Ap(1, packed_A_size<T>(M, K, ker.MR));
+    ws_matrix<T> Bp(1, packed_B_size<T>(N, K, ker.NR));
+
+    for(size_t jc=0; jc < N; jc += NC)
+    {
+        size_t nc = std::min(NC, N - jc);
+        for(size_t pc=0; pc < K; pc += KC)
+        {
+            size_t kc = std::min(KC, K - pc);
+            T beta_k = pc ? static_cast<T>(1) : beta;
+
+            pack_B(B, pc, kc, jc, nc, ker.NR, Bp.data());
+
+            for(size_t ic=0; ic < M; ic += MC)
+            {
+                size_t mc = std::min(MC, M - ic);
+                pack_A(A, ic, mc, pc, kc, ker.MR, Ap.data());
+                macro_kernel(ker, kc, Ap.data(), Bp.data(), 0, nc, alpha, beta_k, C.sub_matrix(ic, mc, jc, nc));
+            }
+        }
+    }
+}
+
+/*
+ * The same loop nest on pool, one task per worker in two phases per KC
+ * slice:
+ *
+ *  - the workers pack the B panel together, each a range of its slivers,
+ *    into one buffer they all read;
+ *  - the panel of C is cut into MC x (multiple of NR) tiles, at least a few
+ *    per worker, and each worker takes a contiguous range of them, row
+ *    block first, packing A into its own buffer when the row block changes.
+ *
+ * Each element of C belongs to one tile and the slices run one after the
+ * other, so C sees the same operations in the same order as in blocked(),
+ * and the result is identical whatever the number of workers. The buffers
+ * are allocated once per call, from the calling thread's workspace.
+ */
+template<typename T>
+void blocked(T alpha, matrix_view<T const> const& A, matrix_view<T const> const& B, T beta, matrix_view<T> const& C, tdpool& pool)
+{
+    size_t M = C.rows();
+    size_t N = C.cols();
+    size_t K = A.cols();
+
+    kernel<T> ker = select_kernel<T>();
+    size_t MR = ker.MR;
+    size_t NR = ker.NR;
+    size_t MC = MC_slivers * MR;
+    size_t workers = std::max<size_t>(pool.size(), 1);
+
+    size_t a_size = packed_A_size<T>(M, K, MR);
+    workspace::frame frame;
+    ws_matrix<T> Ap(1, a_size * workers);
+    ws_matrix<T> Bp(1, packed_B_size<T>(N, K, NR));
+
+    std::vector<std::future<void>> results;
+    results.reserve(workers);
+
+    // runs f(w) for every worker w and waits for all of them
+    auto phase = [&](auto const& f)
+    {
+        results.clear();
+        for(size_t w=0; w < workers; w++)
+        {
+            results.emplace_back(pool.enqueue(f, w));
+        }
+        for(auto& r : results)
+        {
+            r.get();
+        }
+    };
+
+    size_t row_blocks = (M + MC - 1)/MC;
+
+    for(size_t jc=0; jc < N; jc += NC)
+    {
+        size_t nc = std::min(NC, N - jc);
+        size_t slivers = (nc + NR - 1)/NR;
+
+        // columns of tiles, enough for 4 tiles per worker when the panel allows
+        size_t col_blocks = std::clamp((4 * workers + row_blocks - 1)/row_blocks, size_t(1), slivers);
+        size_t tile_cols = ((slivers + col_blocks - 1)/col_blocks) * NR;
+        col_blocks = (nc + tile_cols - 1)/tile_cols;
+        size_t tiles = row_blocks * col_blocks;
+
+        for(size_t pc=0; pc < K; pc += KC)
+        {
+            size_t kc = std::min(KC, K - pc);
+            T beta_k = pc ? static_cast<T>(1) : beta;
+
+            phase([&](size_t w)
+            {
+                size_t s0 = slivers * w/workers;
+                size_t s1 = slivers * (w + 1)/workers;
+                pack_B(B, pc, kc, jc + s0 * NR, std::min(nc, s1 * NR) - std::min(nc, s0 * NR), NR, Bp.data() + s0 * NR * kc);
+            });
+
+            phase([&](size_t w)
+            {
+                T* ap = Ap.data() + w * a_size;
+                size_t packed = row_blocks;
+
+                for(size_t t = tiles * w/workers; t < tiles * (w + 1)/workers; t++)
+                {
+                    size_t ic = (t/col_blocks) * MC;
+                    size_t mc = std::min(MC, M - ic);
+                    size_t j0 = (t % col_blocks) * tile_cols;
+
+                    if(packed != t/col_blocks)
+                    {
+                        pack_A(A, ic, mc, pc, kc, MR, ap);
+                        packed = t/col_blocks;
+                    }
+                    macro_kernel(ker, kc, ap, Bp.data(), j0, std::min(nc, j0 + tile_cols), alpha, beta_k, C.sub_matrix(ic, mc, jc, nc));
+                }
+            });
+        }
+    }
+}
+
+template<typename T>
+void check_dimensions(matrix_view<T const> const& A, matrix_view<T const> const& B, matrix_view<T> const& C)
+{
+    if(A.cols() != B.rows() || C.rows() != A.rows() || C.cols() != B.cols())
+    {
+        throw std::range_error("mat_mul: incorrect dimensions.");
+    }
+}
+
+// the trivial cases and the choice of C or C^T, then blocked(..., pool...)
+template<typename T, typename... Pool>
+void mat_mul(T alpha, matrix_view<T const> const& A, matrix_view<T const> const& B, T beta, matrix_view<T> const& C, Pool&... pool)
+{
+    if(!C.rows() || !C.cols())
+    {
+        return;
+    }
+
+    if(!A.cols() || alpha == static_cast<T>(0))
+    {
+        scale(beta, C);
+        return;
+    }
+
+    // a column-major C is the row-major C^T = B^T A^T
+    if(C.col_stride() != 1 && C.row_stride() == 1)
+    {
+        blocked(alpha, B.transpose(), A.transpose(), beta, C.transpose(), pool...);
+        return;
+    }
+
+    blocked(alpha, A, B, beta, C, pool...);
+}
+
+}
+
+// C <- alpha * A * B + beta * C, for matrices or views of any layout, see above
+template<typename T, typename L, typename R>
+void mat_mul(T alpha, L const& A, R const& B, T beta, matrix_view<T> const& C)
+{
+    matrix_view<T const> a = const_view(A);
+    matrix_view<T const> b = const_view(B);
+    gemm_detail::check_dimensions(a, b, C);
+    gemm_detail::mat_mul(alpha, a, b, beta, C);
+}
+
+// the same on pool, see blocked(..., pool) above
+template<typename T, typename L, typename R>
+void mat_mul(T alpha, L const& A, R const& B, T beta, matrix_view<T> const& C, tdpool& pool)
+{
+    matrix_view<T const> a = const_view(A);
+    matrix_view<T const> b = const_view(B);
+    gemm_detail::check_dimensions(a, b, C);
+    gemm_detail::mat_mul(alpha, a, b, beta, C, pool);
+}
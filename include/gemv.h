@@ -0,0 +1,560 @@
+//
+//  gemv.h
+//  Created by Ben Westcott on 10/17/26.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <stdexcept>
+#include <type_traits>
+#include "matrix.h"
+#include "matrix_view.h"
+#include "matrix_expr.h"
+#include "simd_kernels.h"
+#include "workspace.h"
+
+using std::size_t;
+
+// op(A) of gemv, as in BLAS
+enum class trans
+{
+    N,
+    T
+};
+
+// the side a reflector is applied from, see apply_reflector
+enum class side
+{
+    left,
+    right
+};
+
+/*
+ * y <- alpha * op(A) * x + beta * y, streaming A once in whatever layout it
+ * is stored, with no copies of its rows or columns:
+ *
+ *  - rows of op(A) contiguous: y(i) is a dot product along row i, four
+ *    rows at a time so each load of x serves four rows;
+ *  - columns of op(A) contiguous: y += alpha x(j) op(A)(:, j), four
+ *    columns at a time so y is loaded and stored once per four columns.
+ *
+ * Reversed views run forwards on the reversed x or y, other strides take
+ * a scalar loop in the same order. A strided x (for the dot products) or y
+ * (for the updates) is gathered into a workspace temporary first, which
+ * costs O(n) against the O(mn) of the product. The vector kernels are
+ * instantiated per instruction set like those of simd_kernels.h. Element
+ * types other than float and double run the scalar kernels. beta = 0 never
+ * reads y. y must not overlap A or x.
+ *
+ * rank1_update (A += alpha x y^T) runs the same update kernel along the
+ * contiguous dimension of A, and apply_reflector combines the two for
+ * Householder reflectors.
+ */
+namespace gemv_detail
+{
+
+constexpr size_t R = 4;
+
+// out[r] = sum_j a[r * lda + j] x[j], r < RS
+template<size_t RS, typename T>
+void dot_scalar(size_t n, T const* a, size_t lda, T const* x, T* out)
+{
+    for(size_t r=0; r < RS; r++)
+    {
+        T acc = static_cast<T>(0);
+        for(size_t j=0; j < n; j++)
+        {
+            acc += a[r * lda + j] * x[j];
+        }
+        out[r] = acc;
+    }
+}
+
+// y[j] += sum_r xs[r] a[r * lda + j], r < RS
+template<size_t RS, typename T>
+void axpy_scalar(size_t n, T const* a, size_t lda, T const* xs, T* y)
+{
+    for(size_t j=0; j < n; j++)
+    {
+        T acc = y[j];
+        for(size_t r=0; r < RS; r++)
+        {
+            acc += xs[r] * a[r * lda + j];
+        }
+        y[j] = acc;
+    }
+}
+
+#if LINALG_SIMD_X86
+
+// two accumulators per row, to cover the latency of the adds
+template<size_t W, size_t RS, typename T>
+[[gnu::always_inline]] inline void dot_vec(size_t n, T const* a, size_t lda, T const* x, T* out)
+{
+    typedef T vec __attribute__((vector_size(W)));
+    constexpr size_t L = W/sizeof(T);
+
+    vec acc[RS][2] = {};
+    size_t j=0;
+    for(; j + 2 * L <= n; j += 2 * L)
+    {
+        vec x0, x1;
+        __builtin_memcpy(&x0, x + j, W);
+        __builtin_memcpy(&x1, x + j + L, W);
+#pragma GCC unroll 4
+        for(size_t r=0; r < RS; r++)
+        {
+            vec a0, a1;
+            __builtin_memcpy(&a0, a + r * lda + j, W);
+            __builtin_memcpy(&a1, a + r * lda + j + L, W);
+            acc[r][0] += a0 * x0;
+            acc[r][1] += a1 * x1;
+        }
+    }
+
+    for(size_t r=0; r < RS; r++)
+    {
+        vec s = acc[r][0] + acc[r][1];
+        T sum = static_cast<T>(0);
+        for(size_t l=0; l < L; l++)
+        {
+            sum += s[l];
+        }
+        for(size_t k=j; k < n; k++)
+        {
+            sum += a[r * lda + k] * x[k];
+        }
+        out[r] = sum;
+    }
+}
+
+template<size_t W, size_t RS, typename T>
+[[gnu::always_inline]] inline void axpy_vec(size_t n, T const* a, size_t lda, T const* xs, T* y)
+{
+    typedef T vec __attribute__((vector_size(W)));
+    constexpr size_t L = W/sizeof(T);
+
+    size_t j=0;
+    for(; j + L <= n; j += L)
+    {
+        vec yv;
+        __builtin_memcpy(&yv, y + j, W);
+#pragma GCC unroll 4
+        for(size_t r=0; r < RS; r++)
+        {
+            vec av;
+            __builtin_memcpy(&av, a + r * lda + j, W);
+            yv += xs[r] * av;
+        }
+        __builtin_memcpy(y + j, &yv, W);
+    }
+
+    axpy_scalar<RS>(n - j, a + j, lda, xs, y + j);
+}
+
+template<size_t RS, typename T>
+[[gnu::target("avx512f,avx512bw,avx512dq,avx512vl")]] void dot_avx512(size_t n, T const* a, size_t lda, T const* x, T* out) { dot_vec<64, RS>(n, a, lda, x, out); }
+
+template<size_t RS, typename T>
+[[gnu::target("avx2,fma")]] void dot_avx2(size_t n, T const* a, size_t lda, T const* x, T* out) { dot_vec<32, RS>(n, a, lda, x, out); }
+
+template<size_t RS, typename T>
+[[gnu::target("sse2")]] void dot_sse2(size_t n, T const* a, size_t lda, T const* x, T* out) { dot_vec<16, RS>(n, a, lda, x, out); }
+
+template<size_t RS, typename T>
+[[gnu::target("avx512f,avx512bw,avx512dq,avx512vl")]] void axpy_avx512(size_t n, T const* a, size_t lda, T const* xs, T* y) { axpy_vec<64, RS>(n, a, lda, xs, y); }
+
+template<size_t RS, typename T>
+[[gnu::target("avx2,fma")]] void axpy_avx2(size_t n, T const* a, size_t lda, T const* xs, T* y) { axpy_vec<32, RS>(n, a, lda, xs, y); }
+
+template<size_t RS, typename T>
+[[gnu::target("sse2")]] void axpy_sse2(size_t n, T const* a, size_t lda, T const* xs, T* y) { axpy_vec<16, RS>(n, a, lda, xs, y); }
+
+#endif
+
+template<typename T>
+using dot_kernel = void (*)(size_t, T const*, size_t, T const*, T*);
+
+template<typename T>
+using axpy_kernel = void (*)(size_t, T const*, size_t, T const*, T*);
+
+// the kernels for R rows and for one row
+template<typename T>
+struct kernels
+{
+    dot_kernel<T> dot;
+    dot_kernel<T> dot1;
+    axpy_kernel<T> axpy;
+    axpy_kernel<T> axpy1;
+};
+
+template<typename T>
+kernels<T> select_kernels(void)
+{
+#if LINALG_SIMD_X86
+    if constexpr(std::is_same_v<T, float> || std::is_same_v<T, double>)
+    {
+        switch(simd::active_isa())
+        {
+            case simd::isa::avx512: return {dot_avx512<R, T>, dot_avx512<1, T>, axpy_avx512<R, T>, axpy_avx512<1, T>};
+            case simd::isa::avx2:
+                if(__builtin_cpu_supports("fma"))
+                {
+                    return {dot_avx2<R, T>, dot_avx2<1, T>, axpy_avx2<R, T>, axpy_avx2<1, T>};
+                }
+                [[fallthrough]];
+            case simd::isa::sse2: return {dot_sse2<R, T>, dot_sse2<1, T>, axpy_sse2<R, T>, axpy_sse2<1, T>};
+            default: break;
+        }
+    }
+#endif
+    return {dot_scalar<R, T>, dot_scalar<1, T>, axpy_scalar<R, T>, axpy_scalar<1, T>};
+}
+
+// stride between the elements of a vector view
+template<typename T>
+ptrdiff_t vec_stride(matrix_view<T> const& v)
+{
+    return (v.rows() == 1) ? v.col_stride() : v.row_stride();
+}
+
+// v as a contiguous array, in tmp if it is strided
+template<typename T>
+T const* contiguous(matrix_view<T const> const& v, ws_matrix<T>& tmp)
+{
+    ptrdiff_t s = vec_stride(v);
+    if(s == 1)
+    {
+        return v.data();
+    }
+
+    tmp = ws_matrix<T>(1, v.size());
+    for(size_t i=0; i < v.size(); i++)
+    {
+        tmp(0, i) = v.data()[static_cast<ptrdiff_t>(i) * s];
+    }
+    return tmp.data();
+}
+
+/*
+ * y <- alpha * A * x + beta * y, A with contiguous rows. Rows of A are
+ * taken R at a time and each result goes straight to y.
+ */
+template<typename T>
+void gemv_rows(T alpha, matrix_view<T const> const& A, matrix_view<T const> const& x, T beta, matrix_view<T> const& y)
+{
+    kernels<T> ker = select_kernels<T>();
+    size_t m = A.rows();
+    size_t n = A.cols();
+    size_t lda = static_cast<size_t>(A.row_stride());
+    ptrdiff_t ys = vec_stride(y);
+
+    workspace::frame frame;
+    ws_matrix<T> xtmp;
+    T const* xp = contiguous(x, xtmp);
+
+    T out[R];
+    for(size_t i=0; i < m; i += R)
+    {
+        size_t rs = std::min(R, m - i);
+        if(rs == R)
+        {
+            ker.dot(n, A.data() + i * lda, lda, xp, out);
+        }
+        else
+        {
+            for(size_t r=0; r < rs; r++)
+            {
+                ker.dot1(n, A.data() + (i + r) * lda, lda, xp, out + r);
+            }
+        }
+
+        for(size_t r=0; r < rs; r++)
+        {
+            T& yi = y.data()[static_cast<ptrdiff_t>(i + r) * ys];
+            yi = (beta == static_cast<T>(0)) ? alpha * out[r] : alpha * out[r] + beta * yi;
+        }
+    }
+}
+
+/*
+ * The same for A with contiguous columns: y accumulates alpha x(j) A(:, j),
+ * R columns at a time.
+ */
+template<typename T>
+void gemv_cols(T alpha, matrix_view<T const> const& A, matrix_view<T const> const& x, T beta, matrix_view<T> const& y)
+{
+    kernels<T> ker = select_kernels<T>();
+    size_t m = A.rows();
+    size_t n = A.cols();
+    size_t lda = static_cast<size_t>(A.col_stride());
+    ptrdiff_t xs = vec_stride(x);
+    ptrdiff_t ys = vec_stride(y);
+
+    workspace::frame frame;
+    ws_matrix<T> ytmp;
+    T* yp = y.data();
+    if(ys != 1)
+    {
+        ytmp = ws_matrix<T>(1, m);
+        yp = ytmp.data();
+    }
+
+    for(size_t i=0; i < m; i++)
+    {
+        T yi = (ys == 1) ? yp[i] : y.data()[static_cast<ptrdiff_t>(i) * ys];
+        yp[i] = (beta == static_cast<T>(0)) ? static_cast<T>(0) : beta * yi;
+    }
+
+    T ax[R];
+    for(size_t j=0; j < n; j += R)
+    {
+        size_t rs = std::min(R, n - j);
+        for(size_t r=0; r < rs; r++)
+        {
+            ax[r] = alpha * x.data()[static_cast<ptrdiff_t>(j + r) * xs];
+        }
+
+        if(rs == R)
+        {
+            ker.axpy(m, A.data() + j * lda, lda, ax, yp);
+        }
+        else
+        {
+            for(size_t r=0; r < rs; r++)
+            {
+                ker.axpy1(m, A.data() + (j + r) * lda, lda, ax + r, yp);
+            }
+        }
+    }
+
+    if(ys != 1)
+    {
+        for(size_t i=0; i < m; i++)
+        {
+            y.data()[static_cast<ptrdiff_t>(i) * ys] = yp[i];
+        }
+    }
+}
+
+// any strides, row by row
+template<typename T>
+void gemv_strided(T alpha, matrix_view<T const> const& A, matrix_view<T const> const& x, T beta, matrix_view<T> const& y)
+{
+    ptrdiff_t xs = vec_stride(x);
+    ptrdiff_t ys = vec_stride(y);
+
+    for(size_t i=0; i < A.rows(); i++)
+    {
+        T const* a = A.data() + A.offset(i, 0);
+        T acc = static_cast<T>(0);
+        for(size_t j=0; j < A.cols(); j++)
+        {
+            acc += a[static_cast<ptrdiff_t>(j) * A.col_stride()] * x.data()[static_cast<ptrdiff_t>(j) * xs];
+        }
+
+        T& yi = y.data()[static_cast<ptrdiff_t>(i) * ys];
+        yi = (beta == static_cast<T>(0)) ? alpha * acc : alpha * acc + beta * yi;
+    }
+}
+
+template<typename T>
+void gemv(T alpha, matrix_view<T const> const& A, matrix_view<T const> const& x, T beta, matrix_view<T> const& y)
+{
+    if(!A.rows())
+    {
+        return;
+    }
+
+    if(!A.cols() || alpha == static_cast<T>(0))
+    {
+        ptrdiff_t ys = vec_stride(y);
+        for(size_t i=0; i < A.rows(); i++)
+        {
+            T& yi = y.data()[static_cast<ptrdiff_t>(i) * ys];
+            yi = (beta == static_cast<T>(0)) ? static_cast<T>(0) : beta * yi;
+        }
+        return;
+    }
+
+    // reversed views run forwards, with x or y reversed to match
+    if(A.col_stride() < 0)
+    {
+        gemv(alpha, A.reverse_cols(), x.reverse(), beta, y);
+        return;
+    }
+    if(A.row_stride() < 0)
+    {
+        gemv(alpha, A.reverse_rows(), x, beta, y.reverse());
+        return;
+    }
+
+    if(A.col_stride() == 1)
+    {
+        gemv_rows(alpha, A, x, beta, y);
+    }
+    else if(A.row_stride() == 1)
+    {
+        gemv_cols(alpha, A, x, beta, y);
+    }
+    else
+    {
+        gemv_strided(alpha, A, x, beta, y);
+    }
+}
+
+// A += alpha x y^T, along the contiguous dimension of A
+template<typename T>
+void rank1_update(matrix_view<T> const& A, T alpha, matrix_view<T const> const& x, matrix_view<T const> const& y)
+{
+    if(!A.rows() || !A.cols() || alpha == static_cast<T>(0))
+    {
+        return;
+    }
+
+    if(A.row_stride() < 0)
+    {
+        rank1_update(A.reverse_rows(), alpha, x.reverse(), y);
+        return;
+    }
+    if(A.col_stride() < 0)
+    {
+        rank1_update(A.reverse_cols(), alpha, x, y.reverse());
+        return;
+    }
+
+    kernels<T> ker = select_kernels<T>();
+    workspace::frame frame;
+    ws_matrix<T> tmp;
+
+    if(A.col_stride() == 1)
+    {
+        ptrdiff_t xs = vec_stride(x);
+        T const* yp = contiguous(y, tmp);
+        for(size_t i=0; i < A.rows(); i++)
+        {
+            T ax = alpha * x.data()[static_cast<ptrdiff_t>(i) * xs];
+            ker.axpy1(A.cols(), yp, 0, &ax, A.data() + i * A.row_stride());
+        }
+    }
+    else if(A.row_stride() == 1)
+    {
+        rank1_update(A.transpose(), alpha, y, x);
+    }
+    else
+    {
+        ptrdiff_t xs = vec_stride(x);
+        ptrdiff_t ys = vec_stride(y);
+        for(size_t i=0; i < A.rows(); i++)
+        {
+            T ax = alpha * x.data()[static_cast<ptrdiff_t>(i) * xs];
+            for(size_t j=0; j < A.cols(); j++)
+            {
+                A(i, j) += ax * y.data()[static_cast<ptrdiff_t>(j) * ys];
+            }
+        }
+    }
+}
+
+// columns of A per block of apply_reflector, at most block_max
+constexpr size_t block_bytes = 1 << 17;
+constexpr size_t block_max = 2048;
+
+/*
+ * A <- (I - beta v v^T) A = A - beta v (v^T A), a block of columns of A at
+ * a time: w = v^T A(:, blk) and then A(:, blk) -= beta v w, with w on the
+ * stack.
+ *
+ * With contiguous columns a block is about block_bytes of A, so it is
+ * still in cache for the update and A is read from memory once instead of
+ * twice. With contiguous rows the blocks are block_max wide: pieces of
+ * rows narrow enough to keep a block in cache are too short to stream, and
+ * when the rows are a large power of two apart they also thrash the cache
+ * sets and the TLB, so each pass streams (nearly) whole rows instead.
+ */
+template<typename T>
+void apply_reflector_left(matrix_view<T> const& A, matrix_view<T const> const& v, T beta)
+{
+    size_t m = A.rows();
+    size_t n = A.cols();
+    if(!m || !n)
+    {
+        return;
+    }
+
+    size_t nb = block_max;
+    if(A.col_stride() != 1)
+    {
+        nb = std::clamp(block_bytes/(m * sizeof(T)), size_t(16), block_max) & ~size_t(15);
+    }
+    alignas(64) T w[block_max];
+
+    for(size_t j=0; j < n; j += nb)
+    {
+        size_t cols = std::min(nb, n - j);
+        matrix_view<T> Ablk = A.sub_matrix(0, m, j, cols);
+        matrix_view<T> wv(w, 1, cols, cols);
+
+        gemv(static_cast<T>(1), matrix_view<T const>(Ablk).transpose(), v, static_cast<T>(0), wv);
+        rank1_update(Ablk, -beta, v, matrix_view<T const>(wv));
+    }
+}
+
+}
+
+/*
+ * y <- alpha * op(A) * x + beta * y for a matrix or view A and vectors x, y
+ * (row or column), see above.
+ */
+template<typename T, typename M, typename V>
+void gemv(T alpha, M const& A, V const& x, T beta, matrix_view<T> const& y, trans op = trans::N)
+{
+    matrix_view<T const> a = const_view(A);
+    matrix_view<T const> v = const_view(x);
+    if(op == trans::T)
+    {
+        a = a.transpose();
+    }
+
+    if(!v.is_vector() || !y.is_vector() || v.size() != a.cols() || y.size() != a.rows())
+    {
+        throw std::range_error("gemv: incorrect dimensions.");
+    }
+
+    gemv_detail::gemv(alpha, a, v, beta, y);
+}
+
+// A <- A + alpha * x * y^T in place, x and y vectors (row or column)
+template<typename T, typename X, typename Y>
+void rank1_update(matrix_view<T> const& A, T alpha, X const& x, Y const& y)
+{
+    matrix_view<T const> u = const_view(x);
+    matrix_view<T const> v = const_view(y);
+    if(!u.is_vector() || !v.is_vector() || u.size() != A.rows() || v.size() != A.cols())
+    {
+        throw std::range_error("rank1_update: incorrect dimensions.");
+    }
+
+    gemv_detail::rank1_update(A, alpha, u, v);
+}
+
+/*
+ * Applies the reflector P = I - beta v v^T to A in place, from the left
+ * (A <- P A) or from the right (A <- A P), fusing the gemv and the rank-1
+ * update in one blocked pass over A. From the right it is the left case
+ * on A^T.
+ */
+template<typename T, typename V>
+void apply_reflector(matrix_view<T> const& A, V const& v, T beta, side s = side::left)
+{
+    matrix_view<T const> u = const_view(v);
+    matrix_view<T> a = (s == side::left) ? A : A.transpose();
+    if(!u.is_vector() || u.size() != a.rows())
+    {
+        throw std::range_error("apply_reflector: incorrect dimensions.");
+    }
+
+    gemv_detail::apply_reflector_left(a, u, beta);
+}
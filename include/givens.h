@@ -6,6 +6,8 @@
 #pragma once
 
 #include "matrix.h"
+#include "fixed_matrix.h"
+#include "banded_matrix.h"
 #include "result.h"
 #include <cmath>
 
@@ -207,7 +209,7 @@ matrix<double>& row_step(matrix<double>& A, givens g, size_t i, size_t k, size_t
 {
     for(size_t j=scol; j < A.cols(); j++)
     {
-        A = rotate(A, g, i, j, k, j);
+        rotate(A, g, i, j, k, j);
     }
     return A;
 }
@@ -217,7 +219,7 @@ matrix<double>& col_step(matrix<double>& A, givens g, size_t i, size_t k, size_t
     double tau1, tau2;
     for(size_t j=srow; j < A.rows(); j++)
     {
-        A = rotate(A, g, j, i, j, k);
+        rotate(A, g, j, i, j, k);
     }
     return A;
 }
@@ -239,7 +241,7 @@ matrix<double>& QRfast(matrix<double>& A)
     
     if(A(M-2, 0) == A(M-1, 0))
     {
-        A = nudge_first_rotation(A, M);
+        nudge_first_rotation(A, M);
     }
     
     for(size_t j = 0; j < N; j++)
@@ -258,7 +260,7 @@ matrix<double>& QRfast(matrix<double>& A)
             //std::cout << "sa = " << ga.s << "\tca = " << ga.c << "\tra = " << r << "\tflat = " << ga.flat() << "\n";
 
             
-            A = row_step(A, g, i - 1, i, j);
+            row_step(A, g, i - 1, i, j);
             //A = row_update(A, ga, i -1, i, j);
             
             A(i, j) = g.flat();
@@ -284,7 +286,7 @@ matrix<double>& QRHfast(matrix<double>& A /* must be square! */)
     {
         g = givens(A(j, j), A(j + 1, j));
 
-        A = rotate(A, g, j, j + 1, j, N - 1);
+        rotate(A, g, j, j + 1, j, N - 1);
     }
 
     std::cout << A << "\n";
@@ -312,7 +314,7 @@ matrix<double> QRaccumulate(matrix<double> const& A)
             //std::cout << "i = " << i << "\tj = " << j << "\n";
             //std::cout << "rho= " << A(i, j) << "\n";
 
-            Q = col_step(Q, g, i - 1, i, 0);
+            col_step(Q, g, i - 1, i, 0);
             
             //std::cout << "Q = \n";
             //std::cout << Q << "\n";
@@ -327,7 +329,7 @@ result::QR<double> QR(matrix<double> const& A)
     result::QR<double> res;
     
     res.Y = matrix<double>(A);
-    res.Y = QRfast(res.Y);
+    QRfast(res.Y);
     
     res.Q = QRaccumulate(res.Y);
     
@@ -335,6 +337,137 @@ result::QR<double> QR(matrix<double> const& A)
     return res;
 }
 
+/*
+ * Givens QR of a banded A, O(n * kl * (kl + ku)). Column j has only kl
+ * entries to zero, and the rotations fill R in to kl + ku super
+ * diagonals, so the result is A widened to (kl, kl + ku) holding R, and
+ * like QRfast the rotation which zeroed (i, j) stored as rho in (i, j).
+ *
+ * Rotations are normalized to the sign flat() encodes, so the ones
+ * rebuilt in band_QR_solve are the ones which were applied to R.
+ */
+banded_matrix<double> band_QRfast(banded_matrix<double> const& A)
+{
+    size_t n = A.rows();
+    size_t kl = A.lower_bandwidth();
+    banded_matrix<double> F = A.widened(kl, kl + A.upper_bandwidth());
+
+    for(size_t j=0; j < n; j++)
+    {
+        size_t jend = F.last_col(j);
+        for(size_t i = std::min(n - 1, j + kl); i >= j + 1; i--)
+        {
+            givens g(F(i - 1, j), F(i, j));
+            if((std::abs(g.s) < std::abs(g.c)) ? (g.c < 0) : (g.s < 0))
+            {
+                g.c = -g.c;
+                g.s = -g.s;
+            }
+
+            // rows i - 1 and i, both are zero right of jend
+            double* r1 = &F(i - 1, j);
+            double* r2 = &F(i, j);
+            for(size_t c=0; c < jend - j; c++)
+            {
+                double tau1 = r1[c];
+                double tau2 = r2[c];
+
+                r1[c] = g.c * tau1 - g.s * tau2;
+                r2[c] = g.s * tau1 + g.c * tau2;
+            }
+
+            F(i, j) = g.flat();
+        }
+    }
+
+    return F;
+}
+
+// x with A x = b, F from band_QRfast(A)
+matrix<double> band_QR_solve(banded_matrix<double> const& F, matrix<double> const& b)
+{
+    size_t n = F.rows();
+    size_t kl = F.lower_bandwidth();
+    if(b.rows() != n || b.cols() != 1)
+    {
+        throw std::range_error("band_QR_solve: incorrect dimensions.");
+    }
+
+    // x <- Q^T b
+    matrix<double> x(b);
+    for(size_t j=0; j < n; j++)
+    {
+        for(size_t i = std::min(n - 1, j + kl); i >= j + 1; i--)
+        {
+            givens g(F(i, j));
+
+            double tau1 = x(i - 1, 0);
+            double tau2 = x(i, 0);
+
+            x(i - 1, 0) = g.c * tau1 - g.s * tau2;
+            x(i, 0) = g.s * tau1 + g.c * tau2;
+        }
+    }
+
+    transformation::banded::back_substitution(F, x);
+    return x;
+}
+
+namespace fixed
+{
+
+/*
+ * Givens QR of a fixed size M x N (M >= N) matrix. Zeroes each column
+ * bottom up like QRfast, applying every rotation to R and Q right away
+ * instead of storing it in the zeroed entry.
+ */
+template<size_t M, size_t N>
+result::fixed_QR<double, M, N> QR(fixed_matrix<double, M, N> const& A)
+{
+    static_assert(M >= N, "QR: requires M >= N.");
+
+    result::fixed_QR<double, M, N> res;
+    fixed_matrix<double, M, N>& R = res.Y;
+    fixed_matrix<double, M, M>& Q = res.Q;
+
+    R = A;
+    Q = fixed_matrix<double, M, M>::eye();
+
+    for(size_t j=0; j < N; j++)
+    {
+        for(size_t i = M - 1; i >= j + 1; i--)
+        {
+            givens g(R(i - 1, j), R(i, j));
+
+            // R <- G^T R, rows i - 1 and i
+            for(size_t c = j; c < N; c++)
+            {
+                double tau1 = R(i - 1, c);
+                double tau2 = R(i, c);
+
+                R(i - 1, c) = g.c * tau1 - g.s * tau2;
+                R(i, c) = g.s * tau1 + g.c * tau2;
+            }
+
+            // Q <- QG, cols i - 1 and i
+            for(size_t r=0; r < M; r++)
+            {
+                double tau1 = Q(r, i - 1);
+                double tau2 = Q(r, i);
+
+                Q(r, i - 1) = g.c * tau1 - g.s * tau2;
+                Q(r, i) = g.s * tau1 + g.c * tau2;
+            }
+
+            R(i, j) = 0.0;
+        }
+    }
+
+    return res;
+}
+
+}
+
 
 
 }
@@ -8,6 +8,7 @@
 #include "matrix.h"
 #include "products.h"
 #include "result.h"
+#include "workspace.h"
 
 namespace transformation
 {
@@ -24,8 +25,11 @@ namespace GS
  */
 result::QR<double> QR(const matrix<double>& X)
 {
-    matrix<double> V(X);
-    matrix<double> Qc(V.rows(), V.cols());
+    workspace::frame frame;
+    
+    // MGS only touches columns, keep them contiguous
+    ws_matrix<double, layout_left> V(X);
+    ws_matrix<double, layout_left> Qc(V.rows(), V.cols());
     
     size_t M = V.cols();
     matrix<double> R(M, M);
@@ -34,24 +38,26 @@ result::QR<double> QR(const matrix<double>& X)
     {
         R(j, j) = std::sqrt(col_norm2sq(V, j));
         
-        matrix<double> curr_col = (1/R(j, j)) * V.col(j);
-        
-        Qc.set_col(curr_col, j);
+        matrix_view<double> curr_col = Qc.col_view(j);
+        curr_col.assign(V.col_view(j));
+        curr_col *= (1/R(j, j));
         
         for(size_t k=j+1; k < M; k++)
         {
-            R(j, k) = inner_prod_1D(curr_col, V.col(k));
-            //cvecs(0, k) -= R(j, k) * Qc(0, j);
-            matrix<double> sub = V.col(k);
-            sub -= R(j, k) * curr_col;
+            matrix_view<double> vk = V.col_view(k);
             
-            V.set_col(sub, k);
+            R(j, k) = inner_prod_1D(curr_col, vk);
+            //cvecs(0, k) -= R(j, k) * Qc(0, j);
+            for(size_t r=0; r < vk.rows(); r++)
+            {
+                vk[r] -= R(j, k) * curr_col[r];
+            }
         }
     }
     
     //matrix<double> Q = from_cvecs(Qc);
     
-    return result::QR<double>(Qc, R);
+    return result::QR<double>(matrix<double>(Qc.view()), R);
 }
 
 /*
@@ -7,8 +7,11 @@
 
 #include <cstdint>
 #include "matrix.h"
+#include "fixed_matrix.h"
+#include "matrix_view.h"
 #include "products.h"
 #include "result.h"
+#include "workspace.h"
 
 // refs:
 // [1] Matrix Computations 4th ed. Golub, Van Loan
@@ -17,29 +20,23 @@
 // [4] https://nhigham.com/2020/09/15/what-is-a-householder-matrix/
 
 /*
- * TODO:
- * I shouldnt actually need to explicitly write algorithms for
- * XQ algs since they are just transposed problems of QX problems.
+ * XQ algorithms (QL, LQ, RQ and the lower hessenberg reduction) are not
+ * written out separately. They are the QX kernels (QRview, QRHview,
+ * QRaccumulate_view) run on a transposed and/or reversed matrix_view, which
+ * only rearranges strides. Anything done to speed up the QR kernels applies
+ * to every orientation.
  * 
- * This would require some "TransposeView" object which will effectively
- * wrap a matrix and reverse rows/cols in all its methods such that 
- * its treated as a transposed matrix. Then we can just run the XQ algs
- * on the TransposeView. 
- * 
- * This is kind of encroaching on the whole idea of making the matrix
- * class much less monolithic. I.e. if we have a TransposeView, then
- * this begs the question whether data access should even be defined in the 
- * matrix class, and the answer is no it shouldnt be. 
- * 
- * Instead, we should have a matrix engine which handles the data
- * and matrix contains an reference to an owning engine. Then when we want
- * to have alternative views of the data, we create a non-owning engine which
- * takes an owning reference, and views the data in the respective way. 
- * 
- * This extends even farther into the ability to view submatrices without
- * having to explicitly make a copy of the relevant data. It should be possible
- * to have a SubMatrixView which can read/write sections of the underlying data 
- * without having to copy it into a smaller matrix. 
+ * Reflectors are applied with apply_reflector (see gemv.h), which forms
+ * v^T A and updates A in one blocked pass, on a reversed view as well.
+ * Temporaries (house vectors and the working copies of QR and QL) are
+ * ws_matrix, so they come from the current workspace if there is one (see
+ * workspace.h). Each house vector is allocated once per call and resized
+ * in place as the steps shrink.
+ *
+ * TODO: this is kind of encroaching on the whole idea of making the matrix
+ * class much less monolithic. I.e. data access should be handled by a
+ * matrix engine, and matrix contains a reference to an owning engine. Then
+ * views would just be non-owning engines.
  */
 
 namespace transformation
@@ -50,18 +47,20 @@ namespace house
 
 struct house
 {
-    matrix<double> vec;
+    ws_matrix<double> vec;
     double beta;
     
     house() = default;
     house(matrix<double> const& v, double b);
-    house(matrix<double> const& vessential, size_t normi);
+    house(matrix_view<double const> const& vessential, size_t normi);
+    
+    void assign(matrix_view<double const> const& vessential, size_t normi);
 
     //house(matrix<double> const& x, size_t norm_indx);
 };
 
 house::house(matrix<double> const& v, double b)
-: vec(v), beta(b)
+: vec(v.view()), beta(b)
 { 
 }
 
@@ -71,9 +70,14 @@ house::house(matrix<double> const& v, double b)
  *      then        vessential = [v1 v2 ... vn]
  *      and         vec = [1 v1 v2 ... vn]
  */
-house::house(matrix<double> const& vessential, size_t normi)
+house::house(matrix_view<double const> const& vessential, size_t normi)
 {
-    vec = matrix<double>(vessential.size() + 1, 1);
+    assign(vessential, normi);
+}
+
+void house::assign(matrix_view<double const> const& vessential, size_t normi)
+{
+    vec.resize(vessential.size() + 1, 1);
     vec[normi] = 1.0;
     
     double norm2 = 0.0;
@@ -105,7 +109,7 @@ house::house(matrix<double> const& vessential, size_t normi)
  * lastly, v is normalized, i.e. v(0) = 1 so that v can be conviently stored in
  * the lower triangle of upper triangular matrix R, where zeros have been introduced
  */
-house housevec(matrix<double> const& cvec, size_t a)
+void housevec(house& h, matrix_view<double> const& cvec, size_t a)
 {
     //double sig = inner_prod_1D(cvec, cvec, 1);
     double sig = 0.0;
@@ -119,8 +123,10 @@ house housevec(matrix<double> const& cvec, size_t a)
     }
     
     double beta, mu;
-        
-    matrix<double> hv(cvec);
+    
+    ws_matrix<double>& hv = h.vec;
+    hv.resize(cvec.rows(), cvec.cols());
+    hv.view().assign(cvec);
     hv[a] = 1.0;
 
     double c0 = cvec[a];
@@ -148,23 +154,25 @@ house housevec(matrix<double> const& cvec, size_t a)
         
         h0 = hv[a];
         beta = 2*(h0*h0)/(sig + h0*h0);
-        hv = (1/h0) * hv;
+        hv *= (1/h0);
     }
     
     // Cost: roughly 3m flops
-    return house(hv, beta);
+    h.beta = beta;
 }
 
-matrix<double>& housestep(matrix<double>& A, house& h, size_t j)
+house housevec(matrix_view<double> const& cvec, size_t a)
 {
-    h = housevec(A.sub_col(j, A.rows() - j, j), 0);
-    
-    matrix<double> Asub = A.sub_matrix(j, A.rows() - j, j, A.cols() - j);
-    Asub -= h.beta * outer_prod_1D(h.vec, inner_left_prod(h.vec, Asub));
-    
-    A.set_sub_matrix(Asub, j, j);
+    house h;
+    housevec(h, cvec, a);
+    return h;
+}
+
+void housestep(matrix_view<double> const& A, house& h, size_t j)
+{
+    housevec(h, A.sub_col(j, A.rows() - j, j), 0);
     
-    return A;
+    apply_reflector(A.sub_matrix(j, A.rows() - j, j, A.cols() - j), h.vec, h.beta);
 }
 
 /*
@@ -172,37 +180,33 @@ matrix<double>& housestep(matrix<double>& A, house& h, size_t j)
  * i : nbr of rows/cols off from M x N to consider
  * k : corner value. This changes per iteration of QR and related factorizations.
  * hc: column to be considered in current iteration
- * s : index in house vector which is normalized. For QR, this is zero, for QL is the last elem
+ * s : index in house vector which is normalized. For QR, this is zero.
  */
-matrix<double>& colstep(matrix<double>& A, house& h, size_t i, size_t k, size_t hc, size_t s)
+void colstep(matrix_view<double> const& A, house& h, size_t i, size_t k, size_t hc, size_t s)
 {
-    h = housevec(A.sub_col(k, A.rows() - i, hc), s);
+    housevec(h, A.sub_col(k, A.rows() - i, hc), s);
     //std::cout << A.sub_col(k, A.rows() - i, hc) << "\n";
-    matrix<double> Asub = A.sub_matrix(k, A.rows() - i, k, A.cols() - i);
-    
-    Asub -= h.beta * outer_prod_1D(h.vec, inner_left_prod(h.vec, Asub));
-    A.set_sub_matrix(Asub, k, k);
-
-    return A;
+    apply_reflector(A.sub_matrix(k, A.rows() - i, k, A.cols() - i), h.vec, h.beta);
 }
 
-matrix<double>& QRstep(matrix<double>& A, house& h, size_t i)
+void QRstep(matrix_view<double> const& A, house& h, size_t i)
 {
-    return colstep(A, h, i, i, i, 0);
+    colstep(A, h, i, i, i, 0);
 }
 
 /*
- * Computes the QR factorization of input matrix A
- * and returns upper triangular matrix R and beta coefficients
+ * QR kernel. Works on any view of A, which is how QL, LQ and RQ
+ * are computed below (see the note at the top of this file).
  *
- * note that the lower triangle of R contains the essential house vectors
- * and thus the return type contains the factorized form of Q, i.e beta, v
+ * On return, the upper triangle of A holds R and the strict lower triangle
+ * holds the essential house vectors.
  */
-matrix<double>& QRfast(matrix<double>& A)
+void QRview(matrix_view<double> const& A)
 {
+    workspace::frame frame;
+    
     size_t M, N, n;
     house h;
-    //house h = houseinit(A, M, N, n);
 
     M = A.rows();
     N = n = A.cols();
@@ -214,7 +218,7 @@ matrix<double>& QRfast(matrix<double>& A)
     
     for(size_t j=0; j < n; j++)
     {
-        A = QRstep(A, h, j);
+        QRstep(A, h, j);
 
         if(j < M)
         {
@@ -225,33 +229,33 @@ matrix<double>& QRfast(matrix<double>& A)
             }
         }
     }
-    
-    return A;
 }
 
 /*
- * Accumulates the matrix Q = Q0 * Q1 * ... Qn
- * from its factorized form, being the lower triangle of R, and B
- * where the LT of R contains essential house vectors, and B is a vector
- * of corresponding beta coeffs
- *
- * Works with QR and QHR (hessenberg) reductions.
- *      For QR reductions, col_bias = 0
- *      For QH reductions, col_bias = 1
- *          In hessenburg reduction, the jth house vector gets stored in col j - 1
- *          since col j is one index too short to store the entire vector.
- *
- * Q *= Qj for j = 0, 1, 2, ... n - 1
+ * Computes the QR factorization of input matrix A
+ * and returns upper triangular matrix R and beta coefficients
  *
- * TODO: work with k optimization
+ * note that the lower triangle of R contains the essential house vectors
+ * and thus the return type contains the factorized form of Q, i.e beta, v
  */
-matrix<double> QRaccumulate(matrix<double> const& F, size_t k, size_t cb)
+matrix<double>& QRfast(matrix<double>& A)
+{
+    QRview(A);
+    return A;
+}
+
+/*
+ * Accumulates Q from the factored form F (see QRaccumulate below) into Q,
+ * which must be the M x M identity on entry. Both may be arbitrary views.
+ */
+void QRaccumulate_view(matrix_view<double> const& Q, matrix_view<double const> const& F, size_t cb)
 {
     size_t M = F.rows();
     size_t N = F.cols();
     
     int64_t n = (int64_t)N;
 
+    workspace::frame frame;
     house h;
     size_t normi = 0;
     
@@ -259,34 +263,40 @@ matrix<double> QRaccumulate(matrix<double> const& F, size_t k, size_t cb)
     {
         n--;
     }
-    //std::cout << "betalen = " << B.cols() << "\n";
     
-    matrix<double> Im = matrix<double>::eye(M);
-    matrix<double> Q = Im.sub_matrix(0, M, 0, M);
-    matrix<double> vhouse;
-    matrix<double> Qsub;
+    matrix_view<double> Qsub;
     
     for(int64_t j = n - 1 - (int64_t)cb; j >= 0; j--)
     {
-        //vhouse = matrix<double>(M - j - col_bias, 1);
-        //vhouse(0, 0) = 1.0;
-        
-        //matrix<double> Fjp1 = F.sub_col(j + 1 + col_bias, M - j - 1 - col_bias, j);
-        
-        //vhouse.set_sub_col(Fjp1, 1, 0);
-
-        h = house(F.sub_col(j + cb + 1, M - j - cb - 1, j), normi);
+        h.assign(F.sub_col(j + cb + 1, M - j - cb - 1, j), normi);
 
-        Qsub = Q.sub_matrix(j + cb, Q.rows()-j - cb, j + cb , Q.rows()-j - cb);
-        
-        //double beta = 2/(1+col_norm2sq_from(Fjp1, 0, 0));
+        Qsub = Q.sub_matrix(j + cb, M - j - cb, j + cb , M - j - cb);
 
         // Q <- (Im - beta*v*v^T)Q
-        Qsub -= h.beta * outer_prod_1D(h.vec, inner_left_prod(h.vec, Qsub));
-        
-        Q.set_sub_matrix(Qsub, j + cb, j + cb);
-
+        apply_reflector(Qsub, h.vec, h.beta);
     }
+}
+
+/*
+ * Accumulates the matrix Q = Q0 * Q1 * ... Qn
+ * from its factorized form, being the lower triangle of R, and B
+ * where the LT of R contains essential house vectors, and B is a vector
+ * of corresponding beta coeffs
+ *
+ * Works with QR and QHR (hessenberg) reductions.
+ *      For QR reductions, col_bias = 0
+ *      For QH reductions, col_bias = 1
+ *          In hessenburg reduction, the jth house vector gets stored in col j - 1
+ *          since col j is one index too short to store the entire vector.
+ *
+ * Q *= Qj for j = 0, 1, 2, ... n - 1
+ *
+ * TODO: work with k optimization
+ */
+matrix<double> QRaccumulate(matrix<double> const& F, size_t k, size_t cb)
+{
+    matrix<double> Q = matrix<double>::eye(F.rows());
+    QRaccumulate_view(Q, F, cb);
     return Q;
 }
 
@@ -300,11 +310,17 @@ result::QR<double> QR(matrix<double> const& A)
 {
     // TODO: add exception throw for M < N
     result::QR<double> res;
+    workspace::frame frame;
     
-    res.Y = matrix<double>(A);
-    res.Y = QRfast(res.Y);
+    // the kernels work column by column, so factor a column-major copy
+    ws_matrix<double, layout_left> F(A);
+    ws_matrix<double, layout_left> Q = ws_matrix<double, layout_left>::eye(F.rows());
     
-    res.Q = QRaccumulate(res.Y, res.Y.rows(), 0);
+    QRview(F);
+    QRaccumulate_view(Q, F, 0);
+    
+    res.Y = matrix<double>(F.view());
+    res.Q = matrix<double>(Q.view());
     
     // cleanup
     res.Y.fill_lower_triangle(0.0);
@@ -313,42 +329,59 @@ result::QR<double> QR(matrix<double> const& A)
 }
 
 /*
- * Computes an upper hessenberg reduction for a N x N square matrix A
- * and stores essential house vectors in the zeroed portion of A (lower hess))
- * note that house vectors will be offset to the left by one column since A becomes upper hessenberg.
- * Thus, if Qaccumulate needs to be used, col_bias = 1
- *
- * A <- QAQ^T, where Q is orthogonal, and A becomes upper hessenberg
+ * Same as QR for M >= N, with R returned packed (see triangular_matrix.h):
+ * the triangle is copied straight out of the factored form, so neither
+ * the zeros below it nor the M - N zero rows are stored or filled.
  */
-matrix<double>& QRHfast(matrix<double> &A /* must be square*/)
+result::QRp<double> QR_packed(matrix<double> const& A)
+{
+    size_t M = A.rows();
+    size_t N = A.cols();
+    
+    if(M < N)
+    {
+        throw std::range_error("QR_packed: requires M >= N.");
+    }
+    
+    result::QRp<double> res;
+    workspace::frame frame;
+    
+    ws_matrix<double, layout_left> F(A);
+    ws_matrix<double, layout_left> Q = ws_matrix<double, layout_left>::eye(M);
+    
+    QRview(F);
+    QRaccumulate_view(Q, F, 0);
+    
+    res.Q = matrix<double>(Q.view());
+    res.R = triangular_matrix<double>(F.view().sub_matrix(0, N, 0, N));
+    
+    return res;
+}
+
+/*
+ * Upper hessenberg kernel on a view, see QRHfast.
+ */
+void QRHview(matrix_view<double> const& A /* must be square*/)
 {
     size_t N = A.rows();
+    
+    workspace::frame frame;
     house h;
-    matrix<double> Ablk, Apar;
+    matrix_view<double> Ablk, Apar;
     
-    for(size_t k=0; k < N - 2; k++)
+    for(size_t k=0; k + 2 < N; k++)
     {
-        h = housevec(A.sub_col(k + 1, N - k - 1, k), 0);
+        housevec(h, A.sub_col(k + 1, N - k - 1, k), 0);
                 
         Ablk = A.sub_matrix(k + 1, N - k - 1, k, N - k);
         
-        //std::cout << "Ablk:\n";
-        //std::cout << Ablk << "\n";
-        
         // A <- QA
-        Ablk -= h.beta * outer_prod_1D(h.vec, inner_left_prod(h.vec, Ablk));
-        
-        A.set_sub_matrix(Ablk, k + 1, k);
+        apply_reflector(Ablk, h.vec, h.beta);
         
         Apar = A.sub_matrix(0, N, k + 1, N - k - 1);
         
-        //std::cout << "Apar:\n";
-        //std::cout << Apar << "\n";
-        
         // A <- A(Q^T)
-        Apar -= h.beta * outer_prod_1D(inner_right_prod(Apar, h.vec), h.vec);
-        
-        A.set_sub_matrix(Apar, 0, k + 1);
+        apply_reflector(Apar, h.vec, h.beta, side::right);
         
         size_t i=1;
         for(size_t j = k + 2; j < N; j++, i++)
@@ -356,6 +389,19 @@ matrix<double>& QRHfast(matrix<double> &A /* must be square*/)
             A(j, k) = h.vec[i];
         }
     }
+}
+
+/*
+ * Computes an upper hessenberg reduction for a N x N square matrix A
+ * and stores essential house vectors in the zeroed portion of A (lower hess))
+ * note that house vectors will be offset to the left by one column since A becomes upper hessenberg.
+ * Thus, if Qaccumulate needs to be used, col_bias = 1
+ *
+ * A <- QAQ^T, where Q is orthogonal, and A becomes upper hessenberg
+ */
+matrix<double>& QRHfast(matrix<double> &A /* must be square*/)
+{
+    QRHview(A);
     return A;
 }
 
@@ -365,7 +411,7 @@ result::QRH<double> QRH(matrix<double> const& A)
     result::QRH<double> res;
     
     res.Y = matrix<double>(A);
-    res.Y = QRHfast(res.Y);
+    QRHfast(res.Y);
     
     res.Q = QRaccumulate(res.Y, res.Y.rows(), 1);
     
@@ -376,6 +422,8 @@ result::QRH<double> QRH(matrix<double> const& A)
 
 result::FPr<double> colpiv_QRfast(matrix<double>& A)
 {
+    workspace::frame frame;
+    
     size_t M, N, n;
     house h;
     //house h = houseinit(A, M, N, n);
@@ -411,7 +459,7 @@ result::FPr<double> colpiv_QRfast(matrix<double>& A)
         A.swap_cols(r, k);
         c.swap_cols(r, k);
         
-        A = QRstep(A, h, r);
+        QRstep(A, h, r);
         
         if(r < M)
         {
@@ -434,170 +482,49 @@ result::FPr<double> colpiv_QRfast(matrix<double>& A)
     return result::FPr<double>(A, piv, r);
 }
 
-matrix<double>& QLstep(matrix<double>& A, house& h, size_t i)
-{
-    /*
-    matrix<double>& colstep(matrix<double>& A, house& h, size_t i, size_t k, size_t hc, size_t s)
-
-
-    h = housevec(A.sub_col(k, A.rows() - i, hc), s);
-    matrix<double> Asub = A.sub_matrix(k, A.rows() - i, k, A.cols() - i);
-    
-    Asub -= h.beta * outer_prod_1D(h.vec, inner_left_prod(h.vec, Asub));
-    A.set_sub_matrix(Asub, k, k);
-    */
-    return colstep(A, h, i, 0, A.cols() - i - 1, A.rows() - i - 1);
-}
-
+/*
+ * QL: the QR kernel on A with its rows and columns reversed.
+ * If P reverses order, then QR of PAP gives A = (PQP)(PRP), where PRP is
+ * lower triangular (aligned to the bottom right for M > N).
+ * The essential house vectors land above the diagonal of L, in column N - j - 1.
+ */
 matrix<double>& QLfast(matrix<double>& A)
 {
-    size_t M, N, n;
-    house h;
-    //house h = houseinit(A, M, N, n);
-
-    M = A.rows();
-    N = n = A.cols();
-
-    if(M == N)
-    {
-        n--;
-    }
-    
-    for(size_t j=0; j < n; j++)
-    {
-        A = QLstep(A, h, j);
-        
-        //std::cout << A << "\n";
-        
-        //std::cout << "vhouse" << j << "\n";
-        //std::cout << h.vec << "\n";
-        
-        if(j < M)
-        {
-            for(size_t k=0; k < M - j - 1; k++)
-            {
-                A(k, N - j - 1) = h.vec[k];
-            }
-        }
-    }
-    
+    QRview(A.view().reverse());
     return A;
 }
 
 matrix<double> QLaccumulate(matrix<double> const& F, size_t col_bias)
 {
-    size_t M = F.rows();
-    size_t N = F.cols();
-    
-    int64_t n = (int64_t)N;
-    int64_t end_cond = 0;
-    int64_t nhrows = M;
-    int64_t cb = (int64_t)col_bias;
-    
-    house h;
-    size_t normi = nhrows - cb - 1;
-    
-    if(M == N)
-    {
-        end_cond++;
-    }
-    
-    matrix<double> Q = matrix<double>::eye(M);
-    matrix<double> vhouse, Qsub;
-    
-    //std::cout << "F = \n";
-    //std::cout << F << "\n";
-    
-    for(int64_t j = n - 1 - cb; j >= end_cond; j--)
-    {
-        //vhouse = matrix<double>(nhrows - cb, 1);
-        //vhouse(nhrows - 1 - cb, 0) = 1.0;
-        
-        //std::cout << "nhcols: " << nhcols << "\n";
-        //matrix<double> hj = F.sub_col(0, nhrows - 1 - cb, j + cb);
-
-        h = house(F.sub_col(0, nhrows - 1 - cb, j + cb), normi);
-
-        //vhouse.set_sub_col(hj, 0, 0);
-        //std::cout << "vhouse: \n";
-        //std::cout << vhouse << "\n";
-        
-        // TODO: why is this M - cb and not M - j - cb????
-        Qsub = Q.sub_matrix(0, M - cb, 0, nhrows - cb);
-        
-        //std::cout << "Qsub: \n";
-        //std::cout << Qsub << "\n";
-        //std::cout << vhouse << "\n";
-        
-        //double beta = 2/(1 + col_norm2sq_from(hj, 0, 0));
-        
-        //Qsub -= beta * outer_prod_1D(vhouse, inner_left_prod(vhouse, Qsub));
-        Qsub -= h.beta * outer_prod_1D(inner_right_prod(Qsub, h.vec), h.vec);
-        
-        //std::cout << "Qsubp: \n";
-        //std::cout << Qsub << "\n";
-        
-        Q.set_sub_matrix(Qsub, 0, 0);
-        
-        //std::cout << "Q: \n";
-        //std::cout << Q << "\n";
-        
-        //std::cout << "Q" << j << "\n";
-        //std::cout << Q << "\n";
-        
-        nhrows--;
-        normi--;
-    }
-    
+    matrix<double> Q = matrix<double>::eye(F.rows());
+    QRaccumulate_view(Q.view().reverse(), F.view().reverse(), col_bias);
     return Q;
 }
 
 result::QL<double> QL(matrix<double> const& A)
 {
     result::QL<double> res;
+    workspace::frame frame;
     
-    res.Y = matrix<double>(A);
-    res.Y = QLfast(res.Y);
+    // column-major working copy, as in QR
+    ws_matrix<double, layout_left> F(A);
+    ws_matrix<double, layout_left> Q = ws_matrix<double, layout_left>::eye(F.rows());
+    
+    QRview(F.view().reverse());
+    QRaccumulate_view(Q.view().reverse(), F.view().reverse(), 0);
     
-    res.Q = QLaccumulate(res.Y, 0);
+    res.Y = matrix<double>(F.view());
+    res.Q = matrix<double>(Q.view());
 
     matrix<double>::set_lower_tri(res.Y, 0.0, 2);
     
     return res;
 }
 
+// lower hessenberg, A <- QAQ^T. Same as QRHfast on the reversed view.
 matrix<double>& QLHfast(matrix<double>& A)
 {
-    size_t M = A.rows();
-    house h;
-    matrix<double> Ablk, Apar;
-    
-    for(size_t j=0; j < M - 2; j++)
-    {
-        h = housevec(A.sub_col(0, M - j - 1, M - j - 1), M - j - 2);
-        
-        Ablk = A.sub_matrix(0, M - j - 1, 0, M - j);
-        
-        //std::cout << "Ablk:\n";
-        //std::cout << Ablk << "\n";
-        Ablk -= h.beta * outer_prod_1D(h.vec, inner_left_prod(h.vec, Ablk));
-        
-        A.set_sub_matrix(Ablk, 0, 0);
-        
-        Apar = A.sub_matrix(0, M, 0, M - j - 1);
-        
-        //std::cout << "Apar:\n";
-        //std::cout << Apar << "\n";
-        Apar -= h.beta * outer_prod_1D(inner_right_prod(Apar, h.vec), h.vec);
-        
-        A.set_sub_matrix(Apar, 0, 0);
-        
-        for(size_t k = 0; k < M - j - 2; k++)
-        {
-            A(k, M - j - 1) = h.vec[k];
-        }
-    }
-    
+    QRHview(A.view().reverse());
     return A;
 }
 
@@ -605,7 +532,7 @@ result::QLH<double> QLH(matrix<double> const& A)
 {
     result::QLH<double> res;
     res.Y = matrix<double>(A);
-    res.Y = QLHfast(res.Y);
+    QLHfast(res.Y);
     
     res.Q = QLaccumulate(res.Y, 1);
 
@@ -614,195 +541,62 @@ result::QLH<double> QLH(matrix<double> const& A)
     return res;
 }
 
+/*
+ * RQ (M <= N): A^T = QL, so A = (L^T)(Q^T). That is the QR kernel on
+ * the transposed, reversed view of A.
+ * The essential house vectors are stored in row M - i - 1, left of R.
+ *
+ * The columns of the transposed view are rows of A, so unlike QR and QL,
+ * RQ and LQ already run along contiguous storage on row-major input.
+ */
 matrix<double>& RQfast(matrix<double>& A)
 {
-    size_t M, N, m;
-    house h;
-    
-    M = m = A.rows();
-    N = A.cols();
-
-    if(M == N)
-    {
-        m--;
-    }
-    
-    matrix<double> Asub;
-
-    for(size_t i=0; i < m; i++)
-    {
-        std::cout << "i= " << i << "\n";
-        std::cout << A.sub_row(M - i - 1, 0, N - i) << "\n";
-
-        h = housevec(A.sub_row(M - i - 1, 0, N - i), N - i - 1);
-        std::cout << "vhouse = \n";
-        std::cout << h.vec << "\n";
-
-        Asub = A.sub_matrix(0, M - i, 0, N - i);
-
-        std::cout << "Asub = \n";
-        std::cout << Asub << "\n";
-
-        Asub -= h.beta * outer_prod_1D(inner_right_prod(Asub, h.vec), h.vec);
-
-        A.set_sub_matrix(Asub, 0, 0);
-
-        if(i < N)
-        {
-            for(size_t k=0; k < N - i - 1; k++)
-            {
-                A(M - i - 1, k) = h.vec[k];
-            }
-        }
-
-        std::cout << "A = \n";
-        std::cout << A << "\n";
-        std::cout << "\n-------------------------------------\n";
-
-    }
+    QRview(A.view().transpose().reverse());
     return A;
 }
 
-matrix<double> RQaccumulate(matrix<double> const& F/*, size_t col_bias*/)
+matrix<double> RQaccumulate(matrix<double> const& F)
 {
-    size_t M = F.rows();
-    size_t N = F.cols();
-    
-    int64_t m = (int64_t)M;
-    int64_t end_cond = 0;
-    int64_t nhcols = N;
-    //int64_t cb = (int64_t)col_bias;
-    
-    house h;
-    size_t normi = nhcols /*- cb*/ - 1;
-
-    if(M == N)
-    {
-        end_cond++;
-    }
-
-    matrix<double> Q = matrix<double>::eye(N);
-    matrix<double> vhouse, Qsub;
-    
-    //std::cout << "F = \n";
-    //std::cout << F << "\n";
-    
-    for(int64_t i = m - 1 /*-cb*/; i >= end_cond; i--)
-    {
-        std::cout << "nhcols = " << nhcols << "\tnormi = " << normi << "\n";
-        std::cout << F.sub_row(i, 0, nhcols - 1);
-        h = house(F.sub_row(i, 0, nhcols - 1), normi);
-        std::cout << h.vec << "\n";
-
-        Qsub = Q.sub_matrix(0, nhcols/*-cb*/, 0, N /*-cb*/);
-
-        Qsub -= h.beta * outer_prod_1D(h.vec, inner_left_prod(h.vec, Qsub));
-        Q.set_sub_matrix(Qsub, 0, 0);
-
-        std::cout << "Q = \n";
-        std::cout << Q << "\n";
-
-        nhcols--;
-        normi--;
-    }
-
+    matrix<double> Q = matrix<double>::eye(F.cols());
+    QRaccumulate_view(Q.view().transpose().reverse(), F.view().transpose().reverse(), 0);
     return Q;
 }
 
-
-
-matrix<double>& LQfast(matrix<double>& A)
+result::RQ<double> RQ(matrix<double> const& A)
 {
-    size_t M, m, N;
-    house h;
-    matrix<double> Asub;
-
-    M = m = A.rows();
-    N = A.cols();
-    
-    if(M == N)
-    {
-        m--;
-    }
+    result::RQ<double> res;
     
-    std::cout << A << "\n";
+    res.Y = matrix<double>(A);
+    RQfast(res.Y);
+    res.Q = RQaccumulate(res.Y);
     
-    for(size_t i=0; i < m; i++)
+    // R is upper triangular, aligned to the right
+    matrix_view<double> Yrt = res.Y.view().transpose().reverse();
+    for(size_t c=0; c < Yrt.cols(); c++)
     {
-        std::cout << "i= " << i << "\n";
-        std::cout << A.sub_row(i, i, N - i) << "\n\n";
-
-        h = housevec(A.sub_row(i, i, N - i), 0);
-        
-        Asub = A.sub_matrix(i, M - i, i, N - i);
-        
-        Asub -= h.beta * outer_prod_1D(inner_right_prod(Asub, h.vec), h.vec);
-        
-        A.set_sub_matrix(Asub, i, i);
-        
-        std::cout << "hvec = \n";
-        std::cout << h.vec << "\n";
-        
-        if(i < N)
+        for(size_t r = c + 1; r < Yrt.rows(); r++)
         {
-            size_t k=1;
-            for(size_t j=i+1; j < N; j++, k++)
-            {
-                A(i, j) = h.vec(0, k);
-            }
+            Yrt(r, c) = 0.0;
         }
     }
     
-    std::cout << A << "\n";
-    
+    return res;
+}
+
+/*
+ * LQ (M <= N): A^T = QR, so A = (R^T)(Q^T). That is the QR kernel on
+ * the transposed view of A. The essential house vectors are stored right of L.
+ */
+matrix<double>& LQfast(matrix<double>& A)
+{
+    QRview(A.view().transpose());
     return A;
 }
 
 matrix<double> LQaccumulate(matrix<double> const& F)
 {
-    size_t M = F.rows();
-    size_t N = F.cols();
-    
-    int64_t m = (int64_t)M;
-    
-    if(M == N)
-    {
-        m--;
-    }
-    
-    matrix<double> Q, vhouse, Qsub;
-
-    house h;
-    size_t normi = 0;
-
-    Q = matrix<double>::eye(N);
-    
-    for(int64_t i = m - 1; i >= 0; i--)
-    {
-        //vhouse = matrix<double>(1, N - i);
-        //vhouse[0] = 1.0;
-        
-        //Fh = F.sub_row(i, i + 1, N - i - 1);
-        
-        //vhouse.set_sub_row(Fh, 0, 1);
-
-        h = house(F.sub_row(i, i + 1, N - i - 1), normi);
-        
-        Qsub = Q.sub_matrix(i, N - i, i, N - i);
-        
-        //double beta = 2/(1 + vec_norm2sq_from(Fh, 0));
-        Qsub -= h.beta * outer_prod_1D(inner_right_prod(Qsub, h.vec), h.vec);
-        //Qsub -= h.beta * outer_prod_1D(h.vec, inner_left_prod(h.vec, Qsub));
-        
-        std::cout << "Qsub = \n";
-        std::cout << Qsub << "\n";
-        
-        //std::cout << "vhouse = \n";
-        //std::cout << vhouse << "\n";
-        
-        Q.set_sub_matrix(Qsub, i, i);
-    }
-    
+    matrix<double> Q = matrix<double>::eye(F.cols());
+    QRaccumulate_view(Q.view().transpose(), F.view().transpose(), 0);
     return Q;
 }
 
@@ -818,6 +612,98 @@ result::LQ<double> LQ(matrix<double> const& A)
     return res;
 }
 
+namespace fixed
+{
+
+/*
+ * QR of a fixed size M x N (M >= N) matrix, with Q accumulated on the fly.
+ * Same reflectors as housevec/QRview, but the house vector and both
+ * factors live on the stack and all loop bounds are compile-time constants.
+ */
+template<size_t M, size_t N>
+result::fixed_QR<double, M, N> QR(fixed_matrix<double, M, N> const& A)
+{
+    static_assert(M >= N, "QR: requires M >= N.");
+
+    result::fixed_QR<double, M, N> res;
+    fixed_matrix<double, M, N>& R = res.Y;
+    fixed_matrix<double, M, M>& Q = res.Q;
+
+    R = A;
+    Q = fixed_matrix<double, M, M>::eye();
+
+    constexpr size_t n = (M == N) ? N - 1 : N;
+
+    for(size_t j=0; j < n; j++)
+    {
+        // house vector of R(j:M, j), v(j) = 1
+        fixed_matrix<double, M, 1> v;
+        double sig = 0.0;
+        for(size_t i = j + 1; i < M; i++)
+        {
+            v[i] = R(i, j);
+            sig += v[i] * v[i];
+        }
+
+        double x0 = R(j, j);
+        double beta = 0.0;
+        v[j] = 1.0;
+
+        if(sig == 0.0)
+        {
+            beta = (x0 >= 0.0) ? 0.0 : 2.0;
+        }
+        else
+        {
+            double mu = std::sqrt(x0 * x0 + sig);
+            double v0 = (x0 <= 0.0) ? x0 - mu : -sig/(x0 + mu);
+
+            beta = 2 * (v0 * v0)/(sig + v0 * v0);
+            for(size_t i = j + 1; i < M; i++)
+            {
+                v[i] /= v0;
+            }
+        }
+
+        // R <- (I - beta*v*v^T)R
+        for(size_t c = j; c < N; c++)
+        {
+            double w = 0.0;
+            for(size_t i = j; i < M; i++)
+            {
+                w += v[i] * R(i, c);
+            }
+
+            w *= beta;
+            for(size_t i = j; i < M; i++)
+            {
+                R(i, c) -= w * v[i];
+            }
+        }
+
+        // Q <- Q(I - beta*v*v^T)
+        for(size_t r=0; r < M; r++)
+        {
+            double w = 0.0;
+            for(size_t i = j; i < M; i++)
+            {
+                w += Q(r, i) * v[i];
+            }
+
+            w *= beta;
+            for(size_t i = j; i < M; i++)
+            {
+                Q(r, i) -= w * v[i];
+            }
+        }
+    }
+
+    R.fill_lower_triangle(0.0);
+    return res;
+}
+
+}
+
 
 
 
@@ -6,7 +6,9 @@
 #pragma once
 
 #include "matrix.h"
+#include "symmetric_matrix.h"
 #include "linalg_exceptions.h"
+#include "workspace.h"
 #include <cmath>
 #include <tuple>
 
@@ -22,7 +24,8 @@ namespace transformation
 {
 
 // finds the abs max value for row k in upper triangle of input matrix mat
-size_t off_diag_row_abs_max(size_t k, size_t N, size_t bias, const matrix<double>& mat)
+template<typename M>
+size_t off_diag_row_abs_max(size_t k, size_t N, size_t bias, const M& mat)
 {
     size_t m = k + 1 + bias;
     for(size_t i = k + 2; i < N; i++)
@@ -46,83 +49,6 @@ struct eigen_result
 namespace jacobi
 {
 
-/*
- * 1) theta = atan(2*A(p, q)/(A(q, q) - A(p, p)) if A(p, p) != A(q, q) else pi/2
- * 2) form rotation matrix with cos(theta)'s and sin(theta)'s
- *
- * which is equivalent to doing:
- *
- * 1) beta = (A(q, q) - A(p, p))/(2*A(p, q))
- * 2) t = sgn(beta)/(abs(beta) + sqrt(beta^2 + 1))
- * 3) cos(theta) = 1/sqrt(t^2 + 1)
- * 4) sin(theta) = t/sqrt(t^2 + 1)
- *
- */
-void factors(double App, double Aqq, double Apq, double& c, double& s, double& t)
-{
-    // TODO: Apq could be zero or close to zero
-    if(App != Aqq)
-    {
-        double beta = (Aqq - App)/(2*Apq);
-        t = msgn(beta)/(std::abs(beta) + std::sqrt(beta * beta + 1));
-        
-        c = 1/std::sqrt(t * t + 1);
-        s = t*c;
-    }
-    else
-    {
-        // e^(j*pi/2) = 0 + j1
-        c = 0;
-        s = 1;
-        
-    }
-}
-
-matrix<double> rotation_matrix(const matrix<double>& A, size_t p, size_t q)
-{
-    /*
-     if(p == q)
-     {
-     throw non_distinct_indicies_error();
-     }
-     
-     if(std::max(p, q) >= mat.rows())
-     {
-     throw std::range_error("Index p, q is out of range.");
-     }*/
-    
-    double t, s, c;
-    matrix<double> Q = matrix<double>::identity(A.rows());
-    
-    factors(A(p, p), A(q, q), A(p, q), c, s, t);
-    
-    Q(p, p) = Q(q, q) = c;
-    Q(p, q) = s;
-    Q(q, p) = -s;
-    
-    return Q;
-}
-
-void k_update(size_t k, double& ek, double t, size_t& state, bool& ck)
-{
-    double y = ek;
-    ek = y + t;
-    
-    // relies on double precision float rounding,
-    // i.e. t is so small that y + t makes no change to y
-    // TODO: Add tolerance
-    if(ck && y == ek)
-    {
-        ck = false;
-        state--;
-    }
-    else if(!ck && y != ek)
-    {
-        ck = true;
-        state++;
-    }
-}
-
 /*
  * preforms:
  *
@@ -130,7 +56,8 @@ void k_update(size_t k, double& ek, double t, size_t& state, bool& ck)
  * Aij =  s   c  *  Aij
  *
  */
-void rotate(matrix<double>& A, size_t k, size_t l, size_t i, size_t j, double s, double c)
+template<typename M>
+void rotate(M& A, size_t k, size_t l, size_t i, size_t j, double s, double c)
 {
     double akl = A(k, l);
     double aij = A(i, j);
@@ -139,25 +66,33 @@ void rotate(matrix<double>& A, size_t k, size_t l, size_t i, size_t j, double s,
     A(i, j) = s*akl + c*aij;
 }
 
-eigen_result eigen(matrix<double>& A)
+/*
+ * Classical Jacobi on packed storage, see [1]. The rotations only go
+ * through the upper triangle, which in a symmetric_matrix is the whole
+ * matrix, so nothing goes stale. Eigenvalues are unordered, eigenvectors
+ * are the columns of vectors. A is overwritten, the eigen overloads below
+ * pass a working copy held in the current workspace.
+ *
+ * Stops once the largest off diagonal element is negligible next to both
+ * of its diagonal elements (Rutishauser's test). Waiting instead for the
+ * eigenvalues to stop changing leaves off diagonal elements of order
+ * sqrt(eps) * |A| behind, since a rotation changes them by about p^2/d.
+ */
+eigen_result eigen_in_place(symmetric_matrix<double, workspace_allocator<double>>& A)
 {
     size_t N = A.rows();
-    size_t state = N;
     
-    matrix<double> eigvalues(1, A.cols());
-    matrix<double> eigvectors(matrix<double>::identity(A.rows()));
-    // keeps track of whether Akl = Apq has changed in the current iteration
-    matrix<bool> changed(1, N);
-    matrix<size_t> max_iv(1, N);
+    matrix<double> eigvalues(1, N);
+    matrix<double> eigvectors(matrix<double>::eye(N));
+    ws_matrix<size_t> max_iv(1, N);
         
     for(size_t k=0; k < N; k++)
     {
-        max_iv(0, k) = off_diag_row_abs_max(k, N, 0, A);
+        max_iv(0, k) = (k + 1 < N) ? off_diag_row_abs_max(k, N, 0, A) : k;
         eigvalues(0, k) = A(k, k);
-        changed(0, k) = true;
     }
     
-    while(state != 0)
+    while(N > 1)
     {
         size_t m = 0;
         
@@ -173,24 +108,32 @@ eigen_result eigen(matrix<double>& A)
         size_t k = m;
         size_t l = max_iv(0, m);
         double p = A(k, l);
-        double c, s, t;
+        double g = 100 * std::abs(p);
+        double ek = std::abs(eigvalues(0, k));
+        double el = std::abs(eigvalues(0, l));
         
-        factors(eigvalues(0, l), eigvalues(0, k), p, c, s, t);
+        if(ek + g == ek && el + g == el)
+        {
+            break;
+        }
         
-        t *= -p;
-        s = -s;
+        double y = (eigvalues(0, l) - eigvalues(0, k))/2;
+        double d = std::abs(y) + std::hypot(p, y);
+        double r = std::hypot(p, d);
+        double c = d/r;
+        double s = p/r;
+        double t = p*p/d;
         
-        std::cout << t << "\n";
+        if(y < 0)
+        {
+            s = -s;
+            t = -t;
+        }
         
         A(k, l) = 0.0;
         
-        // update eigenvalues, state and changed arrays corresponding to entry A(k, l)
-        k_update(k, eigvalues(0, k), -t, state, changed(0, k));
-        k_update(l, eigvalues(0, l), t, state, changed(0, l));
-        
-        // here, I am only rotating the indicies in the upper triangle
-        // since rotating the lower triangle is the transpose of rotating
-        // the upper triangle
+        eigvalues(0, k) -= t;
+        eigvalues(0, l) += t;
         
         for(size_t i=0; i < k; i++)
         {
@@ -206,18 +149,56 @@ eigen_result eigen(matrix<double>& A)
         {
             rotate(A, k, i, l, i, s, c);
         }
+        
         for(size_t i=0; i < N; i++)
         {
             rotate(eigvectors, i, k, i, l, s, c);
+        }
+        
+        // rows above l saw columns k and l change, rows k and l changed entirely
+        for(size_t i=0; i < l && i + 1 < N; i++)
+        {
+            size_t& mi = max_iv(0, i);
+            if(i == k || mi == k || mi == l)
+            {
+                mi = off_diag_row_abs_max(i, N, 0, A);
+                continue;
+            }
             
-            // update abs max locations for each row in upper triangle of A
-            max_iv(0, i) = off_diag_row_abs_max(i, N, 0, A);
+            if(k > i && std::abs(A(i, k)) > std::abs(A(i, mi)))
+            {
+                mi = k;
+            }
+            if(std::abs(A(i, l)) > std::abs(A(i, mi)))
+            {
+                mi = l;
+            }
+        }
+        if(l + 1 < N)
+        {
+            max_iv(0, l) = off_diag_row_abs_max(l, N, 0, A);
         }
     }
     
     return eigen_result(eigvalues, eigvectors);
 }
 
+// the working copy comes from the current workspace, see workspace.h
+eigen_result eigen(symmetric_matrix<double> const& S)
+{
+    workspace::frame frame;
+    symmetric_matrix<double, workspace_allocator<double>> A(S);
+    return eigen_in_place(A);
+}
+
+// reads the upper triangle of A only
+eigen_result eigen(matrix<double>& A)
+{
+    workspace::frame frame;
+    symmetric_matrix<double, workspace_allocator<double>> S(A);
+    return eigen_in_place(S);
+}
+
 matrix<double>& diagonalize(matrix<double>& A)
 {
     eigen_result res = eigen(A);
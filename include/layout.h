@@ -0,0 +1,45 @@
+//
+//  layout.h
+//  Created by Ben Westcott on 10/17/26.
+//
+
+#pragma once
+
+#include <cstddef>
+#include "matrix_view.h"
+
+using std::size_t;
+
+/*
+ * Storage order policies for matrix<T>, named after their std::mdspan
+ * counterparts.
+ *
+ * A matrix is stored as a sequence of equally long lines (rows for
+ * layout_right, columns for layout_left) whose starts are ld elements apart.
+ * The policies map that onto the row and column strides of matrix_view, so
+ * anything which goes through views works on either layout.
+ */
+struct layout_right
+{
+    static constexpr size_t lines(size_t r, size_t) { return r; }
+    static constexpr size_t line_size(size_t, size_t c) { return c; }
+
+    static constexpr size_t row_stride(size_t ld) { return ld; }
+    static constexpr size_t col_stride(size_t) { return 1; }
+
+    // reorients v so that its rows run along the storage lines
+    template<typename T>
+    static matrix_view<T> by_lines(matrix_view<T> const& v) { return v; }
+};
+
+struct layout_left
+{
+    static constexpr size_t lines(size_t, size_t c) { return c; }
+    static constexpr size_t line_size(size_t r, size_t) { return r; }
+
+    static constexpr size_t row_stride(size_t) { return 1; }
+    static constexpr size_t col_stride(size_t ld) { return ld; }
+
+    template<typename T>
+    static matrix_view<T> by_lines(matrix_view<T> const& v) { return v.transpose(); }
+};
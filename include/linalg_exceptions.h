@@ -31,5 +31,3 @@ class non_distinct_indicies_error : public std::exception
     }
 };
 
-
-#endif /* exceptions_h */
@@ -9,7 +9,21 @@
 #include <iomanip>
 #include <random>
 #include <algorithm>
+#include <atomic>
 #include <cstdint>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "aligned_allocator.h"
+#include "layout.h"
+#include "matrix_view.h"
+#include "matrix_expr.h"
+#include "matrix_file.h"
+#include "philox.h"
+#include "transpose.h"
+#include "simd_kernels.h"
 
 /*
  * TODO: expand matrix template so that we can
@@ -17,20 +31,70 @@
  * at compile time
  */
 
+/*
+ * Storage is row-major (layout_right, the default) or column-major
+ * (layout_left), see layout.h. Lines (rows, resp. columns) start a leading
+ * dimension (stride) apart, which is at least the line size. Matrices are
+ * packed unless created with padded() or with_stride(), which pad each line
+ * out to a multiple of the allocator's alignment so every line start is aligned.
+ *
+ * Linear indexing ([], get_value(offs)) addresses raw storage, i.e. it only
+ * walks the matrix element by element when it is packed, and in storage order.
+ * Use offset() or (r, c) for anything that may be padded or column-major.
+ * Constructors taking flat data always read it row by row.
+ *
+ * Matrices of different layouts convert into each other through their views,
+ * e.g. matrix<double, layout_left> F(A).
+ *
+ * Copies are deep unless the source has copy_on_write() enabled, in which
+ * case the copy shares its buffer (and inherits the mode). Either side
+ * detaches, i.e. takes a private copy, on its first write through a
+ * non-const member: operator(), operator[], get_value, set_value, data(),
+ * the views, the fill methods and the in-place arithmetic. Const members
+ * never copy, so reading a shared input is free, and they only hand out
+ * T const*, T const& and matrix_view<T const>, so nothing obtained from
+ * them writes the buffer.
+ *
+ * save() writes the binary format of matrix_file.h and load() reads it,
+ * both streaming at disk speed. mapped() opens such a file without reading
+ * it, pages are faulted in as they are touched. A
+ * read_only mapping is shared with every other process mapping the file and
+ * behaves like a shared copy-on-write buffer: copies share it, and the first
+ * write through a non-const member detaches into memory of our own (see
+ * map_mode::read_only in matrix_file.h). A copy_on_write mapping is
+ * private, the kernel copies each page on its first write and the file is
+ * never changed.
+ */
+
 using std::size_t;
 
-template<typename T>
+template<typename T, typename Layout = layout_right, typename Alloc = aligned_allocator<T>>
 class matrix
 {
 public:
+    using value_type = T;
+
     matrix(size_t size = 0);
     matrix(size_t size, T const* dat);
         
-    matrix<T>& reshape(size_t new_r, size_t new_c);
+    matrix<T, Layout, Alloc>& reshape(size_t new_r, size_t new_c);
+    matrix<T, Layout, Alloc>& resize(size_t new_r, size_t new_c);
+    matrix<T, Layout, Alloc>& reserve(size_t n);
+    matrix<T, Layout, Alloc>& shrink_to_fit(void);
+    
+    template<typename X>
+    matrix<T, Layout, Alloc>& append_row(X const& rvec);
+    
     matrix(size_t r, size_t c);
     matrix(size_t r, size_t c, T const* dat);
     
-    matrix(matrix<T> const& rhs);
+    matrix(matrix<T, Layout, Alloc> const& rhs);
+    explicit matrix(matrix_view<T const> const& rhs);
+    
+    // evaluates a lazy expression (see matrix_expr.h)
+    template<typename E>
+        requires lazy_matrix_expr<E>
+    matrix(E const& expr);
     
     matrix(std::initializer_list<T> dat);
     matrix(std::initializer_list<std::initializer_list<T>> dat);
@@ -39,7 +103,7 @@ public:
 
     ~matrix(void);
     
-    friend void swap(matrix<T>& lhs, matrix<T>& rhs) noexcept
+    friend void swap(matrix<T, Layout, Alloc>& lhs, matrix<T, Layout, Alloc>& rhs) noexcept
     {
         using std::swap;
         
@@ -48,27 +112,40 @@ public:
         swap(lhs.m_rows, rhs.m_rows);
         swap(lhs.m_cols, rhs.m_cols);
         swap(lhs.m_size, rhs.m_size);
+        swap(lhs.m_ld, rhs.m_ld);
+        swap(lhs.m_capacity, rhs.m_capacity);
+        swap(lhs.m_cow, rhs.m_cow);
+        swap(lhs.m_readonly, rhs.m_readonly);
         swap(lhs.m_data, rhs.m_data);
     }
     
-    // TODO: not sure if i want to continue using copy-swap for copy/move assignment...
-    // considering matrices can be very large, then passing by value here becomes extremely inefficient...
-    matrix<T>& operator=(matrix<T> rhs);
-    matrix(matrix<T>&& rhs) noexcept;
-    //matrix<T>& operator=(matrix<T>&& rhs);
+    matrix<T, Layout, Alloc>& operator=(matrix<T, Layout, Alloc> const& rhs);
+    matrix<T, Layout, Alloc>& operator=(matrix<T, Layout, Alloc>&& rhs) noexcept;
+    matrix(matrix<T, Layout, Alloc>&& rhs) noexcept;
     
     size_t size(void) const { return m_size; }
     size_t rows(void) const { return m_rows; }
     size_t cols(void) const { return m_cols; }
+    size_t stride(void) const { return m_ld; }
+    size_t capacity(void) const { return m_capacity; }
     
+    bool is_packed(void) const { return (m_ld == Layout::line_size(m_rows, m_cols)); }
     bool is_square(void) const { return (m_rows == m_cols); }
     bool is_row_vector(void) const;
     bool is_col_vector(void) const;
     bool is_vector(void) const;
     
-    T* data(void) const { return m_data.get(); }
+    T const* data(void) const { return m_data.get(); }
+    T* data(void) { detach(); return m_data.get(); }
+    
+    // copy-on-write mode, see the top of this file
+    matrix<T, Layout, Alloc>& copy_on_write(bool enable = true);
+    bool is_copy_on_write(void) const { return m_cow; }
+    bool is_shared(void) const { return m_data && m_data.use_count() > 1; }
+    void detach(void);
     
-    T& get_value(size_t offs) const;
+    T const& get_value(size_t offs) const;
+    T& get_value(size_t offs);
     void set_value(size_t offs, T value);
     T& operator[](size_t offs);
 	const T operator[](size_t offs) const;
@@ -76,7 +153,8 @@ public:
     size_t row_offset(size_t m) const;
     size_t offset(size_t m, size_t n) const;
     
-    T& get_value(size_t m, size_t n) const;
+    T const& get_value(size_t m, size_t n) const;
+    T& get_value(size_t m, size_t n);
     void set_value(size_t m, size_t n, T value);
     T& operator()(size_t m, size_t n);
     const T operator()(size_t m, size_t n) const;
@@ -95,304 +173,659 @@ public:
     
     void set_identity(void);
     
-    bool content_equals(matrix<T> const& rhs) const;
-    bool equals(matrix<T> const& rhs) const;
+    bool content_equals(matrix<T, Layout, Alloc> const& rhs) const;
+    bool equals(matrix<T, Layout, Alloc> const& rhs) const;
     bool is_symmetric(void) const;
 
-    matrix<T> row(size_t r) const;
-    matrix<T>& set_row(matrix<T> const& rvec, size_t r);
+    matrix<T, Layout, Alloc> row(size_t r) const;
+    matrix<T, Layout, Alloc>& set_row(matrix<T, Layout, Alloc> const& rvec, size_t r);
 
-    matrix<T> col(size_t c) const;
-    matrix<T>& set_col(matrix<T> const& cvec, size_t c);
+    matrix<T, Layout, Alloc> col(size_t c) const;
+    matrix<T, Layout, Alloc>& set_col(matrix<T, Layout, Alloc> const& cvec, size_t c);
 
-    matrix<T>& swap_rows(size_t r1, size_t r2);
-    matrix<T>& swap_cols(size_t c1, size_t c2);
-    matrix<T>& sub_rows(size_t r1, size_t r2, T factor);
+    matrix<T, Layout, Alloc>& swap_rows(size_t r1, size_t r2);
+    matrix<T, Layout, Alloc>& swap_cols(size_t c1, size_t c2);
+    matrix<T, Layout, Alloc>& sub_rows(size_t r1, size_t r2, T factor);
     
-    matrix<T>& permute_rows(matrix<size_t> const& rpermute);
-    matrix<T>& permute_cols(matrix<size_t> const& cpermute);
+    matrix<T, Layout, Alloc>& permute_rows(matrix<size_t> const& rpermute);
+    matrix<T, Layout, Alloc>& permute_cols(matrix<size_t> const& cpermute);
 
-    matrix<T> transpose(void) const;
-    matrix<T> diag(void) const;
+    matrix<T, Layout, Alloc> transpose(void) const;
+    matrix<T, Layout, Alloc> transpose(tdpool& pool) const;
+    matrix<T, Layout, Alloc>& transpose_in_place(void);
+    matrix<T, Layout, Alloc>& transpose_in_place(tdpool& pool);
+    matrix<T, Layout, Alloc> diag(void) const;
 
-    std::pair<matrix<T>, matrix<T>> split_rows(size_t at_row) const;
-    std::pair<matrix<T>, matrix<T>> split_cols(size_t at_col) const;
+    std::pair<matrix<T, Layout, Alloc>, matrix<T, Layout, Alloc>> split_rows(size_t at_row) const;
+    std::pair<matrix<T, Layout, Alloc>, matrix<T, Layout, Alloc>> split_cols(size_t at_col) const;
 
-    matrix<T> sub_matrix(size_t start_row, size_t nrows, size_t start_col, size_t ncols) const;
-    matrix<T> sub_matrix(size_t start_row, size_t start_col) const;
-    matrix<T>& set_sub_matrix(matrix<T> const& sub, size_t start_row, size_t start_col);
+    matrix<T, Layout, Alloc> sub_matrix(size_t start_row, size_t nrows, size_t start_col, size_t ncols) const;
+    matrix<T, Layout, Alloc> sub_matrix(size_t start_row, size_t start_col) const;
+    matrix<T, Layout, Alloc>& set_sub_matrix(matrix<T, Layout, Alloc> const& sub, size_t start_row, size_t start_col);
 
-    matrix<T> sub_col(size_t start_row, size_t nrows, size_t c) const;
-    matrix<T>& set_sub_col(matrix<T> const& sub, size_t start_row, size_t c);
+    matrix<T, Layout, Alloc> sub_col(size_t start_row, size_t nrows, size_t c) const;
+    matrix<T, Layout, Alloc>& set_sub_col(matrix<T, Layout, Alloc> const& sub, size_t start_row, size_t c);
     
-    matrix<T> sub_row(size_t r, size_t start_col, size_t ncols) const;
-    matrix<T>& set_sub_row(matrix<T> const& sub, size_t r, size_t start_col);
+    matrix<T, Layout, Alloc> sub_row(size_t r, size_t start_col, size_t ncols) const;
+    matrix<T, Layout, Alloc>& set_sub_row(matrix<T, Layout, Alloc> const& sub, size_t r, size_t start_col);
 
-    template<typename R> 
-    matrix<T>& operator+=(matrix<R> const& rhs);
+    // non-owning views, see matrix_view.h. These read this matrix in place.
+    matrix_view<T const> view(void) const;
+    operator matrix_view<T const>(void) const { return view(); }
+    
+    matrix_view<T const> row_view(size_t r) const;
+    matrix_view<T const> col_view(size_t c) const;
+    matrix_view<T const> diag_view(void) const;
+    
+    matrix_view<T const> sub_view(size_t start_row, size_t nrows, size_t start_col, size_t ncols) const;
+    matrix_view<T const> sub_view(size_t start_row, size_t start_col) const;
+    matrix_view<T const> sub_col_view(size_t start_row, size_t nrows, size_t c) const;
+    matrix_view<T const> sub_row_view(size_t r, size_t start_col, size_t ncols) const;
+    
+    // the same for writing, detaching a shared buffer first
+    matrix_view<T> view(void);
+    operator matrix_view<T>(void) { return view(); }
+    
+    matrix_view<T> row_view(size_t r) { return view().row(r); }
+    matrix_view<T> col_view(size_t c) { return view().col(c); }
+    matrix_view<T> diag_view(void) { return view().diag(); }
+    
+    matrix_view<T> sub_view(size_t start_row, size_t nrows, size_t start_col, size_t ncols) { return view().sub_matrix(start_row, nrows, start_col, ncols); }
+    matrix_view<T> sub_view(size_t start_row, size_t start_col) { return view().sub_matrix(start_row, start_col); }
+    matrix_view<T> sub_col_view(size_t start_row, size_t nrows, size_t c) { return view().sub_col(start_row, nrows, c); }
+    matrix_view<T> sub_row_view(size_t r, size_t start_col, size_t ncols) { return view().sub_row(r, start_col, ncols); }
+
+    template<typename R, typename RLayout, typename RAlloc> 
+    matrix<T, Layout, Alloc>& operator+=(matrix<R, RLayout, RAlloc> const& rhs);
 
-    template<typename R> 
-    matrix<T>& operator-=(matrix<R> const& rhs);
+    template<typename R, typename RLayout, typename RAlloc> 
+    matrix<T, Layout, Alloc>& operator-=(matrix<R, RLayout, RAlloc> const& rhs);
+    
+    template<typename E>
+        requires lazy_matrix_expr<E>
+    matrix<T, Layout, Alloc>& operator+=(E const& expr);
+    
+    template<typename E>
+        requires lazy_matrix_expr<E>
+    matrix<T, Layout, Alloc>& operator-=(E const& expr);
     
     template<typename R>
-    matrix<T>& operator*=(R scalar);
+    matrix<T, Layout, Alloc>& operator*=(R scalar);
+
+    static matrix<T, Layout, Alloc> with_stride(size_t nrows, size_t ncols, size_t ld);
+    static matrix<T, Layout, Alloc> padded(size_t nrows, size_t ncols);
+    static size_t padded_stride(size_t n);
 
-    static matrix<T> eye(size_t rank);
-	static matrix<T> ones(size_t nrows, size_t ncols);
+    void save(std::string const& path, bool checksum = false, size_t chunk_lines = 0) const;
+    static matrix<T, Layout, Alloc> load(std::string const& path);
+    static matrix<T, Layout, Alloc> mapped(std::string const& path, matrix_file::map_mode mode = matrix_file::map_mode::read_only);
+
+    static matrix<T, Layout, Alloc> eye(size_t rank);
+	static matrix<T, Layout, Alloc> ones(size_t nrows, size_t ncols);
     static matrix<size_t> unit_permutation_matrix(size_t rank);
     
-    static matrix<T>& set_lower_tri(matrix<T> & rhs, T val, int64_t exrows);
+    static matrix<T, Layout, Alloc>& set_lower_tri(matrix<T, Layout, Alloc> & rhs, T val, int64_t exrows);
     
     
-    // TODO: soon we will need to generate random matrix types i.e. symmetric, orthogonal, skew, pos. definite, etc. to test various algos
-    static matrix<T> random_dense_matrix(size_t nrows, size_t ncols, float lowerbound, float upperbound);
+    // unseeded, see random_matrix.h for reproducible, parallel and structured generators
+    static matrix<T, Layout, Alloc> random_dense_matrix(size_t nrows, size_t ncols, float lowerbound, float upperbound);
     
-    static matrix<T> abs(matrix<T> const& rhs);
-    static matrix<T> absdiff(matrix<T> const& rhs, matrix<T> const& lhs);
-    static T abs_max_err(matrix<T> const& result, matrix<T> const& expected);
-    static size_t abs_max_excess_err(matrix<T> const& result, matrix<T> const& expected, T tolerance);
+    static matrix<T, Layout, Alloc> abs(matrix<T, Layout, Alloc> const& rhs);
+    static matrix<T, Layout, Alloc> absdiff(matrix<T, Layout, Alloc> const& rhs, matrix<T, Layout, Alloc> const& lhs);
+    static T abs_max_err(matrix<T, Layout, Alloc> const& result, matrix<T, Layout, Alloc> const& expected);
+    static size_t abs_max_excess_err(matrix<T, Layout, Alloc> const& result, matrix<T, Layout, Alloc> const& expected, T tolerance);
     
-    static T abs_max_element(matrix<T> const& rhs, size_t from_row);
+    static T abs_max_element(matrix<T, Layout, Alloc> const& rhs, size_t from_row);
 
 
 
 private:
     
+    static std::shared_ptr<T> allocate(size_t n);
+    
+    // number of elements of storage in use, padding included
+    size_t storage_size(void) const { return m_size ? Layout::lines(m_rows, m_cols) * m_ld : 0; }
+    
+    // view of the storage at dat, which is m_data or its detached copy
+    template<typename U>
+    matrix_view<U> storage_view(U* dat) const;
+    
+    // calls f(line, n) for each storage line, or once for all of it when packed
+    template<typename F>
+    void for_each_line(F&& f) const;
+    
+    // permutation helpers, gather: new[i] = old[p[i]], scatter: new[p[i]] = old[i]
+    static void check_permutation(matrix<size_t> const& p, char const* what);
+    void permute_lines(matrix<size_t> const& p, bool gather);
+    void permute_within_lines(matrix<size_t> const& p, bool gather);
+    
     size_t m_rows;
     size_t m_cols;
     size_t m_size;
+    size_t m_ld;
+    size_t m_capacity;
+    bool m_cow;
+    // m_data is a read only mapping, detach() always copies
+    bool m_readonly;
     std::shared_ptr<T> m_data;
     
 };
 
-template<typename T>
-matrix<T>::matrix(size_t size)
-: m_size(size), m_rows(size ? size : 1), m_cols(1),
-  m_data(size ? new T[size]() : nullptr)
+template<typename T, typename Layout, typename Alloc>
+std::shared_ptr<T> matrix<T, Layout, Alloc>::allocate(size_t n)
+{
+    if(!n)
+    {
+        return nullptr;
+    }
+    
+    Alloc alloc;
+    T* dat = alloc.allocate(n);
+    std::uninitialized_value_construct_n(dat, n);
+    
+    // the control block comes from alloc as well
+    return std::shared_ptr<T>
+    (
+        dat,
+        [alloc, n](T* p) mutable
+        {
+            std::destroy_n(p, n);
+            alloc.deallocate(p, n);
+        },
+        alloc
+    );
+}
+
+template<typename T, typename Layout, typename Alloc>
+matrix<T, Layout, Alloc>::matrix(size_t size)
+: m_rows(size ? size : 1), m_cols(1), m_size(size), m_ld(Layout::line_size(m_rows, 1)),
+  m_capacity(size), m_cow(false), m_readonly(false), m_data(allocate(size))
 {
       //std::cout << "\tcalled default constructor\n";
 }
 
-template<typename T>
-matrix<T>::matrix(size_t size, T const* dat)
-: matrix<T>(size)
+template<typename T, typename Layout, typename Alloc>
+matrix<T, Layout, Alloc>::matrix(size_t size, T const* dat)
+: matrix<T, Layout, Alloc>(size)
 {
     //std::cout << "\tcalled size, data constructor\n";
     std::copy(dat, dat + size, data());
 }
 
-template<typename T>
-matrix<T>& matrix<T>::reshape(size_t new_r, size_t new_c)
+template<typename T, typename Layout, typename Alloc>
+matrix<T, Layout, Alloc>& matrix<T, Layout, Alloc>::reshape(size_t new_r, size_t new_c)
 {
     if((new_r * new_c) != m_size)
     {
-        throw std::range_error("reshape: requires that new dimensions are compatible with the existing size. Use realloc to resize and/or reshape.");
+        throw std::range_error("reshape: requires that new dimensions are compatible with the existing size. Use resize to change the size.");
+    }
+    
+    if(!is_packed())
+    {
+        throw std::range_error("reshape: matrix is padded.");
     }
     
     //std::cout << "\tcalled reshape\n";
     
     m_rows = new_r;
     m_cols = new_c;
+    m_ld = Layout::line_size(new_r, new_c);
     
     return *this;
 }
 
-template<typename T>
-matrix<T>::matrix(size_t r, size_t c)
-: matrix<T>(r * c)
+/*
+ * Resizes to new_r x new_c keeping the overlapping top left block, new
+ * elements are zero. Works in the current buffer when its capacity allows,
+ * moving lines in place if the line size changes. Otherwise storage grows to
+ * at least twice its capacity, so appending rows one at a time to a row-major
+ * matrix is amortised O(cols) per row. Padded matrices stay padded.
+ *
+ * Views of the matrix are invalidated.
+ */
+template<typename T, typename Layout, typename Alloc>
+matrix<T, Layout, Alloc>& matrix<T, Layout, Alloc>::resize(size_t new_r, size_t new_c)
+{
+    if(!new_r || !new_c)
+    {
+        throw std::range_error("resize: dimensions must be non-zero.");
+    }
+    
+    size_t old_lines = m_size ? Layout::lines(m_rows, m_cols) : 0;
+    size_t old_line_size = m_size ? Layout::line_size(m_rows, m_cols) : 0;
+    size_t new_lines = Layout::lines(new_r, new_c);
+    size_t new_line_size = Layout::line_size(new_r, new_c);
+    
+    size_t new_ld = new_line_size;
+    if(m_size && !is_packed())
+    {
+        new_ld = (new_line_size <= m_ld) ? m_ld : padded_stride(new_line_size);
+    }
+    
+    size_t keep_lines = std::min(old_lines, new_lines);
+    size_t keep = std::min(old_line_size, new_line_size);
+    size_t needed = new_lines * new_ld;
+    
+    // a reallocation copies out of a shared buffer anyway, no need to detach first
+    T* src = (needed > m_capacity) ? m_data.get() : data();
+    if(needed > m_capacity)
+    {
+        size_t new_capacity = std::max(needed, 2 * m_capacity);
+        std::shared_ptr<T> new_data = allocate(new_capacity);
+        
+        for(size_t l=0; l < keep_lines; l++)
+        {
+            std::copy(src + l * m_ld, src + l * m_ld + keep, new_data.get() + l * new_ld);
+        }
+        
+        m_data = std::move(new_data);
+        m_capacity = new_capacity;
+        m_readonly = false;
+    }
+    else if(new_ld < m_ld)
+    {
+        for(size_t l=0; l < keep_lines; l++)
+        {
+            std::copy(src + l * m_ld, src + l * m_ld + keep, src + l * new_ld);
+        }
+    }
+    else if(new_ld > m_ld)
+    {
+        for(size_t l = keep_lines; l-- > 0;)
+        {
+            std::copy_backward(src + l * m_ld, src + l * m_ld + keep, src + l * new_ld + keep);
+        }
+    }
+    
+    // zero whatever wasn't carried over, the buffer may hold stale elements
+    T* dst = data();
+    for(size_t l=0; l < new_lines; l++)
+    {
+        size_t from = (l < keep_lines) ? keep : 0;
+        std::fill(dst + l * new_ld + from, dst + l * new_ld + new_line_size, static_cast<T>(0.0));
+    }
+    
+    m_rows = new_r;
+    m_cols = new_c;
+    m_size = new_r * new_c;
+    m_ld = new_ld;
+    
+    return *this;
+}
+
+/*
+ * Makes room for n elements of storage, padding included, without changing
+ * the dimensions. Views of the matrix are invalidated if it reallocates.
+ */
+template<typename T, typename Layout, typename Alloc>
+matrix<T, Layout, Alloc>& matrix<T, Layout, Alloc>::reserve(size_t n)
+{
+    if(n <= m_capacity)
+    {
+        return *this;
+    }
+    
+    std::shared_ptr<T> new_data = allocate(n);
+    std::copy(m_data.get(), m_data.get() + storage_size(), new_data.get());
+    
+    // the new buffer is private, whatever the old one was
+    m_data = std::move(new_data);
+    m_capacity = n;
+    m_readonly = false;
+    
+    return *this;
+}
+
+// releases capacity beyond the storage in use
+template<typename T, typename Layout, typename Alloc>
+matrix<T, Layout, Alloc>& matrix<T, Layout, Alloc>::shrink_to_fit(void)
+{
+    // not through a copy, which would share the buffer in copy-on-write mode
+    if(m_capacity > storage_size())
+    {
+        std::shared_ptr<T> new_data = allocate(storage_size());
+        std::copy(m_data.get(), m_data.get() + storage_size(), new_data.get());
+        
+        m_data = std::move(new_data);
+        m_capacity = storage_size();
+        m_readonly = false;
+    }
+    
+    return *this;
+}
+
+/*
+ * Appends a row vector (matrix, fixed_matrix or view) as the new last row,
+ * an empty matrix takes its column count from it. rvec must not be a view of
+ * this matrix, since the append may reallocate.
+ */
+template<typename T, typename Layout, typename Alloc>
+template<typename X>
+matrix<T, Layout, Alloc>& matrix<T, Layout, Alloc>::append_row(X const& rvec)
+{
+    matrix_view<T const> v = const_view(rvec);
+    
+    if(!v.is_row_vector() || (m_size && v.cols() != m_cols))
+    {
+        throw std::range_error("append_row: incorrect column dimensions.");
+    }
+    
+    resize(m_size ? m_rows + 1 : 1, v.cols());
+    row_view(m_rows - 1).assign(v);
+    
+    return *this;
+}
+
+/*
+ * Turns copy-on-write on or off for this matrix and future copies of it.
+ * Turning it off detaches first, since writes no longer check for sharing.
+ */
+template<typename T, typename Layout, typename Alloc>
+matrix<T, Layout, Alloc>& matrix<T, Layout, Alloc>::copy_on_write(bool enable)
+{
+    if(!enable)
+    {
+        detach();
+    }
+    
+    m_cow = enable;
+    return *this;
+}
+
+// takes a private copy of a buffer shared through copy-on-write, or mapped read only
+template<typename T, typename Layout, typename Alloc>
+inline void matrix<T, Layout, Alloc>::detach(void)
+{
+    if((m_cow && m_data.use_count() > 1) || m_readonly)
+    {
+        std::shared_ptr<T> own = allocate(m_capacity);
+        std::copy(m_data.get(), m_data.get() + storage_size(), own.get());
+        m_data = std::move(own);
+        m_readonly = false;
+    }
+}
+
+template<typename T, typename Layout, typename Alloc>
+matrix<T, Layout, Alloc>::matrix(size_t r, size_t c)
+: matrix<T, Layout, Alloc>(r * c)
 {
     //std::cout << "\tcalled row, col constructor\n";
     reshape(r, c);
 }
 
 
-template<typename T>
-matrix<T>::matrix(size_t r, size_t c, T const* dat)
-: matrix<T>((r * c), dat)
+template<typename T, typename Layout, typename Alloc>
+matrix<T, Layout, Alloc>::matrix(size_t r, size_t c, T const* dat)
+: matrix<T, Layout, Alloc>(r, c)
 {
     //std::cout << "\tcalled row, col, data constructor\n";
-    reshape(r, c);
+    Layout::by_lines(view()).assign(Layout::by_lines(matrix_view<T const>(dat, r, c, c)));
 }
 
-template<typename T>
-matrix<T>::matrix(matrix<T> const& rhs)
-: matrix<T>(rhs.rows(), rhs.cols())
+template<typename T, typename Layout, typename Alloc>
+matrix<T, Layout, Alloc>::matrix(matrix<T, Layout, Alloc> const& rhs)
+: m_rows(rhs.m_rows), m_cols(rhs.m_cols), m_size(rhs.m_size), m_ld(rhs.m_ld),
+  m_capacity(rhs.m_cow ? rhs.m_capacity : rhs.storage_size()), m_cow(rhs.m_cow),
+  m_readonly(rhs.m_cow && rhs.m_readonly), m_data(rhs.m_cow ? rhs.m_data : allocate(rhs.storage_size()))
 {
     //std::cout << "\tcalled copy constructor\n\n";
-    std::copy(rhs.data(), rhs.data() + m_size, data());
+    if(!m_cow)
+    {
+        std::copy(rhs.data(), rhs.data() + rhs.storage_size(), m_data.get());
+    }
+}
+
+template<typename T, typename Layout, typename Alloc>
+matrix<T, Layout, Alloc>::matrix(matrix_view<T const> const& rhs)
+: matrix<T, Layout, Alloc>(rhs.rows(), rhs.cols())
+{
+    // walk both in this matrix's storage order
+    matrix_view<T> dst = Layout::by_lines(view());
+    matrix_view<T const> src = Layout::by_lines(rhs);
+    
+    T* dst_ptr = data();
+    for(size_t l=0; l < dst.rows(); l++, dst_ptr += m_ld)
+    {
+        T const* src_ptr = src.data() + src.offset(l, 0);
+        if(src.is_contiguous_rows())
+        {
+            std::copy(src_ptr, src_ptr + dst.cols(), dst_ptr);
+            continue;
+        }
+        
+        for(size_t c=0; c < dst.cols(); c++)
+        {
+            dst_ptr[c] = src_ptr[c * src.col_stride()];
+        }
+    }
+}
+
+template<typename T, typename Layout, typename Alloc>
+template<typename E>
+    requires lazy_matrix_expr<E>
+matrix<T, Layout, Alloc>::matrix(E const& expr)
+: matrix<T, Layout, Alloc>(expr.rows(), expr.cols())
+{
+    view().assign(expr);
 }
 
-template<typename T>
-matrix<T>::matrix(std::initializer_list<T> dat)
-: matrix<T>(dat.size())
+template<typename T, typename Layout, typename Alloc>
+matrix<T, Layout, Alloc>::matrix(std::initializer_list<T> dat)
+: matrix<T, Layout, Alloc>(dat.size())
 {
     //std::cout << "\tcalled initializer list constructor\n";
     std::move(dat.begin(), dat.end(), data());
 }
 
-template<typename T>
-matrix<T>::matrix(std::initializer_list<std::initializer_list<T>> dat)
-: matrix<T>(dat.size(), dat.begin()->size())
+template<typename T, typename Layout, typename Alloc>
+matrix<T, Layout, Alloc>::matrix(std::initializer_list<std::initializer_list<T>> dat)
+: matrix<T, Layout, Alloc>(dat.size(), dat.begin()->size())
 {
-    size_t coffs = 0;
+    size_t r = 0;
     for(auto x : dat)
     {
-        std::move(x.begin(), x.end(), data() + coffs);
-        coffs += m_cols;
+        size_t c = 0;
+        for(auto it = x.begin(); it != x.end() && c < m_cols; it++, c++)
+        {
+            get_value(r, c) = std::move(*it);
+        }
+        r++;
     }
 }
 
-template<typename T>
-matrix<T>::matrix(size_t size, std::initializer_list<T> dat)
-: matrix<T>(size)
+template<typename T, typename Layout, typename Alloc>
+matrix<T, Layout, Alloc>::matrix(size_t size, std::initializer_list<T> dat)
+: matrix<T, Layout, Alloc>(size)
 {
     //std::cout << "\tcalled size, initializer list constructor\n";
     std::move(dat.begin(), dat.begin() + std::min(m_size, dat.size()), data());
 }
 
-template<typename T>
-matrix<T>::matrix(size_t r, size_t c, std::initializer_list<T> dat)
-: matrix<T>((r * c), dat)
+template<typename T, typename Layout, typename Alloc>
+matrix<T, Layout, Alloc>::matrix(size_t r, size_t c, std::initializer_list<T> dat)
+: matrix<T, Layout, Alloc>(r, c)
 {
     //std::cout << "\tcalled row, col, initializer list constructor\n";
-    reshape(r, c);
+    size_t n = std::min(m_size, dat.size());
+    for(size_t i=0; i < n; i++)
+    {
+        get_value(i / c, i % c) = std::move(dat.begin()[i]);
+    }
 }
 
-template<typename T>
-matrix<T>::~matrix(void)
+template<typename T, typename Layout, typename Alloc>
+matrix<T, Layout, Alloc>::~matrix(void)
 {
     //std::cout << "\tcalled destroy\n";
     //delete [] m_data;
 }
 
 /*
- template<typename T>
- matrix<T>& matrix<T>::operator=(matrix<T>&& rhs)
- {
-    std::cout << "\tcalled move assignment\n";
-    swap(*this, rhs);
+ * Copies into the existing buffer when it is large enough for rhs's storage
+ * (e.g. same dimensions) and not shared, otherwise allocates like the copy
+ * constructor. Shares rhs's buffer if it is copy-on-write.
+ */
+template<typename T, typename Layout, typename Alloc>
+matrix<T, Layout, Alloc>& matrix<T, Layout, Alloc>::operator=(matrix<T, Layout, Alloc> const& rhs)
+{
+    //std::cout << "\tcalled copy assignment\n";
+    if(this == &rhs)
+    {
+        return *this;
+    }
+    
+    if(!rhs.m_cow && m_data && m_capacity >= rhs.storage_size() && !is_shared() && !m_readonly)
+    {
+        m_rows = rhs.m_rows;
+        m_cols = rhs.m_cols;
+        m_size = rhs.m_size;
+        m_ld = rhs.m_ld;
+        m_cow = false;
+        
+        std::copy(rhs.data(), rhs.data() + rhs.storage_size(), m_data.get());
+        return *this;
+    }
+    
+    matrix<T, Layout, Alloc> tmp(rhs);
+    swap(*this, tmp);
     return *this;
- }*/
+}
 
-template<typename T>
-matrix<T>& matrix<T>::operator=(matrix<T> rhs)
+// rhs is left empty, and our old buffer is released right away
+template<typename T, typename Layout, typename Alloc>
+matrix<T, Layout, Alloc>& matrix<T, Layout, Alloc>::operator=(matrix<T, Layout, Alloc>&& rhs) noexcept
 {
-    //std::cout << "\tcalled copy assignment\n";
-    swap(*this, rhs);
+    //std::cout << "\tcalled move assignment\n";
+    matrix<T, Layout, Alloc> tmp(std::move(rhs));
+    swap(*this, tmp);
     return *this;
 }
 
-template<typename T>
-matrix<T>::matrix(matrix<T>&& rhs) noexcept
-: matrix<T>()
+template<typename T, typename Layout, typename Alloc>
+matrix<T, Layout, Alloc>::matrix(matrix<T, Layout, Alloc>&& rhs) noexcept
+: matrix<T, Layout, Alloc>()
 {
     //std::cout << "\tcalled move constructor\n";
     swap(*this, rhs);
 }
 
-template<typename T>
-inline bool matrix<T>::is_row_vector(void) const
+template<typename T, typename Layout, typename Alloc>
+inline bool matrix<T, Layout, Alloc>::is_row_vector(void) const
 {
     return (m_rows == 1);
 }
 
-template<typename T>
-inline bool matrix<T>::is_col_vector(void) const
+template<typename T, typename Layout, typename Alloc>
+inline bool matrix<T, Layout, Alloc>::is_col_vector(void) const
 {
     return (m_cols == 1);
 }
 
-template<typename T>
-inline bool matrix<T>::is_vector(void) const
+template<typename T, typename Layout, typename Alloc>
+inline bool matrix<T, Layout, Alloc>::is_vector(void) const
 {
     return is_row_vector() || is_col_vector();
 }
 
-template<typename T>
-inline T& matrix<T>::get_value(size_t offs) const
+template<typename T, typename Layout, typename Alloc>
+inline T const& matrix<T, Layout, Alloc>::get_value(size_t offs) const
 {
     return m_data.get()[offs];
 }
 
-template<typename T>
-inline void matrix<T>::set_value(size_t offs, T value)
+template<typename T, typename Layout, typename Alloc>
+inline T& matrix<T, Layout, Alloc>::get_value(size_t offs)
 {
+    detach();
+    return m_data.get()[offs];
+}
+
+template<typename T, typename Layout, typename Alloc>
+inline void matrix<T, Layout, Alloc>::set_value(size_t offs, T value)
+{
+    detach();
     m_data.get()[offs] = value;
 }
 
-template<typename T>
-inline T& matrix<T>::operator[](size_t offs)
+template<typename T, typename Layout, typename Alloc>
+inline T& matrix<T, Layout, Alloc>::operator[](size_t offs)
 {
+    detach();
     return m_data.get()[offs];
 }
 
-template<typename T>
-const T matrix<T>::operator[](size_t offs) const
+template<typename T, typename Layout, typename Alloc>
+const T matrix<T, Layout, Alloc>::operator[](size_t offs) const
 {
 	return m_data.get()[offs];
 }
 
-template<typename T>
-inline size_t matrix<T>::row_offset(size_t m) const
+template<typename T, typename Layout, typename Alloc>
+inline size_t matrix<T, Layout, Alloc>::row_offset(size_t m) const
 {
-    return (m * cols());
+    return offset(m, 0);
 }
 
-template<typename T>
-inline size_t matrix<T>::offset(size_t m, size_t n) const
+template<typename T, typename Layout, typename Alloc>
+inline size_t matrix<T, Layout, Alloc>::offset(size_t m, size_t n) const
 {
-    return (m * cols() + n);
+    return (m * Layout::row_stride(m_ld) + n * Layout::col_stride(m_ld));
 }
 
-template<typename T>
-inline T& matrix<T>::get_value(size_t m, size_t n) const
+template<typename T, typename Layout, typename Alloc>
+inline T const& matrix<T, Layout, Alloc>::get_value(size_t m, size_t n) const
 {
     return get_value(offset(m, n));
 }
 
-template<typename T>
-inline void matrix<T>::set_value(size_t m, size_t n, T value)
+template<typename T, typename Layout, typename Alloc>
+inline T& matrix<T, Layout, Alloc>::get_value(size_t m, size_t n)
+{
+    return get_value(offset(m, n));
+}
+
+template<typename T, typename Layout, typename Alloc>
+inline void matrix<T, Layout, Alloc>::set_value(size_t m, size_t n, T value)
 {
     set_value(offset(m, n), value);
 }
 
-template<typename T>
-inline T& matrix<T>::operator()(size_t m, size_t n)
+template<typename T, typename Layout, typename Alloc>
+inline T& matrix<T, Layout, Alloc>::operator()(size_t m, size_t n)
 {
     return (*this)[offset(m, n)];
 }
 
-template<typename T>
-const T matrix<T>::operator()(size_t m, size_t n) const
+template<typename T, typename Layout, typename Alloc>
+const T matrix<T, Layout, Alloc>::operator()(size_t m, size_t n) const
 {
     return (*this)[offset(m, n)];
 }
 
 
-template<typename T>
-void matrix<T>::fill(T value)
+template<typename T, typename Layout, typename Alloc>
+void matrix<T, Layout, Alloc>::fill(T value)
 {
-    for(size_t k=0; k < m_size; k++)
-    {
-        get_value(k) = value;
-    }
+    detach();
+    for_each_line([value](T* line, size_t n) { simd::fill(line, n, value); });
 }
 
-template<typename T>
-void matrix<T>::zero(void)
+template<typename T, typename Layout, typename Alloc>
+void matrix<T, Layout, Alloc>::zero(void)
 {
     fill(static_cast<T>(0.0));
 }
 
-template<typename T>
-void matrix<T>::ones(void)
+template<typename T, typename Layout, typename Alloc>
+void matrix<T, Layout, Alloc>::ones(void)
 {
     fill(static_cast<T>(1.0));
 }
 
-template<typename T>
-void matrix<T>::rfill(T value, size_t col_bias)
+template<typename T, typename Layout, typename Alloc>
+void matrix<T, Layout, Alloc>::rfill(T value, size_t col_bias)
 {
+    detach();
     for(size_t r=0; r < m_rows; r++)
     {
         for(size_t c = r + col_bias; c < m_cols; c++)
@@ -402,21 +835,22 @@ void matrix<T>::rfill(T value, size_t col_bias)
     }
 }
 
-template<typename T>
-void matrix<T>::fill_upper_triangle(T value)
+template<typename T, typename Layout, typename Alloc>
+void matrix<T, Layout, Alloc>::fill_upper_triangle(T value)
 {
     rfill(static_cast<T>(value), 1);
 }
 
-template<typename T>
-void matrix<T>::fill_upper_hessenberg(T value)
+template<typename T, typename Layout, typename Alloc>
+void matrix<T, Layout, Alloc>::fill_upper_hessenberg(T value)
 {
     rfill(static_cast<T>(value), 2);
 }
 
-template<typename T>
-void matrix<T>::cfill(T value, size_t row_bias)
+template<typename T, typename Layout, typename Alloc>
+void matrix<T, Layout, Alloc>::cfill(T value, size_t row_bias)
 {
+    detach();
     for(size_t c = 0; c < m_cols; c++)
     {
         for(size_t r = c + row_bias; r < m_rows; r++)
@@ -426,21 +860,22 @@ void matrix<T>::cfill(T value, size_t row_bias)
     }
 }
 
-template<typename T>
-void matrix<T>::fill_lower_triangle(T value)
+template<typename T, typename Layout, typename Alloc>
+void matrix<T, Layout, Alloc>::fill_lower_triangle(T value)
 {
     cfill(static_cast<T>(value), 1);
 }
 
-template<typename T>
-void matrix<T>::fill_lower_hessenberg(T value)
+template<typename T, typename Layout, typename Alloc>
+void matrix<T, Layout, Alloc>::fill_lower_hessenberg(T value)
 {
     cfill(static_cast<T>(value), 2);
 }
 
-template<typename T>
-void matrix<T>::set_identity(void)
+template<typename T, typename Layout, typename Alloc>
+void matrix<T, Layout, Alloc>::set_identity(void)
 {
+    detach();
     for(size_t r=0; r < m_rows; r++)
     {
         for(size_t c=0; c < m_cols; c++)
@@ -451,18 +886,33 @@ void matrix<T>::set_identity(void)
     }
 }
 
-// TODO: conditional exit function, maybe when iterators are worked out.
-template<typename T>
-bool matrix<T>::content_equals(matrix<T> const& rhs) const
+template<typename T, typename Layout, typename Alloc>
+bool matrix<T, Layout, Alloc>::content_equals(matrix<T, Layout, Alloc> const& rhs) const
 {
     if(m_size != rhs.size())
     {
         return false;
     }
     
-    for(size_t i=0; i < m_size; i++)
+    if(!m_size)
+    {
+        return true;
+    }
+    
+    if(is_packed() && rhs.is_packed())
+    {
+        return simd::equal(data(), rhs.data(), m_size);
+    }
+    
+    if(m_rows != rhs.rows())
     {
-        if(get_value(i) != rhs.get_value(i))
+        return false;
+    }
+    
+    size_t len = Layout::line_size(m_rows, m_cols);
+    for(size_t l=0; l < Layout::lines(m_rows, m_cols); l++)
+    {
+        if(!simd::equal(data() + l * m_ld, rhs.data() + l * rhs.stride(), len))
         {
             return false;
         }
@@ -470,14 +920,14 @@ bool matrix<T>::content_equals(matrix<T> const& rhs) const
     return true;
 }
 
-template<typename T>
-bool matrix<T>::equals(matrix<T> const& rhs) const
+template<typename T, typename Layout, typename Alloc>
+bool matrix<T, Layout, Alloc>::equals(matrix<T, Layout, Alloc> const& rhs) const
 {
     return (m_rows != rhs.rows() || m_cols != rhs.cols()) ? false : content_equals(rhs);
 }
 
-template<typename T>
-bool matrix<T>::is_symmetric(void) const
+template<typename T, typename Layout, typename Alloc>
+bool matrix<T, Layout, Alloc>::is_symmetric(void) const
 {
     if(!is_square())
     {
@@ -497,76 +947,76 @@ bool matrix<T>::is_symmetric(void) const
     return true;
 }
 
-template<typename T>
-matrix<T> matrix<T>::row(size_t r) const 
+template<typename T, typename Layout, typename Alloc>
+matrix<T, Layout, Alloc> matrix<T, Layout, Alloc>::row(size_t r) const 
 {
     if(r >= m_rows)
     {
         throw std::range_error("row: row index is out of range.");
     }
 
-    return matrix<T>(1, m_cols, data() + row_offset(r));
+    return matrix<T, Layout, Alloc>(row_view(r));
 }
 
-template<typename T>
-matrix<T>& matrix<T>::set_row(matrix<T> const& rvec, size_t r)
+template<typename T, typename Layout, typename Alloc>
+matrix<T, Layout, Alloc>& matrix<T, Layout, Alloc>::set_row(matrix<T, Layout, Alloc> const& rvec, size_t r)
 {
     if(r >= m_rows)
     {
         throw std::range_error("set_row: row index is out of range.");
     }
 
-    std::copy(rvec.data(), rvec.data() + rvec.cols(), data());
+    matrix_view<T> dst = row_view(r);
+    for(size_t c=0; c < std::min(rvec.size(), m_cols); c++)
+    {
+        dst[c] = rvec[c];
+    }
     return *this;
 }
 
-template<typename T>
-matrix<T> matrix<T>::col(size_t c) const
+template<typename T, typename Layout, typename Alloc>
+matrix<T, Layout, Alloc> matrix<T, Layout, Alloc>::col(size_t c) const
 {
     if(c >= m_cols)
     {
         throw std::range_error("col: column index is out of range.");
     }
 
-    matrix<T> cvec(m_rows, 1);
-    for(size_t r=0; r < m_rows; r++)
-    {
-        cvec.set_value(r, 0, get_value(r, c));
-    }
-
-    return cvec;
+    return matrix<T, Layout, Alloc>(col_view(c));
 }
 
-template<typename T>
-matrix<T>& matrix<T>::set_col(matrix<T> const& cvec, size_t c)
+template<typename T, typename Layout, typename Alloc>
+matrix<T, Layout, Alloc>& matrix<T, Layout, Alloc>::set_col(matrix<T, Layout, Alloc> const& cvec, size_t c)
 {
     if(c >= m_cols)
     {
         throw std::range_error("set_col: column index is out of range.");
     }
 
+    matrix_view<T> dst = col_view(c);
     for(size_t r=0; r < m_rows; r++)
     {
-        set_value(r, c, cvec.get_value(r, 0));
+        dst[r] = cvec[r];
     }
 
     return *this;
 }
 
-template<typename T>
-matrix<T>& matrix<T>::swap_rows(size_t r1, size_t r2)
+template<typename T, typename Layout, typename Alloc>
+matrix<T, Layout, Alloc>& matrix<T, Layout, Alloc>::swap_rows(size_t r1, size_t r2)
 {
     if(r1 >= m_rows || r2 >= m_rows)
     {
         throw std::range_error("swap_rows: row index out of range.");
     }
 
-    size_t i1 = row_offset(r1);
-    size_t i2 = row_offset(r2);
-    size_t i=0;
+    size_t i1, i2, c;
 
-    for(; i < m_cols; i1++, i2++, i++)
+    for(c=0; c < m_cols; c++)
     {
+        i1 = offset(r1, c);
+        i2 = offset(r2, c);
+        
         T tmp = get_value(i1);
         set_value(i1, get_value(i2));
         set_value(i2, tmp);
@@ -575,8 +1025,8 @@ matrix<T>& matrix<T>::swap_rows(size_t r1, size_t r2)
     return *this;
 }
 
-template<typename T>
-matrix<T>& matrix<T>::swap_cols(size_t c1, size_t c2)
+template<typename T, typename Layout, typename Alloc>
+matrix<T, Layout, Alloc>& matrix<T, Layout, Alloc>::swap_cols(size_t c1, size_t c2)
 {
     if(c1 >= m_cols || c2 >= m_cols)
     {
@@ -601,81 +1051,252 @@ matrix<T>& matrix<T>::swap_cols(size_t c1, size_t c2)
     return *this;
 }
 
-template<typename T>
-matrix<T>& matrix<T>::sub_rows(size_t r1, size_t r2, T factor)
+template<typename T, typename Layout, typename Alloc>
+matrix<T, Layout, Alloc>& matrix<T, Layout, Alloc>::sub_rows(size_t r1, size_t r2, T factor)
 {
     if(r1 >= m_rows || r2 >= m_rows)
     {
         throw std::range_error("sub_rows: row index is out of range.");
     }
+    
+    detach();
 
-    size_t i1 = row_offset(r1);
-    size_t i2 = row_offset(r2);
-    size_t i=0;
-
-    for(; i < m_cols; i1++, i2++, i++)
+    for(size_t c=0; c < m_cols; c++)
     {
-        set_value(i1, get_value(i1) - factor * get_value(i2));
+        get_value(r1, c) -= factor * get_value(r2, c);
     }
 
     return *this;
 }
 
-// TODO: once realloc is implemented, we can be more space efficient by rellocing an extra row/column for permute rows/cols instead of creating an entirely new matrix
-template<typename T>
-matrix<T>& matrix<T>::permute_rows(matrix<size_t> const& rpermute)
+/*
+ * Both permute in place with a single line of scratch. When the permuted
+ * dimension runs across storage lines (rows of a row-major matrix), whole
+ * lines are moved along the cycles of the permutation. Otherwise each line
+ * is permuted through the scratch line in turn, so the matrix is still read
+ * and written once, in storage order.
+ *
+ * permute_rows gathers (row r becomes row rpermute(r)), permute_cols
+ * scatters (column c goes to cpermute(c)), as pivoting produces them.
+ */
+template<typename T, typename Layout, typename Alloc>
+matrix<T, Layout, Alloc>& matrix<T, Layout, Alloc>::permute_rows(matrix<size_t> const& rpermute)
 {
     if(rpermute.rows() != m_rows)
     {
         throw std::range_error("permute_rows: incorrect row dimensions.");
     }
-
-    matrix<T> to(*this);
-    for(size_t r=0; r < rpermute.rows(); r++)
+    
+    check_permutation(rpermute, "permute_rows: not a permutation.");
+    if(!m_size)
     {
-        to.set_row(row(rpermute.get_value(r, 0)), r);
+        return *this;
     }
-
-    // TODO: hmmm
-    *this = std::move(to);
+    
+    detach();
+    
+    if constexpr(std::is_same_v<Layout, layout_right>)
+    {
+        permute_lines(rpermute, true);
+    }
+    else
+    {
+        permute_within_lines(rpermute, true);
+    }
+    
     return *this;
 }
 
-template<typename T>
-matrix<T>& matrix<T>::permute_cols(matrix<size_t> const& cpermute)
+template<typename T, typename Layout, typename Alloc>
+matrix<T, Layout, Alloc>& matrix<T, Layout, Alloc>::permute_cols(matrix<size_t> const& cpermute)
 {
     if(cpermute.rows() != m_cols)
     {
         throw std::range_error("permute_cols: incorrect column dimensions.");
     }
     
-    matrix<T> to(*this);
-    for(size_t c = 0; c < m_cols; c++)
+    check_permutation(cpermute, "permute_cols: not a permutation.");
+    if(!m_size)
+    {
+        return *this;
+    }
+    
+    detach();
+    
+    if constexpr(std::is_same_v<Layout, layout_left>)
     {
-        to.set_col(col(c), cpermute.get_value(c, 0));
+        permute_lines(cpermute, false);
+    }
+    else
+    {
+        permute_within_lines(cpermute, false);
     }
     
-    *this = std::move(to);
     return *this;
 }
 
-template<typename T>
-matrix<T> matrix<T>::transpose(void) const
+template<typename T, typename Layout, typename Alloc>
+void matrix<T, Layout, Alloc>::check_permutation(matrix<size_t> const& p, char const* what)
 {
-    matrix<T> tm(m_cols, m_rows);
-    for(size_t r=0; r < m_rows; r++)
+    std::vector<bool> seen(p.rows(), false);
+    for(size_t i=0; i < p.rows(); i++)
     {
-        for(size_t c=0; c < m_cols; c++)
+        size_t k = p.get_value(i, 0);
+        if(k >= p.rows() || seen[k])
         {
-            tm.get_value(c, r) = get_value(r, c);
+            throw std::range_error(what);
         }
+        seen[k] = true;
+    }
+}
+
+template<typename T, typename Layout, typename Alloc>
+void matrix<T, Layout, Alloc>::permute_lines(matrix<size_t> const& p, bool gather)
+{
+    size_t n = p.rows();
+    size_t len = Layout::line_size(m_rows, m_cols);
+    T* dat = m_data.get();
+    
+    auto line = [&](size_t k) { return dat + k * m_ld; };
+    
+    matrix<T, layout_right, Alloc> scratch(1, len);
+    T* tmp = scratch.data();
+    
+    std::vector<bool> done(n, false);
+    for(size_t s=0; s < n; s++)
+    {
+        if(done[s] || p.get_value(s, 0) == s)
+        {
+            continue;
+        }
+        
+        std::copy(line(s), line(s) + len, tmp);
+        
+        if(gather)
+        {
+            // s <- p(s) <- p(p(s)) <- ... <- tmp
+            size_t j = s;
+            for(size_t k = p.get_value(j, 0); k != s; j = k, k = p.get_value(k, 0))
+            {
+                std::copy(line(k), line(k) + len, line(j));
+                done[k] = true;
+            }
+            std::copy(tmp, tmp + len, line(j));
+        }
+        else
+        {
+            // carry each displaced line on to where it goes
+            for(size_t k = p.get_value(s, 0); k != s; k = p.get_value(k, 0))
+            {
+                std::swap_ranges(tmp, tmp + len, line(k));
+                done[k] = true;
+            }
+            std::copy(tmp, tmp + len, line(s));
+        }
+        done[s] = true;
+    }
+}
+
+template<typename T, typename Layout, typename Alloc>
+void matrix<T, Layout, Alloc>::permute_within_lines(matrix<size_t> const& p, bool gather)
+{
+    size_t n = p.rows();
+    size_t lines = Layout::lines(m_rows, m_cols);
+    
+    // indices once up front, the per element loops below then only touch two lines
+    std::vector<size_t> idx(n);
+    for(size_t i=0; i < n; i++)
+    {
+        idx[i] = p.get_value(i, 0);
+    }
+    
+    matrix<T, layout_right, Alloc> scratch(1, n);
+    T* tmp = scratch.data();
+    
+    for(size_t l=0; l < lines; l++)
+    {
+        T* line = m_data.get() + l * m_ld;
+        
+        if(gather)
+        {
+            for(size_t i=0; i < n; i++)
+            {
+                tmp[i] = line[idx[i]];
+            }
+        }
+        else
+        {
+            for(size_t i=0; i < n; i++)
+            {
+                tmp[idx[i]] = line[i];
+            }
+        }
+        std::copy(tmp, tmp + n, line);
+    }
+}
+
+/*
+ * Blocked, see transpose.h. The lines of the result are the columns of the
+ * storage, in either layout, so the kernels only see lines and strides.
+ */
+template<typename T, typename Layout, typename Alloc>
+matrix<T, Layout, Alloc> matrix<T, Layout, Alloc>::transpose(void) const
+{
+    matrix<T, Layout, Alloc> tm(m_cols, m_rows);
+    if(m_size)
+    {
+        transpose_block(m_data.get(), m_ld, tm.m_data.get(), tm.m_ld, Layout::lines(m_rows, m_cols), Layout::line_size(m_rows, m_cols));
+    }
+
+    return tm;
+}
+
+template<typename T, typename Layout, typename Alloc>
+matrix<T, Layout, Alloc> matrix<T, Layout, Alloc>::transpose(tdpool& pool) const
+{
+    matrix<T, Layout, Alloc> tm(m_cols, m_rows);
+    if(m_size)
+    {
+        transpose_block(m_data.get(), m_ld, tm.m_data.get(), tm.m_ld, Layout::lines(m_rows, m_cols), Layout::line_size(m_rows, m_cols), pool);
     }
 
     return tm;
 }
 
-template<typename T>
-matrix<T> matrix<T>::diag(void) const
+/*
+ * Square matrices swap tiles in place and keep their stride. Otherwise the
+ * shape of the storage changes, so this is transpose() into a new buffer.
+ */
+template<typename T, typename Layout, typename Alloc>
+matrix<T, Layout, Alloc>& matrix<T, Layout, Alloc>::transpose_in_place(void)
+{
+    if(!is_square())
+    {
+        *this = transpose();
+        return *this;
+    }
+
+    detach();
+    transpose_square(m_data.get(), m_ld, m_rows);
+    return *this;
+}
+
+template<typename T, typename Layout, typename Alloc>
+matrix<T, Layout, Alloc>& matrix<T, Layout, Alloc>::transpose_in_place(tdpool& pool)
+{
+    if(!is_square())
+    {
+        *this = transpose(pool);
+        return *this;
+    }
+
+    detach();
+    transpose_square(m_data.get(), m_ld, m_rows, pool);
+    return *this;
+}
+
+template<typename T, typename Layout, typename Alloc>
+matrix<T, Layout, Alloc> matrix<T, Layout, Alloc>::diag(void) const
 {
     bool sel = false;
     size_t i, end_cond;
@@ -694,7 +1315,7 @@ matrix<T> matrix<T>::diag(void) const
         throw std::range_error("matrix is not a row or column vector.");
     }
 
-    matrix<T> dm(end_cond, end_cond);
+    matrix<T, Layout, Alloc> dm(end_cond, end_cond);
     for(i = 0; i < end_cond; i++)
     {
         dm.get_value(i, i) = get_value(!sel * i, sel * i);
@@ -703,8 +1324,8 @@ matrix<T> matrix<T>::diag(void) const
     return dm;
 }
 
-template<typename T>
-std::pair<matrix<T>, matrix<T>> matrix<T>::split_rows(size_t at_row) const
+template<typename T, typename Layout, typename Alloc>
+std::pair<matrix<T, Layout, Alloc>, matrix<T, Layout, Alloc>> matrix<T, Layout, Alloc>::split_rows(size_t at_row) const
 {
     if(at_row >= m_rows)
     {
@@ -713,121 +1334,197 @@ std::pair<matrix<T>, matrix<T>> matrix<T>::split_rows(size_t at_row) const
 
     return std::make_pair
     (
-        matrix<T>(at_row + 1, m_cols, data() + row_offset(0)),
-        matrix<T>(m_rows - at_row - 1, m_cols, data() + offset(at_row, m_cols))
+        sub_matrix(0, at_row + 1, 0, m_cols),
+        sub_matrix(at_row + 1, m_rows - at_row - 1, 0, m_cols)
     );
 }
 
-template<typename T>
-std::pair<matrix<T>, matrix<T>> matrix<T>::split_cols(size_t at_col) const
+template<typename T, typename Layout, typename Alloc>
+std::pair<matrix<T, Layout, Alloc>, matrix<T, Layout, Alloc>> matrix<T, Layout, Alloc>::split_cols(size_t at_col) const
 {
     if(at_col >= m_cols)
     {
         throw std::range_error("split_cols: column index is out of range.");
     }
 
-    matrix<T> left(m_rows, at_col + 1);
-    matrix<T> right(m_rows, m_cols - at_col - 1);
-
-    size_t il, ir, r, c;
-    il = ir = r = c = 0;
-
-    for(; r < m_rows; r++)
-    {
-        c = 0;
-        for(; c < m_cols; c++)
-        {
-            T value = get_value(r, c);
-            if(c <= at_col)
-            {
-                left[il++] = value;
-            }
-            else right[ir++] = value;
-        }
-    }
-
-    return std::make_pair(left, right);
+    return std::make_pair
+    (
+        sub_matrix(0, m_rows, 0, at_col + 1),
+        sub_matrix(0, m_rows, at_col + 1, m_cols - at_col - 1)
+    );
 }
 
-template<typename T>
-matrix<T> matrix<T>::sub_matrix(size_t start_row, size_t nrows, size_t start_col, size_t ncols) const
+template<typename T, typename Layout, typename Alloc>
+matrix<T, Layout, Alloc> matrix<T, Layout, Alloc>::sub_matrix(size_t start_row, size_t nrows, size_t start_col, size_t ncols) const
 {
-    if(start_row + nrows > m_rows || start_col + ncols > m_cols)
-    {
-        throw std::range_error("sub_matrix: incompatible dimensions for submatrix.");
-    }
-
-    matrix<T> sub(nrows, ncols);
-    
-    T* dst_ptr = sub.data();
-    T* src_ptr = data() + offset(start_row, start_col);
-
-    for(size_t r=0; r < nrows; r++, src_ptr += m_cols, dst_ptr += ncols)
-    {
-        std::copy(src_ptr, src_ptr + ncols, dst_ptr);
-    }
-
-    return sub;
+    return matrix<T, Layout, Alloc>(sub_view(start_row, nrows, start_col, ncols));
 }
 
- template<typename T>
- matrix<T> matrix<T>::sub_matrix(size_t start_row, size_t start_col) const
+ template<typename T, typename Layout, typename Alloc>
+ matrix<T, Layout, Alloc> matrix<T, Layout, Alloc>::sub_matrix(size_t start_row, size_t start_col) const
  {
     return sub_matrix(start_row, m_rows - start_row, start_col, m_cols - start_col);
  }
 
-// TODO: subview object
-template<typename T>
-matrix<T>& matrix<T>::set_sub_matrix(matrix<T> const& sub, size_t start_row, size_t start_col)
+template<typename T, typename Layout, typename Alloc>
+matrix<T, Layout, Alloc>& matrix<T, Layout, Alloc>::set_sub_matrix(matrix<T, Layout, Alloc> const& sub, size_t start_row, size_t start_col)
 {
     if(start_row + sub.rows() > m_rows || start_col + sub.cols() > m_cols)
     {
         throw std::range_error("set_sub_matrix: incompatible dimensions for submatrix.");
     }
 
-    for(size_t r=0; r < sub.rows(); r++)
-    {
-        for(size_t c=0; c < sub.cols(); c++)
-        {
-            get_value(r + start_row, c + start_col) = sub.get_value(r, c);
-        }
-    }
-
+    sub_view(start_row, sub.rows(), start_col, sub.cols()).assign(sub);
     return *this;
 }
 
-template<typename T>
-matrix<T> matrix<T>::sub_col(size_t start_row, size_t nrows, size_t c) const 
+template<typename T, typename Layout, typename Alloc>
+matrix<T, Layout, Alloc> matrix<T, Layout, Alloc>::sub_col(size_t start_row, size_t nrows, size_t c) const 
 {
     return sub_matrix(start_row, nrows, c, 1);
 }
 
-template<typename T>
-matrix<T>& matrix<T>::set_sub_col(matrix<T> const& sub, size_t start_row, size_t c)
+template<typename T, typename Layout, typename Alloc>
+matrix<T, Layout, Alloc>& matrix<T, Layout, Alloc>::set_sub_col(matrix<T, Layout, Alloc> const& sub, size_t start_row, size_t c)
 {
     return set_sub_matrix(sub, start_row, c);
 }
 
-template<typename T>
-matrix<T> matrix<T>::sub_row(size_t r, size_t start_col, size_t ncols) const
+template<typename T, typename Layout, typename Alloc>
+matrix<T, Layout, Alloc> matrix<T, Layout, Alloc>::sub_row(size_t r, size_t start_col, size_t ncols) const
 {
     return sub_matrix(r, 1, start_col, ncols);
 }
 
-template<typename T>
-matrix<T>& matrix<T>::set_sub_row(matrix<T> const& sub, size_t r, size_t start_col)
+template<typename T, typename Layout, typename Alloc>
+matrix<T, Layout, Alloc>& matrix<T, Layout, Alloc>::set_sub_row(matrix<T, Layout, Alloc> const& sub, size_t r, size_t start_col)
 {
     return set_sub_matrix(sub, r, start_col);
 }
 
-template<typename T>
-template<typename R>
-matrix<T>& matrix<T>::operator+=(const matrix<R>& rhs)
+template<typename T, typename Layout, typename Alloc>
+template<typename U>
+inline matrix_view<U> matrix<T, Layout, Alloc>::storage_view(U* dat) const
+{
+    return matrix_view<U>
+    (
+        dat, m_rows, m_cols,
+        static_cast<ptrdiff_t>(Layout::row_stride(m_ld)),
+        static_cast<ptrdiff_t>(Layout::col_stride(m_ld))
+    );
+}
+
+template<typename T, typename Layout, typename Alloc>
+inline matrix_view<T const> matrix<T, Layout, Alloc>::view(void) const
+{
+    return storage_view(data());
+}
+
+template<typename T, typename Layout, typename Alloc>
+inline matrix_view<T> matrix<T, Layout, Alloc>::view(void)
+{
+    return storage_view(data());
+}
+
+template<typename T, typename Layout, typename Alloc>
+template<typename F>
+inline void matrix<T, Layout, Alloc>::for_each_line(F&& f) const
+{
+    if(!m_size)
+    {
+        return;
+    }
+    
+    if(is_packed())
+    {
+        f(m_data.get(), m_size);
+        return;
+    }
+    
+    size_t len = Layout::line_size(m_rows, m_cols);
+    for(size_t l=0; l < Layout::lines(m_rows, m_cols); l++)
+    {
+        f(m_data.get() + l * m_ld, len);
+    }
+}
+
+template<typename T, typename Layout, typename Alloc>
+inline matrix_view<T const> matrix<T, Layout, Alloc>::row_view(size_t r) const
+{
+    return view().row(r);
+}
+
+template<typename T, typename Layout, typename Alloc>
+inline matrix_view<T const> matrix<T, Layout, Alloc>::col_view(size_t c) const
+{
+    return view().col(c);
+}
+
+template<typename T, typename Layout, typename Alloc>
+inline matrix_view<T const> matrix<T, Layout, Alloc>::diag_view(void) const
+{
+    return view().diag();
+}
+
+template<typename T, typename Layout, typename Alloc>
+inline matrix_view<T const> matrix<T, Layout, Alloc>::sub_view(size_t start_row, size_t nrows, size_t start_col, size_t ncols) const
+{
+    return view().sub_matrix(start_row, nrows, start_col, ncols);
+}
+
+template<typename T, typename Layout, typename Alloc>
+inline matrix_view<T const> matrix<T, Layout, Alloc>::sub_view(size_t start_row, size_t start_col) const
+{
+    return view().sub_matrix(start_row, start_col);
+}
+
+template<typename T, typename Layout, typename Alloc>
+inline matrix_view<T const> matrix<T, Layout, Alloc>::sub_col_view(size_t start_row, size_t nrows, size_t c) const
+{
+    return view().sub_col(start_row, nrows, c);
+}
+
+template<typename T, typename Layout, typename Alloc>
+inline matrix_view<T const> matrix<T, Layout, Alloc>::sub_row_view(size_t r, size_t start_col, size_t ncols) const
+{
+    return view().sub_row(r, start_col, ncols);
+}
+
+template<typename T, typename Layout, typename Alloc>
+template<typename R, typename RLayout, typename RAlloc>
+matrix<T, Layout, Alloc>& matrix<T, Layout, Alloc>::operator+=(const matrix<R, RLayout, RAlloc>& rhs)
 {
     if(m_size != rhs.size())
     {
         throw std::range_error("operator+=: sizes must be equal.");
     }
+    
+    detach();
+
+    if constexpr(std::is_same_v<T, R> && std::is_same_v<Layout, RLayout>)
+    {
+        if(is_packed() && rhs.is_packed())
+        {
+            simd::add(m_data.get(), rhs.data(), m_size);
+            return *this;
+        }
+        
+        if(m_size && m_rows == rhs.rows())
+        {
+            size_t len = Layout::line_size(m_rows, m_cols);
+            for(size_t l=0; l < Layout::lines(m_rows, m_cols); l++)
+            {
+                simd::add(m_data.get() + l * m_ld, rhs.data() + l * rhs.stride(), len);
+            }
+            return *this;
+        }
+    }
+
+    if(!std::is_same_v<Layout, RLayout> || !is_packed() || !rhs.is_packed())
+    {
+        view() += rhs;
+        return *this;
+    }
 
     for(size_t i=0; i < m_size; i++)
     {
@@ -837,14 +1534,41 @@ matrix<T>& matrix<T>::operator+=(const matrix<R>& rhs)
     return *this;
 }
 
-template<typename T>
-template<typename R>
-matrix<T>& matrix<T>::operator-=(const matrix<R>& rhs)
+template<typename T, typename Layout, typename Alloc>
+template<typename R, typename RLayout, typename RAlloc>
+matrix<T, Layout, Alloc>& matrix<T, Layout, Alloc>::operator-=(const matrix<R, RLayout, RAlloc>& rhs)
 {
     if(m_size != rhs.size())
     {
         throw std::range_error("operator-=: sizes must be equal.");
     }
+    
+    detach();
+
+    if constexpr(std::is_same_v<T, R> && std::is_same_v<Layout, RLayout>)
+    {
+        if(is_packed() && rhs.is_packed())
+        {
+            simd::sub(m_data.get(), rhs.data(), m_size);
+            return *this;
+        }
+        
+        if(m_size && m_rows == rhs.rows())
+        {
+            size_t len = Layout::line_size(m_rows, m_cols);
+            for(size_t l=0; l < Layout::lines(m_rows, m_cols); l++)
+            {
+                simd::sub(m_data.get() + l * m_ld, rhs.data() + l * rhs.stride(), len);
+            }
+            return *this;
+        }
+    }
+
+    if(!std::is_same_v<Layout, RLayout> || !is_packed() || !rhs.is_packed())
+    {
+        view() -= rhs;
+        return *this;
+    }
 
     for(size_t i=0; i < m_size; i++)
     {
@@ -855,30 +1579,180 @@ matrix<T>& matrix<T>::operator-=(const matrix<R>& rhs)
 }
 
 
-template<typename T>
+template<typename T, typename Layout, typename Alloc>
+template<typename E>
+    requires lazy_matrix_expr<E>
+matrix<T, Layout, Alloc>& matrix<T, Layout, Alloc>::operator+=(E const& expr)
+{
+    view() += expr;
+    return *this;
+}
+
+template<typename T, typename Layout, typename Alloc>
+template<typename E>
+    requires lazy_matrix_expr<E>
+matrix<T, Layout, Alloc>& matrix<T, Layout, Alloc>::operator-=(E const& expr)
+{
+    view() -= expr;
+    return *this;
+}
+
+template<typename T, typename Layout, typename Alloc>
 template<typename R>
-matrix<T>& matrix<T>::operator*=(R scalar)
+matrix<T, Layout, Alloc>& matrix<T, Layout, Alloc>::operator*=(R scalar)
 {
-    for(size_t i=0; i < m_size; i++)
+    detach();
+    
+    T factor = static_cast<T>(scalar);
+    for_each_line([factor](T* line, size_t n) { simd::scale(line, n, factor); });
+    return *this;
+}
+
+/*
+ * Uninitialized (zeroed) nrows x ncols matrix whose lines start ld elements apart.
+ */
+template<typename T, typename Layout, typename Alloc>
+matrix<T, Layout, Alloc> matrix<T, Layout, Alloc>::with_stride(size_t nrows, size_t ncols, size_t ld)
+{
+    if(ld < Layout::line_size(nrows, ncols))
     {
-        get_value(i) *= static_cast<T>(scalar);
+        throw std::range_error("with_stride: leading dimension must be at least the line size.");
     }
     
-    return *this;
+    matrix<T, Layout, Alloc> res(Layout::lines(nrows, ncols) * ld);
+    res.m_rows = nrows;
+    res.m_cols = ncols;
+    res.m_size = nrows * ncols;
+    res.m_ld = ld;
+    
+    return res;
+}
+
+/*
+ * Pads lines of n elements out to a whole number of cache lines, so that every
+ * line start has the allocator's alignment. Lines which are a large power of two
+ * bytes long get one more cache line, since otherwise every line start maps to
+ * the same cache sets and walks across lines thrash them.
+ */
+template<typename T, typename Layout, typename Alloc>
+size_t matrix<T, Layout, Alloc>::padded_stride(size_t n)
+{
+    constexpr size_t line_bytes = 64;
+    constexpr size_t line = (line_bytes % sizeof(T) == 0) ? line_bytes / sizeof(T) : 1;
+    
+    size_t ld = ((n + line - 1) / line) * line;
+    size_t ld_bytes = ld * sizeof(T);
+    
+    if(ld_bytes >= 8 * line_bytes && (ld_bytes & (ld_bytes - 1)) == 0)
+    {
+        ld += line;
+    }
+    
+    return ld;
+}
+
+template<typename T, typename Layout, typename Alloc>
+matrix<T, Layout, Alloc> matrix<T, Layout, Alloc>::padded(size_t nrows, size_t ncols)
+{
+    return with_stride(nrows, ncols, padded_stride(Layout::line_size(nrows, ncols)));
+}
+
+/*
+ * Writes storage as it is, padding and layout included, so load() needs a
+ * single allocation and mapped() can use the file's data in place. Streams
+ * chunk_lines lines at a time (0 picks them), with a checksum per chunk if
+ * asked. See matrix_file.h for the format.
+ */
+template<typename T, typename Layout, typename Alloc>
+void matrix<T, Layout, Alloc>::save(std::string const& path, bool checksum, size_t chunk_lines) const
+{
+    uint16_t layout = std::is_same_v<Layout, layout_left> ? matrix_file::col_major : matrix_file::row_major;
+
+    matrix_file::header h = matrix_file::make_header(matrix_file::dtype_of<T>(), sizeof(T), layout,
+                                                     m_size ? m_rows : 0, m_size ? m_cols : 0, m_ld, checksum, chunk_lines);
+    matrix_file::write(path, h, m_data.get());
+}
+
+/*
+ * Reads a file written by save() of the same element type and layout into
+ * a matrix of the stride it was saved with, verifying checksums if the file
+ * has them.
+ */
+template<typename T, typename Layout, typename Alloc>
+matrix<T, Layout, Alloc> matrix<T, Layout, Alloc>::load(std::string const& path)
+{
+    uint16_t layout = std::is_same_v<Layout, layout_left> ? matrix_file::col_major : matrix_file::row_major;
+
+    matrix_file::header h;
+    std::ifstream in = matrix_file::open(path, h, matrix_file::dtype_of<T>(), layout);
+
+    if(!h.rows || !h.cols)
+    {
+        return matrix<T, Layout, Alloc>();
+    }
+
+    if(h.ld < Layout::line_size(h.rows, h.cols))
+    {
+        throw std::runtime_error("load: " + path + " has inconsistent dimensions.");
+    }
+
+    matrix<T, Layout, Alloc> res = with_stride(h.rows, h.cols, h.ld);
+    matrix_file::read(in, h, res.m_data.get(), path);
+
+    return res;
+}
+
+/*
+ * Maps a file written by save() of the same element type and layout, see
+ * the top of this file for the two modes. The mapping is unmapped when the
+ * last matrix using it goes away.
+ */
+template<typename T, typename Layout, typename Alloc>
+matrix<T, Layout, Alloc> matrix<T, Layout, Alloc>::mapped(std::string const& path, matrix_file::map_mode mode)
+{
+    uint16_t layout = std::is_same_v<Layout, layout_left> ? matrix_file::col_major : matrix_file::row_major;
+
+    matrix_file::mapping map = matrix_file::map(path, mode);
+    matrix_file::header const& h = map.head();
+    matrix_file::check_header(h, matrix_file::dtype_of<T>(), layout, map.size, path);
+
+    matrix<T, Layout, Alloc> res;
+    if(!h.rows || !h.cols)
+    {
+        return res;
+    }
+
+    if(h.ld < Layout::line_size(h.rows, h.cols))
+    {
+        throw std::runtime_error("mapped: " + path + " has inconsistent dimensions.");
+    }
+
+    res.m_rows = h.rows;
+    res.m_cols = h.cols;
+    res.m_size = h.rows * h.cols;
+    res.m_ld = h.ld;
+    res.m_capacity = matrix_file::lines(h) * h.ld;
+    res.m_cow = (mode == matrix_file::map_mode::read_only);
+    res.m_readonly = (mode == matrix_file::map_mode::read_only);
+
+    // shares ownership of the whole mapping, pointing at its data
+    res.m_data = std::shared_ptr<T>(map.base, static_cast<T*>(map.data()));
+
+    return res;
 }
 
-template<typename T>
-matrix<T> matrix<T>::eye(size_t rank)
+template<typename T, typename Layout, typename Alloc>
+matrix<T, Layout, Alloc> matrix<T, Layout, Alloc>::eye(size_t rank)
 {
-    matrix<T> I(rank, rank);
+    matrix<T, Layout, Alloc> I(rank, rank);
     I.set_identity();
     return I;
 }
 
-template<typename T>
-matrix<T> matrix<T>::ones(size_t nrows, size_t ncols)
+template<typename T, typename Layout, typename Alloc>
+matrix<T, Layout, Alloc> matrix<T, Layout, Alloc>::ones(size_t nrows, size_t ncols)
 {
-	matrix<T> I(nrows, ncols);
+	matrix<T, Layout, Alloc> I(nrows, ncols);
 	I.ones();
 	return I;
 }
@@ -895,42 +1769,46 @@ matrix<size_t> matrix<size_t>::unit_permutation_matrix(size_t rank)
     return perm;
 }
 
-template<typename T>
-matrix<T> matrix<T>::random_dense_matrix(size_t nrows, size_t ncols, float lowerbound, float upperbound)
+template<typename T, typename Layout, typename Alloc>
+matrix<T, Layout, Alloc> matrix<T, Layout, Alloc>::random_dense_matrix(size_t nrows, size_t ncols, float lowerbound, float upperbound)
 {
-    matrix<T> rmat(nrows, ncols);
+    matrix<T, Layout, Alloc> rmat(nrows, ncols);
+
+    // one seed per process, each call draws from a stream of its own
+    static uint64_t const seed = (static_cast<uint64_t>(std::random_device{}()) << 32) | std::random_device{}();
+    static std::atomic<uint64_t> calls(0);
 
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_real_distribution<> dis(lowerbound, upperbound);
+    philox::engine gen(seed, calls++);
+    double width = static_cast<double>(upperbound) - lowerbound;
 
+    T* dat = rmat.data();
     for(size_t i=0; i < rmat.size(); i++)
     {
-        rmat[i] = static_cast<T>(dis(gen));
+        dat[i] = static_cast<T>(lowerbound + width * gen.unit());
     }
 
     return rmat;
 }
 
-template<typename T>
-matrix<T> matrix<T>::abs(matrix<T> const& rhs)
+template<typename T, typename Layout, typename Alloc>
+matrix<T, Layout, Alloc> matrix<T, Layout, Alloc>::abs(matrix<T, Layout, Alloc> const& rhs)
 {
-    matrix<T> abs_result(rhs.rows(), rhs.cols());
+    matrix<T, Layout, Alloc> abs_result(rhs.rows(), rhs.cols());
     
-    std::transform
-    (
-        rhs.data(),
-        rhs.data() + rhs.size(),
-        abs_result.data(),
-        [](T val) { return std::abs(val); }
-    );
+    // result is always packed
+    size_t len = Layout::line_size(rhs.rows(), rhs.cols());
+    size_t lines = rhs.size() ? Layout::lines(rhs.rows(), rhs.cols()) : 0;
+    for(size_t l=0; l < lines; l++)
+    {
+        simd::abs(abs_result.m_data.get() + l * len, rhs.data() + l * rhs.stride(), len);
+    }
     
     return abs_result;
 }
 
 // not optimal!, col access is outer loop.
-template<typename T>
-matrix<T>& matrix<T>::set_lower_tri(matrix<T> & rhs, T val, int64_t exrows)
+template<typename T, typename Layout, typename Alloc>
+matrix<T, Layout, Alloc>& matrix<T, Layout, Alloc>::set_lower_tri(matrix<T, Layout, Alloc> & rhs, T val, int64_t exrows)
 {
     for(int64_t c = rhs.cols() - 1; c >= 0; c--)
     {
@@ -944,24 +1822,39 @@ matrix<T>& matrix<T>::set_lower_tri(matrix<T> & rhs, T val, int64_t exrows)
     return rhs;
 }
 
-template<typename T>
-inline matrix<T> matrix<T>::absdiff(matrix<T> const& rhs, matrix<T> const& lhs)
+// |rhs - lhs| in one pass, packed
+template<typename T, typename Layout, typename Alloc>
+matrix<T, Layout, Alloc> matrix<T, Layout, Alloc>::absdiff(matrix<T, Layout, Alloc> const& rhs, matrix<T, Layout, Alloc> const& lhs)
 {
-    return matrix<T>::abs(rhs - lhs);
+    if(rhs.rows() != lhs.rows() || rhs.cols() != lhs.cols())
+    {
+        throw std::range_error("absdiff: dimensions must be equal.");
+    }
+    
+    matrix<T, Layout, Alloc> diff(rhs.rows(), rhs.cols());
+    
+    size_t len = Layout::line_size(rhs.rows(), rhs.cols());
+    size_t lines = rhs.size() ? Layout::lines(rhs.rows(), rhs.cols()) : 0;
+    for(size_t l=0; l < lines; l++)
+    {
+        simd::absdiff(diff.m_data.get() + l * len, rhs.data() + l * rhs.stride(), lhs.data() + l * lhs.stride(), len);
+    }
+    
+    return diff;
 }
 
-template<typename T>
-inline T matrix<T>::abs_max_err(matrix<T> const& result, matrix<T> const& expected)
+template<typename T, typename Layout, typename Alloc>
+inline T matrix<T, Layout, Alloc>::abs_max_err(matrix<T, Layout, Alloc> const& result, matrix<T, Layout, Alloc> const& expected)
 {
-    matrix<T> ad = absdiff(result, expected);
+    matrix<T, Layout, Alloc> ad = absdiff(result, expected);
     
     return *std::max_element(ad.data(), ad.data() + ad.size());
 }
 
-template<typename T>
-inline size_t matrix<T>::abs_max_excess_err(matrix<T> const& result, matrix<T> const& expected, T tolerance)
+template<typename T, typename Layout, typename Alloc>
+inline size_t matrix<T, Layout, Alloc>::abs_max_excess_err(matrix<T, Layout, Alloc> const& result, matrix<T, Layout, Alloc> const& expected, T tolerance)
 {
-    matrix<T> ad = absdiff(result, expected);
+    matrix<T, Layout, Alloc> ad = absdiff(result, expected);
     return std::count_if
     (
         ad.data(),
@@ -971,8 +1864,8 @@ inline size_t matrix<T>::abs_max_excess_err(matrix<T> const& result, matrix<T> c
     
 }
 
-template<typename T>
-T matrix<T>::abs_max_element(matrix<T> const& rhs, size_t from_row)
+template<typename T, typename Layout, typename Alloc>
+T matrix<T, Layout, Alloc>::abs_max_element(matrix<T, Layout, Alloc> const& rhs, size_t from_row)
 {
     T max_elem = static_cast<T>(0.0);
     for(size_t c=from_row; c < rhs.cols(); c++)
@@ -992,44 +1885,24 @@ T matrix<T>::abs_max_element(matrix<T> const& rhs, size_t from_row)
     return max_elem;
 }
 
-template<typename T>
-bool operator==(matrix<T> const& lhs, matrix<T> const& rhs)
+template<typename T, typename Layout, typename Alloc>
+bool operator==(matrix<T, Layout, Alloc> const& lhs, matrix<T, Layout, Alloc> const& rhs)
 {
     return lhs.equals(rhs);
 }
 
-template<typename T>
-bool operator!=(matrix<T> const& lhs, matrix<T> const& rhs)
+template<typename T, typename Layout, typename Alloc>
+bool operator!=(matrix<T, Layout, Alloc> const& lhs, matrix<T, Layout, Alloc> const& rhs)
 {
     return !lhs.equals(rhs);
 }
 
-template<typename T, typename R>
-matrix<T> operator*(R scalar, matrix<T> const& rhs)
-{
-    matrix<T> res(rhs);
-    res *= scalar;
-    return res;
-}
-
-template<typename T, typename R>
-matrix<T> operator+(matrix<T> const& lhs, matrix<R> const& rhs)
-{
-    matrix<T> sum(lhs);
-    sum += rhs;
-    return sum;
-}
-
-template<typename T, typename R>
-matrix<T> operator-(matrix<T> const& lhs, matrix<R> const& rhs)
-{
-    matrix<T> sum(lhs);
-    sum -= rhs;
-    return sum;
-}
+// scalar *, + and - on matrices build lazy expressions, see matrix_expr.h
+template<typename T, typename Layout, typename Alloc>
+struct is_matrix_operand<matrix<T, Layout, Alloc>> : std::true_type {};
 
-template<typename T>
-std::ostream& operator<<(std::ostream& os, matrix<T> const& mat)
+template<typename T, typename Layout, typename Alloc>
+std::ostream& operator<<(std::ostream& os, matrix<T, Layout, Alloc> const& mat)
 {
     for(size_t r=0; r < mat.rows(); r++)
     {
@@ -0,0 +1,264 @@
+//
+//  matrix_expr.h
+//  Created by Ben Westcott on 10/17/26.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <stdexcept>
+#include <type_traits>
+#include "matrix_view.h"
+
+using std::size_t;
+using std::ptrdiff_t;
+
+/*
+ * Lazy elementwise expressions.
+ *
+ * A + B, A - B, s * A and outer(u, v) on matrices and views build expression
+ * nodes instead of matrices. Nothing is computed until the expression is
+ * assigned to a matrix or view (+=, -=, assign, or constructing/assigning a
+ * matrix from it), which evaluates the whole chain in one loop without any
+ * temporaries. So
+ *
+ *      Asub -= beta * outer(v, w);
+ *
+ * is a single pass over Asub, and the M x N outer product is never formed.
+ *
+ * Leaves are views, so an expression must not outlive the matrices it was
+ * built from. Don't keep one in an auto variable past the statement that
+ * builds it from temporaries.
+ *
+ * Every node provides (see lazy_matrix_expr in matrix_view.h)
+ *      e(r, c)             element (r, c)
+ *      e.unit_stride()     whether every leaf has adjacent columns
+ *      e.at_unit(r, c)     element (r, c), assuming unit_stride()
+ *      e.transpose()       the transposed expression, for free
+ * which lets matrix_view evaluate along contiguous memory in a loop the
+ * compiler can vectorize.
+ */
+
+template<typename T>
+class expr_leaf
+{
+public:
+    using value_type = T;
+
+    explicit expr_leaf(matrix_view<T const> const& v) : m_view(v) {}
+
+    size_t rows(void) const { return m_view.rows(); }
+    size_t cols(void) const { return m_view.cols(); }
+
+    T operator()(size_t r, size_t c) const { return m_view(r, c); }
+
+    bool unit_stride(void) const { return m_view.is_contiguous_rows(); }
+
+    T at_unit(size_t r, size_t c) const
+    {
+        return m_view.data()[static_cast<ptrdiff_t>(r) * m_view.row_stride() + static_cast<ptrdiff_t>(c)];
+    }
+
+    expr_leaf<T> transpose(void) const { return expr_leaf<T>(m_view.transpose()); }
+
+private:
+    matrix_view<T const> m_view;
+};
+
+template<typename L, typename R, typename Op>
+class expr_binary
+{
+public:
+    using value_type = std::common_type_t<typename L::value_type, typename R::value_type>;
+
+    expr_binary(L const& lhs, R const& rhs)
+    : m_lhs(lhs), m_rhs(rhs)
+    {
+        if(lhs.rows() != rhs.rows() || lhs.cols() != rhs.cols())
+        {
+            throw std::range_error("expression: dimensions must be equal.");
+        }
+    }
+
+    size_t rows(void) const { return m_lhs.rows(); }
+    size_t cols(void) const { return m_lhs.cols(); }
+
+    value_type operator()(size_t r, size_t c) const
+    {
+        return Op{}(static_cast<value_type>(m_lhs(r, c)), static_cast<value_type>(m_rhs(r, c)));
+    }
+
+    bool unit_stride(void) const { return m_lhs.unit_stride() && m_rhs.unit_stride(); }
+
+    value_type at_unit(size_t r, size_t c) const
+    {
+        return Op{}(static_cast<value_type>(m_lhs.at_unit(r, c)), static_cast<value_type>(m_rhs.at_unit(r, c)));
+    }
+
+    auto transpose(void) const
+    {
+        auto lhs = m_lhs.transpose();
+        auto rhs = m_rhs.transpose();
+        return expr_binary<decltype(lhs), decltype(rhs), Op>(lhs, rhs);
+    }
+
+private:
+    L m_lhs;
+    R m_rhs;
+};
+
+template<typename E>
+class expr_scale
+{
+public:
+    using value_type = typename E::value_type;
+
+    expr_scale(value_type scalar, E const& expr) : m_scalar(scalar), m_expr(expr) {}
+
+    size_t rows(void) const { return m_expr.rows(); }
+    size_t cols(void) const { return m_expr.cols(); }
+
+    value_type operator()(size_t r, size_t c) const { return m_scalar * m_expr(r, c); }
+
+    bool unit_stride(void) const { return m_expr.unit_stride(); }
+    value_type at_unit(size_t r, size_t c) const { return m_scalar * m_expr.at_unit(r, c); }
+
+    auto transpose(void) const
+    {
+        auto expr = m_expr.transpose();
+        return expr_scale<decltype(expr)>(m_scalar, expr);
+    }
+
+private:
+    value_type m_scalar;
+    E m_expr;
+};
+
+/*
+ * Rank-1 term u * v^T, for row or column vectors u and v.
+ */
+template<typename T>
+class expr_outer
+{
+public:
+    using value_type = T;
+
+    expr_outer(matrix_view<T const> const& u, matrix_view<T const> const& v)
+    {
+        if(!u.is_vector() || !v.is_vector())
+        {
+            throw std::out_of_range("incorrect dimensions for outer product.");
+        }
+
+        m_u = u.data();
+        m_v = v.data();
+        m_us = u.is_col_vector() ? u.row_stride() : u.col_stride();
+        m_vs = v.is_col_vector() ? v.row_stride() : v.col_stride();
+        m_rows = u.size();
+        m_cols = v.size();
+    }
+
+    size_t rows(void) const { return m_rows; }
+    size_t cols(void) const { return m_cols; }
+
+    T operator()(size_t r, size_t c) const
+    {
+        return m_u[static_cast<ptrdiff_t>(r) * m_us] * m_v[static_cast<ptrdiff_t>(c) * m_vs];
+    }
+
+    bool unit_stride(void) const { return (m_vs == 1); }
+    T at_unit(size_t r, size_t c) const { return m_u[static_cast<ptrdiff_t>(r) * m_us] * m_v[c]; }
+
+    expr_outer<T> transpose(void) const
+    {
+        return expr_outer<T>(matrix_view<T const>(m_v, m_cols, 1, m_vs, 1), matrix_view<T const>(m_u, m_rows, 1, m_us, 1));
+    }
+
+private:
+    T const* m_u;
+    T const* m_v;
+    ptrdiff_t m_us;
+    ptrdiff_t m_vs;
+    size_t m_rows;
+    size_t m_cols;
+};
+
+// types which take part in expressions as leaves. matrix<T> adds itself in matrix.h
+template<typename X>
+struct is_matrix_operand : std::false_type {};
+
+template<typename T>
+struct is_matrix_operand<matrix_view<T>> : std::true_type {};
+
+template<typename X>
+concept matrix_operand = lazy_matrix_expr<X> || is_matrix_operand<X>::value;
+
+// anything with a shape and (i, j) reads: matrix, fixed_matrix, views and
+// the packed storage types. The packed types convert from any of these
+template<typename M>
+concept matrix_like = requires(M const& m) { m.rows(); m.cols(); m(0, 0); };
+
+// read-only view of a matrix, fixed_matrix or view
+template<typename X>
+matrix_view<std::remove_const_t<typename X::value_type> const> const_view(X const& x)
+{
+    if constexpr(requires { x.view(); })
+    {
+        return x.view();
+    }
+    else
+    {
+        return x;
+    }
+}
+
+template<typename X>
+auto as_expr(X const& x)
+{
+    if constexpr(lazy_matrix_expr<X>)
+    {
+        return x;
+    }
+    else
+    {
+        return expr_leaf<std::remove_const_t<typename X::value_type>>(const_view(x));
+    }
+}
+
+template<typename L, typename R>
+    requires matrix_operand<L> && matrix_operand<R>
+auto operator+(L const& lhs, R const& rhs)
+{
+    auto l = as_expr(lhs);
+    auto r = as_expr(rhs);
+    return expr_binary<decltype(l), decltype(r), std::plus<>>(l, r);
+}
+
+template<typename L, typename R>
+    requires matrix_operand<L> && matrix_operand<R>
+auto operator-(L const& lhs, R const& rhs)
+{
+    auto l = as_expr(lhs);
+    auto r = as_expr(rhs);
+    return expr_binary<decltype(l), decltype(r), std::minus<>>(l, r);
+}
+
+template<typename S, typename E>
+    requires std::is_arithmetic_v<S> && matrix_operand<E>
+auto operator*(S scalar, E const& rhs)
+{
+    auto e = as_expr(rhs);
+    return expr_scale<decltype(e)>(static_cast<typename decltype(e)::value_type>(scalar), e);
+}
+
+/*
+ * Lazy outer product u * v^T. Unlike outer_prod_1D (products.h) this
+ * doesn't form the product, it is evaluated when assigned.
+ */
+template<typename U, typename V>
+expr_outer<std::remove_const_t<typename U::value_type>> outer(U const& u, V const& v)
+{
+    using T = std::remove_const_t<typename U::value_type>;
+    return expr_outer<T>(const_view(u), const_view(v));
+}
@@ -0,0 +1,474 @@
+//
+//  matrix_file.h
+//  Created by Ben Westcott on 10/17/26.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "tdpool.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define LINALG_HAS_MMAP 1
+#else
+#define LINALG_HAS_MMAP 0
+#endif
+
+using std::size_t;
+
+/*
+ * Binary matrix files, written by matrix<T>::save and opened with
+ * matrix<T>::load or matrix<T>::mapped (see matrix.h):
+ *
+ *      offset 0     header, 64 bytes, see below
+ *      data_offset  lines * ld elements of storage, padding included,
+ *                   exactly as the matrix holds it in memory
+ *      after that   if checksummed, one uint64_t checksum per chunk of
+ *                   chunk_lines lines, the last chunk may be shorter
+ *
+ * data_offset is a multiple of the page size, so the data maps onto whole
+ * pages which the page cache shares between every process mapping the
+ * file. Fields are in the byte order of the writer, a reader of the other
+ * order sees a wrong magic.
+ *
+ * write() and read() stream the data chunk by chunk straight from and into
+ * the matrix's storage. A background thread does the I/O of one chunk while
+ * the caller checksums the one before, so there is no staging copy and the
+ * checksums come for free as long as the disk is the bottleneck.
+ */
+namespace matrix_file
+{
+
+constexpr char magic[8] = {'L', 'A', 'M', 'A', 'T', 'R', 'I', 'X'};
+constexpr uint32_t version = 1;
+constexpr uint64_t data_alignment = 4096;
+
+enum class dtype : uint32_t
+{
+    f32 = 1, f64,
+    i8, i16, i32, i64,
+    u8, u16, u32, u64
+};
+
+template<typename T>
+constexpr dtype dtype_of(void)
+{
+    static_assert((std::is_integral_v<T> && !std::is_same_v<T, bool>) || std::is_floating_point_v<T>, "matrix_file: unsupported element type.");
+    static_assert(sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4 || sizeof(T) == 8, "matrix_file: unsupported element type.");
+    static_assert(!std::is_floating_point_v<T> || sizeof(T) == 4 || sizeof(T) == 8, "matrix_file: unsupported element type.");
+
+    if constexpr(std::is_floating_point_v<T>)
+    {
+        return (sizeof(T) == 4) ? dtype::f32 : dtype::f64;
+    }
+    else
+    {
+        constexpr uint32_t log2 = (sizeof(T) == 1) ? 0 : (sizeof(T) == 2) ? 1 : (sizeof(T) == 4) ? 2 : 3;
+        return static_cast<dtype>(static_cast<uint32_t>(std::is_signed_v<T> ? dtype::i8 : dtype::u8) + log2);
+    }
+}
+
+// bytes per element of type t, 0 if t is not a dtype
+constexpr uint32_t size_of(dtype t)
+{
+    uint32_t c = static_cast<uint32_t>(t);
+    if(t == dtype::f32 || t == dtype::f64)
+    {
+        return (t == dtype::f32) ? 4 : 8;
+    }
+    if(c >= static_cast<uint32_t>(dtype::i8) && c <= static_cast<uint32_t>(dtype::u64))
+    {
+        return uint32_t(1) << ((c - static_cast<uint32_t>(dtype::i8)) % 4);
+    }
+    return 0;
+}
+
+// layout codes
+constexpr uint16_t row_major = 0;
+constexpr uint16_t col_major = 1;
+
+// header flags
+constexpr uint16_t checksummed = 1;
+
+// default amount of data per chunk
+constexpr uint64_t chunk_bytes = uint64_t(1) << 26;
+
+struct header
+{
+    char magic[8];
+    uint32_t version;
+    dtype type;
+    uint32_t elem_size;
+    uint16_t layout;
+    uint16_t flags;
+    uint64_t rows;
+    uint64_t cols;
+    // leading dimension, i.e. elements from one line start to the next
+    uint64_t ld;
+    uint64_t data_offset;
+    uint64_t chunk_lines;
+};
+
+static_assert(sizeof(header) == 64, "matrix_file: header must be 64 bytes.");
+
+/*
+ * chunk_lines = 0 picks about chunk_bytes worth of lines. Chunks only
+ * matter for streaming and checksums, mapping ignores them.
+ */
+inline header make_header(dtype type, uint32_t elem_size, uint16_t layout, uint64_t rows, uint64_t cols, uint64_t ld,
+                          bool checksum = false, uint64_t chunk_lines = 0)
+{
+    header h{};
+    std::memcpy(h.magic, magic, sizeof(magic));
+    h.version = version;
+    h.type = type;
+    h.elem_size = elem_size;
+    h.layout = layout;
+    h.flags = checksum ? checksummed : 0;
+    h.rows = rows;
+    h.cols = cols;
+    h.ld = ld;
+    h.data_offset = data_alignment;
+
+    uint64_t line_bytes = ld * elem_size;
+    h.chunk_lines = chunk_lines ? chunk_lines : (line_bytes ? std::max<uint64_t>(1, chunk_bytes/line_bytes) : 1);
+    return h;
+}
+
+inline uint64_t lines(header const& h)
+{
+    return (h.layout == col_major) ? h.cols : h.rows;
+}
+
+inline uint64_t data_bytes(header const& h)
+{
+    return lines(h) * h.ld * h.elem_size;
+}
+
+inline uint64_t chunks(header const& h)
+{
+    return lines(h)/h.chunk_lines + (lines(h) % h.chunk_lines != 0);
+}
+
+// bytes per chunk, a chunk of a short file may be longer than the file
+inline uint64_t chunk_step(header const& h)
+{
+    return std::min(h.chunk_lines, lines(h)) * h.ld * h.elem_size;
+}
+
+// res = a * b, false if that doesn't fit in 64 bits
+inline bool checked_mul(uint64_t a, uint64_t b, uint64_t& res)
+{
+    if(b && a > std::numeric_limits<uint64_t>::max()/b)
+    {
+        return false;
+    }
+    res = a * b;
+    return true;
+}
+
+inline uint64_t checksum_bytes(header const& h)
+{
+    return (h.flags & checksummed) ? chunks(h) * sizeof(uint64_t) : 0;
+}
+
+/*
+ * Fletcher style sum over 32 bit words, the tail zero padded. It catches
+ * torn writes, truncation and flipped bits, not deliberate tampering, and
+ * runs at several GB/s.
+ */
+inline uint64_t checksum(void const* data, uint64_t bytes)
+{
+    unsigned char const* p = static_cast<unsigned char const*>(data);
+    uint64_t a = 0;
+    uint64_t b = 0;
+
+    uint64_t n = bytes/4;
+    for(uint64_t i=0; i < n; i++)
+    {
+        uint32_t w;
+        std::memcpy(&w, p + 4 * i, 4);
+        a += w;
+        b += a;
+    }
+
+    if(bytes % 4)
+    {
+        uint32_t w = 0;
+        std::memcpy(&w, p + 4 * n, bytes % 4);
+        a += w;
+        b += a;
+    }
+
+    return a ^ (b * 0x9E3779B97F4A7C15ull) ^ bytes;
+}
+
+// throws unless h describes T in the given layout within a file of file_size bytes
+inline void check_header(header const& h, dtype type, uint16_t layout, uint64_t file_size, std::string const& path)
+{
+    if(std::memcmp(h.magic, magic, sizeof(magic)) != 0)
+    {
+        throw std::runtime_error("matrix_file: " + path + " is not a matrix file, or of the other byte order.");
+    }
+    if(h.version != version)
+    {
+        throw std::runtime_error("matrix_file: " + path + " has an unsupported version.");
+    }
+    if(h.type != type)
+    {
+        throw std::runtime_error("matrix_file: " + path + " holds a different element type.");
+    }
+    if(h.elem_size != size_of(type))
+    {
+        throw std::runtime_error("matrix_file: " + path + " has an element size which doesn't match its type.");
+    }
+    if(h.layout != layout)
+    {
+        throw std::runtime_error("matrix_file: " + path + " is stored in a different layout.");
+    }
+    if(h.data_offset < sizeof(header) || h.data_offset % 64 || !h.chunk_lines || file_size < h.data_offset)
+    {
+        throw std::runtime_error("matrix_file: " + path + " is truncated or corrupt.");
+    }
+
+    // the sizes come from the file, so they may overflow
+    uint64_t elems, bytes, sum_bytes;
+    uint64_t avail = file_size - h.data_offset;
+    if(!checked_mul(lines(h), h.ld, elems) || !checked_mul(elems, h.elem_size, bytes)
+       || !checked_mul(chunks(h), (h.flags & checksummed) ? sizeof(uint64_t) : 0, sum_bytes)
+       || bytes > avail || sum_bytes > avail - bytes)
+    {
+        throw std::runtime_error("matrix_file: " + path + " is truncated or corrupt.");
+    }
+}
+
+inline void write(std::string const& path, header const& h, void const* data)
+{
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if(!out)
+    {
+        throw std::runtime_error("matrix_file: could not open " + path + " for writing.");
+    }
+
+    char zeros[data_alignment] = {};
+    out.write(reinterpret_cast<char const*>(&h), sizeof(h));
+    out.write(zeros, h.data_offset - sizeof(h));
+
+    uint64_t total = data_bytes(h);
+    uint64_t step = chunk_step(h);
+    std::vector<uint64_t> sums(chunks(h));
+
+    // chunk k is written in the background while chunk k+1 is summed
+    tdpool io(1);
+    std::future<void> pending;
+    for(uint64_t k=0; k < sums.size(); k++)
+    {
+        char const* chunk = static_cast<char const*>(data) + k * step;
+        uint64_t n = std::min(step, total - k * step);
+
+        if(h.flags & checksummed)
+        {
+            sums[k] = checksum(chunk, n);
+        }
+
+        if(pending.valid())
+        {
+            pending.get();
+        }
+        pending = io.enqueue([&out, chunk, n] { out.write(chunk, n); });
+    }
+
+    if(pending.valid())
+    {
+        pending.get();
+    }
+
+    out.write(reinterpret_cast<char const*>(sums.data()), checksum_bytes(h));
+
+    if(!out.flush())
+    {
+        throw std::runtime_error("matrix_file: writing " + path + " failed.");
+    }
+}
+
+// opens path and reads its header, which is checked like check_header
+inline std::ifstream open(std::string const& path, header& h, dtype type, uint16_t layout)
+{
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if(!in)
+    {
+        throw std::runtime_error("matrix_file: could not open " + path + ".");
+    }
+
+    uint64_t size = static_cast<uint64_t>(in.tellg());
+    in.seekg(0);
+    if(size < sizeof(header) || !in.read(reinterpret_cast<char*>(&h), sizeof(h)))
+    {
+        throw std::runtime_error("matrix_file: " + path + " is truncated or corrupt.");
+    }
+
+    check_header(h, type, layout, size, path);
+    return in;
+}
+
+/*
+ * Reads the data of an opened file into data, data_bytes(h) of it, verifying
+ * checksums if the file has them. Chunk k+1 is read in the background while
+ * chunk k is verified.
+ */
+inline void read(std::ifstream& in, header const& h, void* data, std::string const& path)
+{
+    uint64_t total = data_bytes(h);
+    uint64_t step = chunk_step(h);
+    std::vector<uint64_t> sums(chunks(h));
+
+    if(h.flags & checksummed)
+    {
+        in.seekg(h.data_offset + total);
+        in.read(reinterpret_cast<char*>(sums.data()), checksum_bytes(h));
+    }
+    in.seekg(h.data_offset);
+
+    auto verify = [&](uint64_t k)
+    {
+        char const* chunk = static_cast<char const*>(data) + k * step;
+        if((h.flags & checksummed) && checksum(chunk, std::min(step, total - k * step)) != sums[k])
+        {
+            throw std::runtime_error("matrix_file: checksum mismatch in chunk " + std::to_string(k) + " of " + path + ".");
+        }
+    };
+
+    tdpool io(1);
+    for(uint64_t k=0; k < sums.size(); k++)
+    {
+        char* chunk = static_cast<char*>(data) + k * step;
+        uint64_t n = std::min(step, total - k * step);
+
+        std::future<bool> pending = io.enqueue([&in, chunk, n] { return static_cast<bool>(in.read(chunk, n)); });
+        if(k)
+        {
+            try
+            {
+                verify(k - 1);
+            }
+            catch(...)
+            {
+                pending.wait();
+                throw;
+            }
+        }
+
+        if(!pending.get())
+        {
+            throw std::runtime_error("matrix_file: reading " + path + " failed.");
+        }
+    }
+
+    if(!sums.empty())
+    {
+        verify(sums.size() - 1);
+    }
+}
+
+enum class map_mode
+{
+    /*
+     * pages are shared with every other mapping of the file and mapped
+     * PROT_READ, so a store into them faults. matrix::mapped() detaches into
+     * its own memory on the first write through a non-const member, and its
+     * const members only hand out T const* and matrix_view<T const>, so only
+     * a const_cast can reach the mapping for writing.
+     */
+    read_only,
+    // pages are shared until written, writes stay private to the process
+    copy_on_write
+};
+
+/*
+ * The whole file, mapped. base is owned by a deleter which unmaps it, so
+ * aliasing shared_ptrs into the data keep the mapping alive.
+ */
+struct mapping
+{
+    std::shared_ptr<void> base;
+    uint64_t size;
+
+    header const& head(void) const { return *static_cast<header const*>(base.get()); }
+    void* data(void) const { return static_cast<char*>(base.get()) + head().data_offset; }
+};
+
+#if LINALG_HAS_MMAP
+
+inline mapping map(std::string const& path, map_mode mode)
+{
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if(fd < 0)
+    {
+        throw std::runtime_error("matrix_file: could not open " + path + ".");
+    }
+
+    struct stat st;
+    if(::fstat(fd, &st) != 0 || static_cast<uint64_t>(st.st_size) < sizeof(header))
+    {
+        ::close(fd);
+        throw std::runtime_error("matrix_file: " + path + " is truncated or corrupt.");
+    }
+
+    uint64_t size = static_cast<uint64_t>(st.st_size);
+    int prot = (mode == map_mode::read_only) ? PROT_READ : (PROT_READ | PROT_WRITE);
+    int flags = (mode == map_mode::read_only) ? MAP_SHARED : MAP_PRIVATE;
+
+    void* base = ::mmap(nullptr, size, prot, flags, fd, 0);
+
+    // the mapping holds its own reference to the file
+    ::close(fd);
+
+    if(base == MAP_FAILED)
+    {
+        throw std::runtime_error("matrix_file: could not map " + path + ".");
+    }
+
+    return mapping{std::shared_ptr<void>(base, [size](void* p) { ::munmap(p, size); }), size};
+}
+
+#else
+
+// no mmap, reads the file into memory instead
+inline mapping map(std::string const& path, map_mode)
+{
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if(!in)
+    {
+        throw std::runtime_error("matrix_file: could not open " + path + ".");
+    }
+
+    uint64_t size = static_cast<uint64_t>(in.tellg());
+    if(size < sizeof(header))
+    {
+        throw std::runtime_error("matrix_file: " + path + " is truncated or corrupt.");
+    }
+
+    std::shared_ptr<void> base(::operator new(size, std::align_val_t(data_alignment)), [](void* p) { ::operator delete(p, std::align_val_t(data_alignment)); });
+    in.seekg(0);
+    in.read(static_cast<char*>(base.get()), size);
+
+    return mapping{base, size};
+}
+
+#endif
+
+}
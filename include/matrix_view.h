@@ -0,0 +1,408 @@
+//
+//  matrix_view.h
+//  Created by Ben Westcott on 10/17/26.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <stdexcept>
+#include <type_traits>
+
+using std::size_t;
+using std::ptrdiff_t;
+
+// lazy expression nodes, see matrix_expr.h
+template<typename E>
+concept lazy_matrix_expr = requires(E const& e)
+{
+    e(0, 0);
+    e.unit_stride();
+    e.at_unit(0, 0);
+    e.transpose();
+};
+
+/*
+ * Non-owning window into matrix storage.
+ *
+ * A view is a pointer to its first element, its extents, and a row stride
+ * (the leading dimension of whatever it was taken from) and column stride.
+ * Reads and writes go straight through to the underlying storage, so sub blocks,
+ * rows, columns and diagonals can be updated in place without a
+ * sub_matrix/set_sub_matrix round trip.
+ *
+ * Strides are signed, so transpose() and the reverse_*() adapters are free:
+ * they only swap or negate strides and move the base pointer. Running an
+ * algorithm on such a view runs it on the transposed/reversed problem
+ * without copying anything.
+ *
+ * The view does not keep the owning matrix alive, and copying a view
+ * rebinds it (like std::span). Use assign() to copy elements into a view.
+ */
+template<typename T>
+class matrix_view
+{
+public:
+    using value_type = T;
+
+    matrix_view(void);
+    matrix_view(T* dat, size_t r, size_t c, size_t ld);
+    matrix_view(T* dat, size_t r, size_t c, ptrdiff_t rs, ptrdiff_t cs);
+
+    // matrix_view<T> converts to matrix_view<T const>
+    template<typename U>
+        requires std::is_convertible_v<U*, T*>
+    matrix_view(matrix_view<U> const& rhs);
+
+    size_t size(void) const { return m_rows * m_cols; }
+    size_t rows(void) const { return m_rows; }
+    size_t cols(void) const { return m_cols; }
+    size_t stride(void) const { return static_cast<size_t>(std::abs(m_rs)); }
+    ptrdiff_t row_stride(void) const { return m_rs; }
+    ptrdiff_t col_stride(void) const { return m_cs; }
+    bool is_contiguous_rows(void) const { return (m_cs == 1); }
+
+    bool is_square(void) const { return (m_rows == m_cols); }
+    bool is_row_vector(void) const { return (m_rows == 1); }
+    bool is_col_vector(void) const { return (m_cols == 1); }
+    bool is_vector(void) const { return is_row_vector() || is_col_vector(); }
+
+    T* data(void) const { return m_data; }
+
+    ptrdiff_t offset(size_t m, size_t n) const;
+
+    T& operator()(size_t m, size_t n) const;
+    T& operator[](size_t offs) const;
+
+    matrix_view<T> row(size_t r) const;
+    matrix_view<T> col(size_t c) const;
+    matrix_view<T> diag(void) const;
+
+    matrix_view<T> sub_matrix(size_t start_row, size_t nrows, size_t start_col, size_t ncols) const;
+    matrix_view<T> sub_matrix(size_t start_row, size_t start_col) const;
+    matrix_view<T> sub_col(size_t start_row, size_t nrows, size_t c) const;
+    matrix_view<T> sub_row(size_t r, size_t start_col, size_t ncols) const;
+
+    matrix_view<T> transpose(void) const;
+    matrix_view<T> reverse_rows(void) const;
+    matrix_view<T> reverse_cols(void) const;
+    matrix_view<T> reverse(void) const;
+
+    void fill(T value) const;
+
+    template<typename M>
+    matrix_view<T> const& assign(M const& rhs) const;
+
+    template<typename M>
+    matrix_view<T> const& operator+=(M const& rhs) const;
+
+    template<typename M>
+    matrix_view<T> const& operator-=(M const& rhs) const;
+
+    template<typename R>
+    matrix_view<T> const& operator*=(R scalar) const;
+
+private:
+
+    template<typename M>
+    void check_dims(M const& rhs, char const* what) const;
+
+    template<typename F>
+    void for_each(F&& f) const;
+
+    template<typename E, typename F>
+    void eval(E const& expr, F&& f) const;
+
+    T* m_data;
+    size_t m_rows;
+    size_t m_cols;
+    ptrdiff_t m_rs;
+    ptrdiff_t m_cs;
+};
+
+template<typename T>
+matrix_view<T>::matrix_view(void)
+: m_data(nullptr), m_rows(0), m_cols(0), m_rs(0), m_cs(1)
+{
+}
+
+template<typename T>
+matrix_view<T>::matrix_view(T* dat, size_t r, size_t c, size_t ld)
+: matrix_view<T>(dat, r, c, static_cast<ptrdiff_t>(ld), 1)
+{
+}
+
+template<typename T>
+matrix_view<T>::matrix_view(T* dat, size_t r, size_t c, ptrdiff_t rs, ptrdiff_t cs)
+: m_data(dat), m_rows(r), m_cols(c), m_rs(rs), m_cs(cs)
+{
+}
+
+template<typename T>
+template<typename U>
+    requires std::is_convertible_v<U*, T*>
+matrix_view<T>::matrix_view(matrix_view<U> const& rhs)
+: matrix_view<T>(rhs.data(), rhs.rows(), rhs.cols(), rhs.row_stride(), rhs.col_stride())
+{
+}
+
+template<typename T>
+inline ptrdiff_t matrix_view<T>::offset(size_t m, size_t n) const
+{
+    return (static_cast<ptrdiff_t>(m) * m_rs + static_cast<ptrdiff_t>(n) * m_cs);
+}
+
+template<typename T>
+inline T& matrix_view<T>::operator()(size_t m, size_t n) const
+{
+    return m_data[offset(m, n)];
+}
+
+/*
+ * Linear (row-major) indexing, mainly so vector views can be used
+ * anywhere a row or column vector matrix is indexed with [].
+ */
+template<typename T>
+inline T& matrix_view<T>::operator[](size_t offs) const
+{
+    if(m_cols == 1)
+    {
+        return m_data[static_cast<ptrdiff_t>(offs) * m_rs];
+    }
+    else if(m_rows == 1)
+    {
+        return m_data[static_cast<ptrdiff_t>(offs) * m_cs];
+    }
+    return m_data[offset(offs / m_cols, offs % m_cols)];
+}
+
+template<typename T>
+matrix_view<T> matrix_view<T>::row(size_t r) const
+{
+    if(r >= m_rows)
+    {
+        throw std::range_error("row: row index is out of range.");
+    }
+
+    return matrix_view<T>(m_data + offset(r, 0), 1, m_cols, m_rs, m_cs);
+}
+
+template<typename T>
+matrix_view<T> matrix_view<T>::col(size_t c) const
+{
+    if(c >= m_cols)
+    {
+        throw std::range_error("col: column index is out of range.");
+    }
+
+    return matrix_view<T>(m_data + offset(0, c), m_rows, 1, m_rs, m_cs);
+}
+
+// main diagonal as a column vector, stepping one row and one column at a time
+template<typename T>
+matrix_view<T> matrix_view<T>::diag(void) const
+{
+    return matrix_view<T>(m_data, std::min(m_rows, m_cols), 1, m_rs + m_cs, m_cs);
+}
+
+template<typename T>
+matrix_view<T> matrix_view<T>::sub_matrix(size_t start_row, size_t nrows, size_t start_col, size_t ncols) const
+{
+    if(start_row + nrows > m_rows || start_col + ncols > m_cols)
+    {
+        throw std::range_error("sub_matrix: incompatible dimensions for submatrix.");
+    }
+
+    return matrix_view<T>(m_data + offset(start_row, start_col), nrows, ncols, m_rs, m_cs);
+}
+
+template<typename T>
+matrix_view<T> matrix_view<T>::sub_matrix(size_t start_row, size_t start_col) const
+{
+    return sub_matrix(start_row, m_rows - start_row, start_col, m_cols - start_col);
+}
+
+template<typename T>
+matrix_view<T> matrix_view<T>::sub_col(size_t start_row, size_t nrows, size_t c) const
+{
+    return sub_matrix(start_row, nrows, c, 1);
+}
+
+template<typename T>
+matrix_view<T> matrix_view<T>::sub_row(size_t r, size_t start_col, size_t ncols) const
+{
+    return sub_matrix(r, 1, start_col, ncols);
+}
+
+template<typename T>
+matrix_view<T> matrix_view<T>::transpose(void) const
+{
+    return matrix_view<T>(m_data, m_cols, m_rows, m_cs, m_rs);
+}
+
+// row i of the result is row (rows - 1 - i) of this view
+template<typename T>
+matrix_view<T> matrix_view<T>::reverse_rows(void) const
+{
+    T* base = m_rows ? m_data + offset(m_rows - 1, 0) : m_data;
+    return matrix_view<T>(base, m_rows, m_cols, -m_rs, m_cs);
+}
+
+// col j of the result is col (cols - 1 - j) of this view
+template<typename T>
+matrix_view<T> matrix_view<T>::reverse_cols(void) const
+{
+    T* base = m_cols ? m_data + offset(0, m_cols - 1) : m_data;
+    return matrix_view<T>(base, m_rows, m_cols, m_rs, -m_cs);
+}
+
+// reverses both, i.e. element (i, j) is element (rows - 1 - i, cols - 1 - j) of this view
+template<typename T>
+matrix_view<T> matrix_view<T>::reverse(void) const
+{
+    return reverse_rows().reverse_cols();
+}
+
+/*
+ * Calls f(element, r, c) for every element, walking along whichever of
+ * rows or columns is closer to contiguous in memory.
+ */
+template<typename T>
+template<typename F>
+inline void matrix_view<T>::for_each(F&& f) const
+{
+    if(std::abs(m_rs) < std::abs(m_cs))
+    {
+        for(size_t c=0; c < m_cols; c++)
+        {
+            T* col_ptr = m_data + offset(0, c);
+            for(size_t r=0; r < m_rows; r++)
+            {
+                f(col_ptr[static_cast<ptrdiff_t>(r) * m_rs], r, c);
+            }
+        }
+        return;
+    }
+
+    for(size_t r=0; r < m_rows; r++)
+    {
+        T* row_ptr = m_data + offset(r, 0);
+        for(size_t c=0; c < m_cols; c++)
+        {
+            f(row_ptr[static_cast<ptrdiff_t>(c) * m_cs], r, c);
+        }
+    }
+}
+
+/*
+ * Calls f(element, expr(r, c)) for every element. Runs along contiguous
+ * memory with unit strides when it can, so that the loop vectorizes.
+ */
+template<typename T>
+template<typename E, typename F>
+void matrix_view<T>::eval(E const& expr, F&& f) const
+{
+    if(m_rs == 1 && m_cs != 1)
+    {
+        transpose().eval(expr.transpose(), f);
+        return;
+    }
+
+    if(m_cs != 1 || !expr.unit_stride())
+    {
+        for_each([&](T& elem, size_t r, size_t c) { f(elem, expr(r, c)); });
+        return;
+    }
+
+    for(size_t r=0; r < m_rows; r++)
+    {
+        T* row_ptr = m_data + offset(r, 0);
+        for(size_t c=0; c < m_cols; c++)
+        {
+            f(row_ptr[c], expr.at_unit(r, c));
+        }
+    }
+}
+
+template<typename T>
+void matrix_view<T>::fill(T value) const
+{
+    for_each([value](T& elem, size_t, size_t) { elem = value; });
+}
+
+template<typename T>
+template<typename M>
+inline void matrix_view<T>::check_dims(M const& rhs, char const* what) const
+{
+    if(m_rows != rhs.rows() || m_cols != rhs.cols())
+    {
+        throw std::range_error(what);
+    }
+}
+
+template<typename T>
+template<typename M>
+matrix_view<T> const& matrix_view<T>::assign(M const& rhs) const
+{
+    check_dims(rhs, "assign: dimensions must be equal.");
+
+    if constexpr(lazy_matrix_expr<M>)
+    {
+        eval(rhs, [](T& elem, auto val) { elem = static_cast<T>(val); });
+    }
+    else
+    {
+        for_each([&rhs](T& elem, size_t r, size_t c) { elem = static_cast<T>(rhs(r, c)); });
+    }
+
+    return *this;
+}
+
+template<typename T>
+template<typename M>
+matrix_view<T> const& matrix_view<T>::operator+=(M const& rhs) const
+{
+    check_dims(rhs, "operator+=: dimensions must be equal.");
+
+    if constexpr(lazy_matrix_expr<M>)
+    {
+        eval(rhs, [](T& elem, auto val) { elem += static_cast<T>(val); });
+    }
+    else
+    {
+        for_each([&rhs](T& elem, size_t r, size_t c) { elem += static_cast<T>(rhs(r, c)); });
+    }
+
+    return *this;
+}
+
+template<typename T>
+template<typename M>
+matrix_view<T> const& matrix_view<T>::operator-=(M const& rhs) const
+{
+    check_dims(rhs, "operator-=: dimensions must be equal.");
+
+    if constexpr(lazy_matrix_expr<M>)
+    {
+        eval(rhs, [](T& elem, auto val) { elem -= static_cast<T>(val); });
+    }
+    else
+    {
+        for_each([&rhs](T& elem, size_t r, size_t c) { elem -= static_cast<T>(rhs(r, c)); });
+    }
+
+    return *this;
+}
+
+template<typename T>
+template<typename R>
+matrix_view<T> const& matrix_view<T>::operator*=(R scalar) const
+{
+    T factor = static_cast<T>(scalar);
+    for_each([factor](T& elem, size_t, size_t) { elem *= factor; });
+
+    return *this;
+}
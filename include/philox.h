@@ -0,0 +1,156 @@
+//
+//  philox.h
+//  Created by Ben Westcott on 10/17/26.
+//
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+/*
+ * Philox4x32-10 (Salmon et al., "Parallel random numbers: as easy as
+ * 1, 2, 3"), a counter-based generator: each 128 bit counter is mapped to
+ * 128 random bits under a 64 bit key, without any state in between. Any
+ * element of a stream can be computed directly from its index, so parallel
+ * fills are reproducible whatever the number of threads.
+ */
+namespace philox
+{
+
+using counter = std::array<uint32_t, 4>;
+using key = std::array<uint32_t, 2>;
+
+inline key make_key(uint64_t seed)
+{
+    return {static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32)};
+}
+
+inline counter block(counter c, key k)
+{
+    constexpr uint64_t M0 = 0xD2511F53;
+    constexpr uint64_t M1 = 0xCD9E8D57;
+    constexpr uint32_t W0 = 0x9E3779B9;
+    constexpr uint32_t W1 = 0xBB67AE85;
+
+    for(int r=0; r < 10; r++)
+    {
+        uint64_t p0 = M0 * c[0];
+        uint64_t p1 = M1 * c[2];
+
+        c = {static_cast<uint32_t>(p1 >> 32) ^ c[1] ^ k[0], static_cast<uint32_t>(p1),
+             static_cast<uint32_t>(p0 >> 32) ^ c[3] ^ k[1], static_cast<uint32_t>(p0)};
+
+        k[0] += W0;
+        k[1] += W1;
+    }
+    return c;
+}
+
+/*
+ * Blocks for the W counters (c0 + l, c1, c2, c3), l < W, into lane arrays
+ * out[word][l]. The same rounds as block(), written lane by lane so they
+ * vectorize: one block is a chain of 10 dependent multiplies, W of them
+ * fill the multiplier.
+ */
+template<size_t W>
+inline void blocks(uint32_t c0, uint32_t c1, uint32_t c2, uint32_t c3, key k, uint32_t (&out)[4][W])
+{
+    constexpr uint64_t M0 = 0xD2511F53;
+    constexpr uint64_t M1 = 0xCD9E8D57;
+    constexpr uint32_t W0 = 0x9E3779B9;
+    constexpr uint32_t W1 = 0xBB67AE85;
+
+    uint32_t (&x0)[W] = out[0];
+    uint32_t (&x1)[W] = out[1];
+    uint32_t (&x2)[W] = out[2];
+    uint32_t (&x3)[W] = out[3];
+
+    for(size_t l=0; l < W; l++)
+    {
+        x0[l] = c0 + static_cast<uint32_t>(l);
+        x1[l] = c1;
+        x2[l] = c2;
+        x3[l] = c3;
+    }
+
+    for(int r=0; r < 10; r++)
+    {
+        for(size_t l=0; l < W; l++)
+        {
+            uint64_t p0 = M0 * x0[l];
+            uint64_t p1 = M1 * x2[l];
+
+            x0[l] = static_cast<uint32_t>(p1 >> 32) ^ x1[l] ^ k[0];
+            x1[l] = static_cast<uint32_t>(p1);
+            x2[l] = static_cast<uint32_t>(p0 >> 32) ^ x3[l] ^ k[1];
+            x3[l] = static_cast<uint32_t>(p0);
+        }
+
+        k[0] += W0;
+        k[1] += W1;
+    }
+}
+
+// 53 random bits as a double in [0, 1)
+inline double unit(uint32_t hi, uint32_t lo)
+{
+    return static_cast<double>(((static_cast<uint64_t>(hi) << 32) | lo) >> 11) * 0x1.0p-53;
+}
+
+/*
+ * Sequential engine over one stream, a UniformRandomBitGenerator for use
+ * with the <random> distributions. Block b of stream s is the counter
+ * (b, b >> 32, s, s >> 32).
+ */
+class engine
+{
+public:
+    using result_type = uint32_t;
+
+    explicit engine(uint64_t seed, uint64_t stream = 0)
+    : m_key(make_key(seed)), m_stream(stream), m_block(0), m_used(4)
+    {
+    }
+
+    static constexpr result_type min(void) { return 0; }
+    static constexpr result_type max(void) { return std::numeric_limits<uint32_t>::max(); }
+
+    result_type operator()(void)
+    {
+        if(m_used == 4)
+        {
+            m_bits = block({static_cast<uint32_t>(m_block), static_cast<uint32_t>(m_block >> 32),
+                            static_cast<uint32_t>(m_stream), static_cast<uint32_t>(m_stream >> 32)}, m_key);
+            m_block++;
+            m_used = 0;
+        }
+        return m_bits[m_used++];
+    }
+
+    // double in [0, 1)
+    double unit(void)
+    {
+        uint32_t hi = (*this)();
+        return philox::unit(hi, (*this)());
+    }
+
+    // skips to the start of block b
+    void seek(uint64_t b)
+    {
+        m_block = b;
+        m_used = 4;
+    }
+
+private:
+
+    key m_key;
+    uint64_t m_stream;
+    uint64_t m_block;
+    counter m_bits;
+    int m_used;
+};
+
+}
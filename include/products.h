@@ -6,13 +6,25 @@
 #pragma once
 
 #include "matrix.h"
+#include "matrix_view.h"
 #include "tdpool.h"
+#include "gemm.h"
+#include "gemv.h"
+#include "strassen.h"
 #include <vector>
 #include <iostream>
 
-template<typename T>
-matrix<T> outer_prod_1D(matrix<T> const& cvec, matrix<T> const& rvec)
+/*
+ * The products below accept any matrix-like argument, i.e. matrix<T> or
+ * matrix_view<T> (mixed freely), so factorizations can pass in-place
+ * views of sub blocks instead of sub_matrix copies.
+ */
+
+template<typename C, typename R>
+matrix<typename C::value_type> outer_prod_1D(C const& cvec, R const& rvec)
 {
+    using T = typename C::value_type;
+    
     if(!cvec.is_vector() || !rvec.is_vector())
     {
         throw std::out_of_range("incorrect dimensions for outer product.");
@@ -33,24 +45,21 @@ matrix<T> outer_prod_1D(matrix<T> const& cvec, matrix<T> const& rvec)
 }
 
 // NOTE: DOES NOT VERIFY SIZE, OR IF THEY ARE VECTORS
-template<typename T>
-inline T inner_prod_1D(matrix<T> const& rvec, matrix<T> const& cvec, size_t offs)
+template<typename L, typename R>
+inline typename L::value_type inner_prod_1D(L const& rvec, R const& cvec, size_t offs)
 {
-    T* rv_ptr = rvec.data();
-    T* cv_ptr = cvec.data();
-   /* T res = static_cast<T>(0.0);
-    for(size_t r=offs; r < rvec.size(); r++)
+    using T = typename L::value_type;
+    
+    T res = static_cast<T>(0.0);
+    for(size_t i=offs; i < rvec.size(); i++)
     {
-        for(size_t c=0; c < cvec.size(); c++)
-        {
-            res += rvec[r] * cvec[c];
-        }
-    }*/
-    return std::inner_product(rv_ptr + offs, rv_ptr + rvec.size(), cv_ptr + offs, static_cast<T>(0.0));
+        res += rvec[i] * cvec[i];
+    }
+    return res;
 }
 
-template<typename T>
-T inner_prod_1D(matrix<T> const& rvec, matrix<T> const& cvec)
+template<typename L, typename R>
+typename L::value_type inner_prod_1D(L const& rvec, R const& cvec)
 {
     if(rvec.size() != cvec.size())
     {
@@ -60,56 +69,81 @@ T inner_prod_1D(matrix<T> const& rvec, matrix<T> const& cvec)
     return inner_prod_1D(rvec, cvec, 0);
 }
 
-template<typename T>
-matrix<T> inner_left_prod(const matrix<T>& rvec, const matrix<T>& cvecs)
+/*
+ * iprod <- rvec^T * cvecs, written into an existing vector (e.g. scratch
+ * storage which is reused across the steps of a factorization). A gemv
+ * with op = T, so cvecs is read once in its own layout.
+ */
+template<typename L, typename R>
+void inner_left_prod(L const& rvec, R const& cvecs, matrix_view<typename L::value_type> const& iprod)
 {
-    //std::cout << "rvec dims = " << rvec.rows() << "\t" << rvec.cols() << "\n";
-    //std::cout << "cvec dims = " << cvecs.rows() << "\t" << cvecs.cols() << "\n\n";
-    if(rvec.size() != cvecs.rows())
+    using T = typename L::value_type;
+    
+    if(rvec.size() != cvecs.rows() || iprod.size() != cvecs.cols())
     {
         throw std::range_error("incorrect dimensions for inner product.");
     }
 
-    matrix<T> iprod(1, cvecs.cols());
-    for(size_t c=0; c < cvecs.cols(); c++)
-    {
-        iprod.get_value(0, c) = inner_prod_1D(rvec, cvecs.col(c), 0);
-    }
+    gemv_detail::gemv(static_cast<T>(1), const_view(cvecs).transpose(), const_view(rvec), static_cast<T>(0), iprod);
+}
 
+template<typename L, typename R>
+matrix<typename L::value_type> inner_left_prod(L const& rvec, R const& cvecs)
+{
+    using T = typename L::value_type;
+    
+    matrix<T> iprod(1, cvecs.cols());
+    inner_left_prod(rvec, cvecs, iprod.view());
     return iprod;
 }
 
-template<typename T>
-matrix<T> inner_right_prod(const matrix<T>& rvecs, const matrix<T>& cvec)
+// iprod <- rvecs * cvec, written into an existing vector, a gemv with op = N
+template<typename L, typename R>
+void inner_right_prod(L const& rvecs, R const& cvec, matrix_view<typename L::value_type> const& iprod)
 {
-    if(rvecs.cols() != cvec.size())
+    using T = typename L::value_type;
+    
+    if(rvecs.cols() != cvec.size() || iprod.size() != rvecs.rows())
     {
         throw std::range_error("incorrect dimensions for inner product.");
     }
 
-    matrix<T> iprod(rvecs.rows(), 1);
-    for(size_t r=0; r < rvecs.rows(); r++)
-    {
-        iprod.get_value(r, 0) = inner_prod_1D(rvecs.row(r), cvec, 0);
-    }
+    gemv_detail::gemv(static_cast<T>(1), const_view(rvecs), const_view(cvec), static_cast<T>(0), iprod);
+}
 
+template<typename L, typename R>
+matrix<typename L::value_type> inner_right_prod(L const& rvecs, R const& cvec)
+{
+    using T = typename L::value_type;
+    
+    matrix<T> iprod(rvecs.rows(), 1);
+    inner_right_prod(rvecs, cvec, iprod.view());
     return iprod;
 }
 
-template<typename T>
-matrix<T> projection(matrix<T> const& u, matrix<T> const& v)
+template<typename U, typename V>
+matrix<typename U::value_type> projection(U const& u, V const& v)
 {
-    return (inner_prod_1D(v, u)/inner_prod_1D(u, u)) * u;
+    using T = typename U::value_type;
+    
+    matrix<T> proj(u);
+    proj *= (inner_prod_1D(v, u)/inner_prod_1D(u, u));
+    return proj;
 }
 
-template<typename T>
-double col_norm2sq_from(matrix<T> const& rhs, size_t c, size_t from_row)
+template<typename M>
+double col_norm2sq_from(M const& rhs, size_t c, size_t from_row)
 {
-    return inner_prod_1D(rhs.col(c), rhs.col(c), from_row);
+    double res = 0.0;
+    for(size_t r=from_row; r < rhs.rows(); r++)
+    {
+        res += rhs(r, c) * rhs(r, c);
+    }
+    return res;
 }
 
-template<typename T>
-double col_norm2sq(const matrix<T>& rhs, size_t c)
+template<typename M>
+double col_norm2sq(M const& rhs, size_t c)
 {
     if(c >= rhs.cols())
     {
@@ -119,14 +153,14 @@ double col_norm2sq(const matrix<T>& rhs, size_t c)
     return col_norm2sq_from(rhs, c, 0);
 } 
 
-template<typename T>
-double vec_norm2sq_from(matrix<T> const& rhs, size_t offs)
+template<typename M>
+double vec_norm2sq_from(M const& rhs, size_t offs)
 {
     return inner_prod_1D(rhs, rhs, offs);
 }
 
-template<typename T>
-matrix<double> cols_norm2sq(matrix<T> const& rhs)
+template<typename M>
+matrix<double> cols_norm2sq(M const& rhs)
 {
     matrix<double> norms(1, rhs.cols());
     
@@ -138,87 +172,69 @@ matrix<double> cols_norm2sq(matrix<T> const& rhs)
     return norms;
 }
 
-template<class T>
-matrix<T>** mat_mul_create_pairs(const matrix<T>* lhs, const matrix<T>* rhs)
+/*
+ * lhs * rhs on pool, through the blocked kernel of gemm.h. The operands
+ * may have different layouts, the product is row-major.
+ */
+template<class T, class LL, class LA, class RL, class RA>
+matrix<T> mat_mul_alg1(const matrix<T, LL, LA>* lhs, const matrix<T, RL, RA>* rhs, tdpool & pool)
 {
-   /* if(lhs->cols() != rhs->rows())
-    {
-        throw std::domain_error("outer product is undefined for given dimensions!");
-    }*/
-    
-    size_t N = lhs->cols();
-    matrix<T>** tmpl = new matrix<T>*[lhs->cols()];
-
-    for(size_t r=0; r < N; r++)
+    if(lhs->cols() != rhs->rows())
     {
-        tmpl[r] = new matrix<T>[2]
-        {
-            matrix<T>(lhs->col(r)), matrix<T>(rhs->row(r))
-        };
+        throw std::range_error("mat_mul_alg1: incorrect dimensions.");
     }
     
-    return tmpl;
+    matrix<T> mresult(lhs->rows(), rhs->cols());
+    mat_mul(static_cast<T>(1), *lhs, *rhs, static_cast<T>(0), mresult.view(), pool);
+    
+    return mresult;
 }
 
-
-template<class T>
-matrix<T>* mat_mul_create_pair(const matrix<T>* lhs, const matrix<T>* rhs, size_t n)
+/*
+ * C <- A * B by Strassen-Winograd recursion down to products whose smallest
+ * dimension is at most leaf, see strassen.h. Fewer flops than mat_mul from
+ * about n = 2 leaf on, at the price of a normwise error bound. All
+ * temporaries come from one buffer per call, from the workspace when one is
+ * current. C must not overlap A or B.
+ */
+template<typename T, typename L, typename R>
+void mat_mul_strassen(L const& A, R const& B, matrix_view<T> const& C, size_t leaf = strassen_detail::leaf)
 {
-    matrix<T>* ret = new matrix<T>[2]
+    matrix_view<T const> a = const_view(A);
+    matrix_view<T const> b = const_view(B);
+    if(a.cols() != b.rows() || C.rows() != a.rows() || C.cols() != b.cols())
     {
-        matrix<T>(lhs->col(n)), matrix<T>(rhs->row(n))
-    };
-    
-    return ret;
+        throw std::range_error("mat_mul_strassen: incorrect dimensions.");
+    }
+    strassen_detail::mat_mul(a, b, C, leaf);
 }
 
-template<class T>
-void mat_mul_free_pairs(matrix<T>** tmpl, size_t N)
+// the same with the products of the top levels as tasks on pool
+template<typename T, typename L, typename R>
+void mat_mul_strassen(L const& A, R const& B, matrix_view<T> const& C, tdpool& pool, size_t leaf = strassen_detail::leaf)
 {
-    for(size_t r=0; r < N; r++)
+    matrix_view<T const> a = const_view(A);
+    matrix_view<T const> b = const_view(B);
+    if(a.cols() != b.rows() || C.rows() != a.rows() || C.cols() != b.cols())
     {
-        delete[] tmpl[r];
+        throw std::range_error("mat_mul_strassen: incorrect dimensions.");
     }
-    
-    delete[] tmpl;
+    strassen_detail::mat_mul(a, b, C, leaf, pool);
 }
 
-template<class T>
-matrix<T> mat_mul_alg1(const matrix<T>* lhs, const matrix<T>* rhs, tdpool & pool)
+// A * B as a new row-major matrix
+template<class T, class LL, class LA, class RL, class RA>
+matrix<T> mat_mul_strassen(const matrix<T, LL, LA>& lhs, const matrix<T, RL, RA>& rhs, size_t leaf = strassen_detail::leaf)
 {
-    size_t M = lhs->rows();
-    size_t N = lhs->cols();
-    size_t K = rhs->cols();
-    
-    //tdpool pool(6);
-    std::vector<std::future<matrix<T>>> oprod_results;
-    
-    size_t curr_adds = 0;
-    
-    matrix<T>** curr_oprod_pairs = mat_mul_create_pairs(lhs, rhs);
-    
-    matrix<T> mresult(M, K);
-    
-    for(size_t i = 0; i < N; i++)
-    {
-        oprod_results.emplace_back
-        (
-            pool.enqueue(outer_prod_1D<T>, curr_oprod_pairs[i][0], curr_oprod_pairs[i][1])
-        );
-    }
-    
-    for(; curr_adds < N;)
-    {
-        for(auto&& result : oprod_results)
-        {
-            if(result.valid())
-            {
-                mresult += result.get();
-                curr_adds++;
-            }
-        }
-    }
-    
-    //mat_mul_free_pairs(curr_oprod_pairs, N);
-    return mresult;
+    matrix<T> C(lhs.rows(), rhs.cols());
+    mat_mul_strassen(lhs, rhs, C.view(), leaf);
+    return C;
+}
+
+template<class T, class LL, class LA, class RL, class RA>
+matrix<T> mat_mul_strassen(const matrix<T, LL, LA>& lhs, const matrix<T, RL, RA>& rhs, tdpool& pool, size_t leaf = strassen_detail::leaf)
+{
+    matrix<T> C(lhs.rows(), rhs.cols());
+    mat_mul_strassen(lhs, rhs, C.view(), pool, leaf);
+    return C;
 }
@@ -0,0 +1,374 @@
+//
+//  random_matrix.h
+//  Created by Ben Westcott on 10/17/26.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <future>
+#include <numbers>
+#include <stdexcept>
+#include <tuple>
+#include <vector>
+#include "matrix.h"
+#include "banded_matrix.h"
+#include "householder.h"
+#include "philox.h"
+#include "products.h"
+#include "tdpool.h"
+
+using std::size_t;
+
+/*
+ * Seeded, reproducible random matrices. Element (i, j) is drawn from the
+ * Philox block with counter (j, i, i >> 32, stream) under the seed, so it
+ * does not depend on the order elements are generated in. Rows are drawn
+ * in batches of blocks, which vectorize. Every generator
+ * takes an optional trailing tdpool and fills rows in parallel on it, with
+ * the same result as the serial fill. Each generator draws from its own
+ * stream, e.g. dense() and symmetric() of one seed are independent.
+ *
+ * Columns are limited to 2^32.
+ */
+namespace random_matrix
+{
+
+namespace random_detail
+{
+
+// elements per task, enough to hide the enqueue
+constexpr size_t elems_per_task = 1 << 15;
+
+enum stream : uint32_t
+{
+    dense_stream = 1, normal_stream, symmetric_stream, skew_stream, spd_stream,
+    banded_stream, orthogonal_stream, condition_stream, low_rank_stream
+};
+
+struct element
+{
+    double u;
+    double v;
+};
+
+// two independent uniforms in [0, 1) for element (i, j)
+inline element draw(philox::key const& k, uint32_t s, size_t i, size_t j)
+{
+    philox::counter b = philox::block({static_cast<uint32_t>(j), static_cast<uint32_t>(i), static_cast<uint32_t>(static_cast<uint64_t>(i) >> 32), s}, k);
+    return {philox::unit(b[0], b[1]), philox::unit(b[2], b[3])};
+}
+
+// put(j, draw(k, s, i, j)) for j in [j0, j1), a batch of blocks at a time
+template<typename F>
+void draw_row(philox::key const& k, uint32_t s, size_t i, size_t j0, size_t j1, F const& put)
+{
+    constexpr size_t W = 16;
+    uint32_t b[4][W];
+    double u[W];
+    double v[W];
+
+    for(size_t j=j0; j < j1; j += W)
+    {
+        philox::blocks<W>(static_cast<uint32_t>(j), static_cast<uint32_t>(i), static_cast<uint32_t>(static_cast<uint64_t>(i) >> 32), s, k, b);
+
+        // whole batches convert in vector registers too
+        for(size_t l=0; l < W; l++)
+        {
+            u[l] = philox::unit(b[0][l], b[1][l]);
+            v[l] = philox::unit(b[2][l], b[3][l]);
+        }
+
+        size_t n = std::min(W, j1 - j);
+        for(size_t l=0; l < n; l++)
+        {
+            put(j + l, element{u[l], v[l]});
+        }
+    }
+}
+
+// standard normal by Box-Muller, 1 - u keeps the log finite
+inline double gaussian(element e)
+{
+    return std::sqrt(-2.0 * std::log(1.0 - e.u)) * std::cos(2.0 * std::numbers::pi * e.v);
+}
+
+// calls f(rb, re) over row blocks of about elems_per_task elements, on pool if given
+template<typename F, typename... Pool>
+void for_rows(size_t rows, size_t cols, F const& f, Pool&... pool)
+{
+    static_assert(sizeof...(Pool) <= 1, "for_rows: at most one pool.");
+
+    if constexpr(sizeof...(Pool) == 0)
+    {
+        f(0, rows);
+    }
+    else
+    {
+        tdpool& p = std::get<0>(std::tie(pool...));
+        size_t step = std::max<size_t>(1, elems_per_task/std::max<size_t>(1, cols));
+        std::vector<std::future<void>> results;
+
+        for(size_t rb=0; rb < rows; rb += step)
+        {
+            size_t re = std::min(rows, rb + step);
+            results.emplace_back(p.enqueue([=, &f]() { f(rb, re); }));
+        }
+
+        for(auto& r : results)
+        {
+            r.get();
+        }
+    }
+}
+
+// A(i, j) = f(i, j, draw(k, s, i, j)) over the whole matrix
+template<typename T, typename F, typename... Pool>
+void generate(matrix<T>& A, philox::key const& k, uint32_t s, F const& f, Pool&... pool)
+{
+    T* dat = A.data();
+    size_t ld = A.stride();
+
+    for_rows(A.rows(), A.cols(), [&](size_t rb, size_t re)
+    {
+        for(size_t i=rb; i < re; i++)
+        {
+            T* row = dat + i * ld;
+            draw_row(k, s, i, 0, A.cols(), [&](size_t j, element e) { row[j] = static_cast<T>(f(i, j, e)); });
+        }
+    }, pool...);
+}
+
+/*
+ * The same for the upper triangle of square A, which is then mirrored:
+ * A(j, i) = sign * A(i, j). Element (i, j), i <= j, is draw(k, s, i, j).
+ */
+template<typename T, typename F, typename... Pool>
+void generate_upper(matrix<T>& A, philox::key const& k, uint32_t s, T sign, F const& f, Pool&... pool)
+{
+    T* dat = A.data();
+    size_t ld = A.stride();
+    size_t N = A.rows();
+
+    for_rows(N, N, [&](size_t rb, size_t re)
+    {
+        for(size_t i=rb; i < re; i++)
+        {
+            T* row = dat + i * ld;
+            draw_row(k, s, i, i, N, [&](size_t j, element e) { row[j] = static_cast<T>(f(i, j, e)); });
+        }
+    }, pool...);
+
+    // all of the upper triangle is done before any of it is read
+    for_rows(N, N, [&](size_t rb, size_t re)
+    {
+        for(size_t i=rb; i < re; i++)
+        {
+            for(size_t j=0; j < i; j++)
+            {
+                dat[i * ld + j] = sign * dat[j * ld + i];
+            }
+        }
+    }, pool...);
+}
+
+// L * R, on pool if given
+template<typename... Pool>
+matrix<double> product(matrix<double> const& L, matrix<double> const& R, Pool&... pool)
+{
+    if constexpr(sizeof...(Pool) == 1)
+    {
+        return mat_mul_alg1(&L, &R, pool...);
+    }
+    else
+    {
+        matrix<double> res(L.rows(), R.cols());
+        for(size_t i=0; i < L.rows(); i++)
+        {
+            for(size_t k=0; k < L.cols(); k++)
+            {
+                double l = L(i, k);
+                for(size_t j=0; j < R.cols(); j++)
+                {
+                    res(i, j) += l * R(k, j);
+                }
+            }
+        }
+        return res;
+    }
+}
+
+}
+
+// M x N, uniform in [lo, hi)
+template<typename T, typename... Pool>
+matrix<T> dense(size_t M, size_t N, double lo, double hi, uint64_t seed, Pool&... pool)
+{
+    using namespace random_detail;
+
+    philox::key k = philox::make_key(seed);
+    matrix<T> A(M, N);
+    generate(A, k, dense_stream, [&](size_t, size_t, element e) { return lo + (hi - lo) * e.u; }, pool...);
+    return A;
+}
+
+// M x N, standard normal
+template<typename T, typename... Pool>
+matrix<T> normal(size_t M, size_t N, uint64_t seed, Pool&... pool)
+{
+    using namespace random_detail;
+
+    philox::key k = philox::make_key(seed);
+    matrix<T> A(M, N);
+    generate(A, k, normal_stream, [](size_t, size_t, element e) { return gaussian(e); }, pool...);
+    return A;
+}
+
+// N x N symmetric, uniform in [lo, hi)
+template<typename T, typename... Pool>
+matrix<T> symmetric(size_t N, double lo, double hi, uint64_t seed, Pool&... pool)
+{
+    using namespace random_detail;
+
+    philox::key k = philox::make_key(seed);
+    matrix<T> A(N, N);
+    generate_upper(A, k, symmetric_stream, static_cast<T>(1), [&](size_t, size_t, element e) { return lo + (hi - lo) * e.u; }, pool...);
+    return A;
+}
+
+// N x N skew-symmetric, the upper triangle uniform in [lo, hi)
+template<typename T, typename... Pool>
+matrix<T> skew_symmetric(size_t N, double lo, double hi, uint64_t seed, Pool&... pool)
+{
+    using namespace random_detail;
+
+    philox::key k = philox::make_key(seed);
+    matrix<T> A(N, N);
+    generate_upper(A, k, skew_stream, static_cast<T>(-1), [&](size_t i, size_t j, element e)
+    {
+        return (i == j) ? 0.0 : lo + (hi - lo) * e.u;
+    }, pool...);
+    return A;
+}
+
+/*
+ * N x N symmetric positive definite: off diagonal elements uniform in
+ * (-1, 1) and a diagonal in [N, N + 1), so it is strictly diagonally
+ * dominant. Its condition number stays small, use with_condition() for
+ * harder ones.
+ */
+template<typename T, typename... Pool>
+matrix<T> spd(size_t N, uint64_t seed, Pool&... pool)
+{
+    using namespace random_detail;
+
+    philox::key k = philox::make_key(seed);
+    matrix<T> A(N, N);
+    generate_upper(A, k, spd_stream, static_cast<T>(1), [&](size_t i, size_t j, element e)
+    {
+        return (i == j) ? static_cast<double>(N) + e.u : 2.0 * e.u - 1.0;
+    }, pool...);
+    return A;
+}
+
+// n x n with kl sub- and ku superdiagonals, uniform in [lo, hi)
+template<typename T, typename... Pool>
+banded_matrix<T> banded(size_t n, size_t kl, size_t ku, double lo, double hi, uint64_t seed, Pool&... pool)
+{
+    using namespace random_detail;
+
+    philox::key k = philox::make_key(seed);
+    banded_matrix<T> A(n, kl, ku);
+    for_rows(n, kl + ku + 1, [&](size_t rb, size_t re)
+    {
+        for(size_t i=rb; i < re; i++)
+        {
+            size_t j0 = A.first_col(i);
+            T* row = &A(i, j0);
+            draw_row(k, banded_stream, i, j0, A.last_col(i), [&](size_t j, element e)
+            {
+                row[j - j0] = static_cast<T>(lo + (hi - lo) * e.u);
+            });
+        }
+    }, pool...);
+    return A;
+}
+
+/*
+ * N x N orthogonal, Haar distributed: Q of the QR factorization of a
+ * normal matrix, with the signs of R's diagonal moved into Q so they
+ * don't bias it (Mezzadri, "How to generate random matrices from the
+ * classical compact groups"). Only the normal matrix is generated on pool,
+ * the QR is serial.
+ */
+template<typename... Pool>
+matrix<double> orthogonal(size_t N, uint64_t seed, Pool&... pool)
+{
+    using namespace random_detail;
+
+    philox::key k = philox::make_key(seed);
+    matrix<double> G(N, N);
+    generate(G, k, orthogonal_stream, [](size_t, size_t, element e) { return gaussian(e); }, pool...);
+
+    auto F = transformation::house::QR(G);
+    for(size_t j=0; j < N; j++)
+    {
+        if(F.Y(j, j) < 0.0)
+        {
+            F.Q.col_view(j) *= -1.0;
+        }
+    }
+    return F.Q;
+}
+
+// M x N of the given rank, the product of normal M x rank and rank x N factors
+template<typename... Pool>
+matrix<double> low_rank(size_t M, size_t N, size_t rank, uint64_t seed, Pool&... pool)
+{
+    using namespace random_detail;
+
+    if(!rank || rank > std::min(M, N))
+    {
+        throw std::range_error("low_rank: rank must be in [1, min(M, N)].");
+    }
+
+    philox::key k = philox::make_key(seed);
+    matrix<double> U(M, rank);
+    matrix<double> V(rank, N);
+
+    // the factors from streams of their own
+    generate(U, k, low_rank_stream, [](size_t, size_t, element e) { return gaussian(e); }, pool...);
+    generate(V, k, low_rank_stream + 1, [](size_t, size_t, element e) { return gaussian(e); }, pool...);
+
+    return product(U, V, pool...);
+}
+
+/*
+ * N x N with 2-norm condition number cond: U diag(s) V for Haar orthogonal
+ * U and V, and singular values s falling geometrically from 1 to 1/cond.
+ */
+template<typename... Pool>
+matrix<double> with_condition(size_t N, double cond, uint64_t seed, Pool&... pool)
+{
+    if(cond < 1.0)
+    {
+        throw std::range_error("with_condition: condition number must be at least 1.");
+    }
+
+    // seeds of their own for the two factors, derived through the condition stream
+    philox::counter b = philox::block({0, 0, 0, random_detail::condition_stream}, philox::make_key(seed));
+    matrix<double> U = orthogonal(N, (static_cast<uint64_t>(b[0]) << 32) | b[1], pool...);
+    matrix<double> V = orthogonal(N, (static_cast<uint64_t>(b[2]) << 32) | b[3], pool...);
+
+    for(size_t j=0; j < N; j++)
+    {
+        double s = (N > 1) ? std::pow(cond, -static_cast<double>(j)/(N - 1)) : 1.0;
+        U.col_view(j) *= s;
+    }
+
+    return random_detail::product(U, V, pool...);
+}
+
+}
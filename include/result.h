@@ -6,6 +6,8 @@
 #pragma once
 
 #include "matrix.h"
+#include "fixed_matrix.h"
+#include "triangular_matrix.h"
 
 namespace result
 {
@@ -35,6 +37,34 @@ using QL = QY<T>;
 template<typename T>
 using LQ = QY<T>;
 
+template<typename T>
+using RQ = QY<T>;
+
+// QR of an M x N (M >= N) matrix with R packed, i.e. only the upper
+// triangle of the N x N block which is not identically zero
+template<typename T>
+struct QRp
+{
+    matrix<T> Q;
+    triangular_matrix<T> R;
+    
+    QRp(void) = default;
+    
+    QRp(matrix<T> const& q, triangular_matrix<T> const& r)
+    : Q(q), R(r) {}
+};
+
+// QY for fixed size M x N problems, held inline
+template<typename T, size_t M, size_t N>
+struct fixed_QY
+{
+    fixed_matrix<T, M, M> Q;
+    fixed_matrix<T, M, N> Y;
+};
+
+template<typename T, size_t M, size_t N>
+using fixed_QR = fixed_QY<T, M, N>;
+
 // used to return a solution where:
 // Q is orthogonal
 // H is hessenberg
@@ -0,0 +1,401 @@
+//
+//  simd_kernels.h
+//  Created by Ben Westcott on 10/17/26.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+using std::size_t;
+
+/*
+ * Elementwise kernels over contiguous runs of elements, used by the
+ * matrix<T> members which walk whole storage lines (fill, +=, -=, *=, abs,
+ * absdiff, content_equals).
+ *
+ * The loops are written once on GCC/Clang vector types of W bytes and
+ * instantiated for SSE2 (16), AVX2 (32) and AVX-512 (64, F/BW/DQ/VL as on
+ * every AVX-512 server part, the comparisons need DQ) through target
+ * attributes, so a default (SSE2) build still runs the wide versions on a
+ * CPU that has them. The widest supported set is picked at first use and can
+ * be lowered with simd::set_isa, e.g. to compare them. Element types other
+ * than float, double and the integers, and compilers/targets without the
+ * GNU vector extensions, take the scalar loops.
+ */
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define LINALG_SIMD_X86 1
+#else
+#define LINALG_SIMD_X86 0
+#endif
+
+namespace simd
+{
+
+enum class isa { scalar, sse2, avx2, avx512 };
+
+inline isa detected_isa(void)
+{
+    static isa const detected = []()
+    {
+#if LINALG_SIMD_X86
+        __builtin_cpu_init();
+        if(__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw") && __builtin_cpu_supports("avx512dq") && __builtin_cpu_supports("avx512vl"))
+        {
+            return isa::avx512;
+        }
+        if(__builtin_cpu_supports("avx2"))
+        {
+            return isa::avx2;
+        }
+        if(__builtin_cpu_supports("sse2"))
+        {
+            return isa::sse2;
+        }
+#endif
+        return isa::scalar;
+    }();
+
+    return detected;
+}
+
+namespace detail
+{
+
+inline std::atomic<isa>& active(void)
+{
+    static std::atomic<isa> level(detected_isa());
+    return level;
+}
+
+}
+
+inline isa active_isa(void)
+{
+    return detail::active().load(std::memory_order_relaxed);
+}
+
+// selects level, or the best detected one below it, returns the previous
+inline isa set_isa(isa level)
+{
+    return detail::active().exchange(std::min(level, detected_isa()), std::memory_order_relaxed);
+}
+
+inline char const* isa_name(isa level)
+{
+    switch(level)
+    {
+        case isa::avx512: return "avx512";
+        case isa::avx2: return "avx2";
+        case isa::sse2: return "sse2";
+        default: return "scalar";
+    }
+}
+
+template<typename T>
+concept vectorizable = (std::is_integral_v<T> && !std::is_same_v<T, bool>) || std::is_same_v<T, float> || std::is_same_v<T, double>;
+
+namespace detail
+{
+
+enum class op { fill, add, sub, scale, abs, absdiff };
+
+template<op O>
+constexpr bool reads_b = (O == op::add || O == op::sub || O == op::absdiff);
+
+template<op O, typename T>
+inline T scalar_op(T x, T y)
+{
+    if constexpr(O == op::add)
+    {
+        return x + y;
+    }
+    else if constexpr(O == op::sub)
+    {
+        return x - y;
+    }
+    else if constexpr(O == op::scale)
+    {
+        return x * y;
+    }
+    else if constexpr(O == op::abs)
+    {
+        if constexpr(std::is_unsigned_v<T>)
+        {
+            return x;
+        }
+        else
+        {
+            return std::abs(x);
+        }
+    }
+    else if constexpr(O == op::absdiff)
+    {
+        return (x < y) ? y - x : x - y;
+    }
+    else
+    {
+        return y;
+    }
+}
+
+// dst[i] = a[i] op b[i] (or op s), b and s are only read by the ops that need them
+template<op O, typename T>
+void map_scalar(T* dst, T const* a, T const* b, T s, size_t n)
+{
+    for(size_t i=0; i < n; i++)
+    {
+        T x = (O == op::fill) ? s : a[i];
+        dst[i] = scalar_op<O>(x, reads_b<O> ? b[i] : s);
+    }
+}
+
+template<typename T>
+bool equal_scalar(T const* a, T const* b, size_t n)
+{
+    for(size_t i=0; i < n; i++)
+    {
+        if(a[i] != b[i])
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+#if LINALG_SIMD_X86
+
+/*
+ * The vector loops. Loads and stores go through memcpy since nothing is
+ * aligned to W in general, and vectors never cross a call boundary, so they
+ * compile to plain unaligned moves at the ISA of the (target attributed)
+ * caller they are inlined into.
+ */
+template<size_t W, op O, typename T>
+[[gnu::always_inline]] inline void map_vec(T* dst, T const* a, T const* b, T s, size_t n)
+{
+    typedef T vec __attribute__((vector_size(W)));
+    typedef std::conditional_t<sizeof(T) == 4, int32_t, int64_t> ivec_elem;
+    typedef ivec_elem ivec __attribute__((vector_size(W)));
+
+    constexpr size_t L = W/sizeof(T);
+
+    vec vs = vec{} + s;
+
+    size_t i=0;
+    for(; i + L <= n; i += L)
+    {
+        vec x, y = vs, z;
+        if constexpr(O != op::fill)
+        {
+            __builtin_memcpy(&x, a + i, W);
+        }
+        if constexpr(reads_b<O>)
+        {
+            __builtin_memcpy(&y, b + i, W);
+        }
+
+        if constexpr(O == op::add)
+        {
+            z = x + y;
+        }
+        else if constexpr(O == op::sub)
+        {
+            z = x - y;
+        }
+        else if constexpr(O == op::scale)
+        {
+            z = x * y;
+        }
+        else if constexpr(O == op::abs && std::is_floating_point_v<T>)
+        {
+            // clear the sign bit, like std::abs for -0.0 and NaN
+            ivec bits;
+            __builtin_memcpy(&bits, &x, W);
+            bits &= ~(ivec{} + (ivec_elem(1) << (8 * sizeof(T) - 1)));
+            __builtin_memcpy(&z, &bits, W);
+        }
+        else if constexpr(O == op::abs && std::is_unsigned_v<T>)
+        {
+            z = x;
+        }
+        else if constexpr(O == op::abs)
+        {
+            z = (x < 0) ? -x : x;
+        }
+        else if constexpr(O == op::absdiff)
+        {
+            z = (x < y) ? y - x : x - y;
+        }
+        else
+        {
+            z = y;
+        }
+
+        __builtin_memcpy(dst + i, &z, W);
+    }
+
+    map_scalar<O>(dst + i, a + i, b + i, s, n - i);
+}
+
+// compares a group of vectors at a time, so the early exit costs one test per group
+template<size_t W, typename T>
+[[gnu::always_inline]] inline bool equal_vec(T const* a, T const* b, size_t n)
+{
+    typedef T vec __attribute__((vector_size(W)));
+
+    constexpr size_t L = W/sizeof(T);
+    constexpr size_t G = 4;
+
+    size_t i=0;
+    for(; i + G * L <= n; i += G * L)
+    {
+        decltype(vec{} != vec{}) ne{};
+        for(size_t g=0; g < G; g++)
+        {
+            vec x, y;
+            __builtin_memcpy(&x, a + i + g * L, W);
+            __builtin_memcpy(&y, b + i + g * L, W);
+            ne |= (x != y);
+        }
+
+        // horizontal or over plain words, lane extraction is slow on the mask registers
+        uint64_t words[W/8];
+        __builtin_memcpy(words, &ne, W);
+        uint64_t any = 0;
+        for(size_t k=0; k < W/8; k++)
+        {
+            any |= words[k];
+        }
+        if(any)
+        {
+            return false;
+        }
+    }
+
+    return equal_scalar(a + i, b + i, n - i);
+}
+
+/*
+ * GCC scalarizes comparisons on 512 bit generic vectors unless AVX-512 is
+ * enabled for the whole translation unit, so the kernels which compare run
+ * 256 bits wide in the avx512 set of a default build.
+ */
+#if defined(__AVX512F__) && defined(__AVX512DQ__)
+constexpr size_t avx512_compare_width = 64;
+#else
+constexpr size_t avx512_compare_width = 32;
+#endif
+
+template<op O, typename T>
+constexpr bool compares = (O == op::absdiff) || (O == op::abs && std::is_integral_v<T> && std::is_signed_v<T>);
+
+template<op O, typename T>
+[[gnu::target("sse2")]] void map_sse2(T* dst, T const* a, T const* b, T s, size_t n) { map_vec<16, O>(dst, a, b, s, n); }
+
+template<op O, typename T>
+[[gnu::target("avx2")]] void map_avx2(T* dst, T const* a, T const* b, T s, size_t n) { map_vec<32, O>(dst, a, b, s, n); }
+
+template<op O, typename T>
+[[gnu::target("avx512f,avx512bw,avx512dq,avx512vl")]] void map_avx512(T* dst, T const* a, T const* b, T s, size_t n)
+{
+    map_vec<compares<O, T> ? avx512_compare_width : 64, O>(dst, a, b, s, n);
+}
+
+template<typename T>
+[[gnu::target("sse2")]] bool equal_sse2(T const* a, T const* b, size_t n) { return equal_vec<16>(a, b, n); }
+
+template<typename T>
+[[gnu::target("avx2")]] bool equal_avx2(T const* a, T const* b, size_t n) { return equal_vec<32>(a, b, n); }
+
+template<typename T>
+[[gnu::target("avx512f,avx512bw,avx512dq,avx512vl")]] bool equal_avx512(T const* a, T const* b, size_t n) { return equal_vec<avx512_compare_width>(a, b, n); }
+
+#endif
+
+template<op O, typename T>
+void map(T* dst, T const* a, T const* b, T s, size_t n)
+{
+#if LINALG_SIMD_X86
+    if constexpr(vectorizable<T>)
+    {
+        switch(active_isa())
+        {
+            case isa::avx512: return map_avx512<O>(dst, a, b, s, n);
+            case isa::avx2: return map_avx2<O>(dst, a, b, s, n);
+            case isa::sse2: return map_sse2<O>(dst, a, b, s, n);
+            default: break;
+        }
+    }
+#endif
+    map_scalar<O>(dst, a, b, s, n);
+}
+
+}
+
+template<typename T>
+void fill(T* dst, size_t n, T value)
+{
+    detail::map<detail::op::fill>(dst, dst, dst, value, n);
+}
+
+// dst += src
+template<typename T>
+void add(T* dst, T const* src, size_t n)
+{
+    detail::map<detail::op::add>(dst, dst, src, T(), n);
+}
+
+// dst -= src
+template<typename T>
+void sub(T* dst, T const* src, size_t n)
+{
+    detail::map<detail::op::sub>(dst, dst, src, T(), n);
+}
+
+// dst *= factor
+template<typename T>
+void scale(T* dst, size_t n, T factor)
+{
+    detail::map<detail::op::scale>(dst, dst, dst, factor, n);
+}
+
+// dst = |src|
+template<typename T>
+void abs(T* dst, T const* src, size_t n)
+{
+    detail::map<detail::op::abs>(dst, src, src, T(), n);
+}
+
+// dst = |a - b|
+template<typename T>
+void absdiff(T* dst, T const* a, T const* b, size_t n)
+{
+    detail::map<detail::op::absdiff>(dst, a, b, T(), n);
+}
+
+template<typename T>
+bool equal(T const* a, T const* b, size_t n)
+{
+#if LINALG_SIMD_X86
+    if constexpr(vectorizable<T>)
+    {
+        switch(active_isa())
+        {
+            case isa::avx512: return detail::equal_avx512(a, b, n);
+            case isa::avx2: return detail::equal_avx2(a, b, n);
+            case isa::sse2: return detail::equal_sse2(a, b, n);
+            default: break;
+        }
+    }
+#endif
+    return detail::equal_scalar(a, b, n);
+}
+
+}
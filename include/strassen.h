@@ -0,0 +1,366 @@
+//
+//  strassen.h
+//  Created by Ben Westcott on 10/17/26.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <future>
+#include <vector>
+#include "matrix.h"
+#include "matrix_view.h"
+#include "matrix_expr.h"
+#include "gemm.h"
+#include "tdpool.h"
+#include "workspace.h"
+
+using std::size_t;
+
+/*
+ * Strassen-Winograd recursion for C <- A * B (Winograd's variant of
+ * Strassen's algorithm: 7 half size products and 15 additions per level).
+ * With the halves of A, B and C
+ *
+ *      S1 = A21 + A22   S2 = S1 - A11   S3 = A11 - A21   S4 = A12 - S2
+ *      T1 = B12 - B11   T2 = B22 - T1   T3 = B22 - B12   T4 = T2 - B21
+ *
+ *      P1 = A11 B11   P2 = A12 B21   P3 = S4 B22   P4 = A22 T4
+ *      P5 = S1 T1     P6 = S2 T2     P7 = S3 T3
+ *
+ *      U2 = P1 + P6   U3 = U2 + P7   U4 = U2 + P5
+ *      C11 = P1 + P2   C12 = U4 + P3   C21 = U3 - P4   C22 = U3 + P5
+ *
+ * Each level saves 1/8 of the multiplications. The recursion stops once
+ * the smallest of M, K, N is at most the leaf size, and those products go
+ * to the blocked kernel of gemm.h. Odd sizes are handled by peeling: the
+ * even leading part recurses, the last row, column or rank-1 term is a
+ * thin product of its own.
+ *
+ * On one thread the products run in the order of Boyer et al. ("Memory
+ * efficient scheduling of Strassen-Winograd's matrix multiplication
+ * algorithm", 2009). The quadrants of C hold intermediate results, so a
+ * level needs only two temporaries, M/2 x max(K, N)/2 and K/2 x N/2.
+ *
+ * On a pool the top level (the top two levels for more than 7 workers)
+ * keeps all of S, T and three of the products in temporaries. That way its
+ * 7 (or 49) products are independent tasks, each running the serial
+ * recursion. Every temporary of every level is carved from one buffer,
+ * allocated once per call.
+ *
+ * The error bound is normwise, |C - C'| <= c(n) u |A| |B|, rather than
+ * the componentwise bound of the classical product. c(n) grows by a
+ * constant factor per level (see Higham, "Accuracy and stability of
+ * numerical algorithms", ch. 23), so entries of C much smaller than
+ * |A| |B| can lose relative accuracy. The larger the leaf, the fewer the
+ * levels and the smaller the added error.
+ */
+namespace strassen_detail
+{
+
+/*
+ * Default leaf size. Below it the additions, which only run at memory
+ * speed, cost about as much as the multiplication they save.
+ */
+constexpr size_t leaf = 1024;
+
+inline bool recurse(size_t m, size_t k, size_t n, size_t leaf)
+{
+    return std::min({m, k, n}) > std::max<size_t>(leaf, 1);
+}
+
+// levels of recursion for an M x K times K x N product
+inline size_t levels(size_t m, size_t k, size_t n, size_t leaf)
+{
+    size_t l = 0;
+    for(; recurse(m, k, n, leaf); m /= 2, k /= 2, n /= 2)
+    {
+        l++;
+    }
+    return l;
+}
+
+// scratch elements the serial recursion needs, two temporaries per level
+inline size_t serial_scratch(size_t m, size_t k, size_t n, size_t leaf)
+{
+    size_t size = 0;
+    for(; recurse(m, k, n, leaf); m /= 2, k /= 2, n /= 2)
+    {
+        size += (m/2) * std::max(k/2, n/2) + (k/2) * (n/2);
+    }
+    return size;
+}
+
+// the same for parallel levels on top, each holding S1..4, T1..4, P1, P2, P4
+inline size_t parallel_scratch(size_t m, size_t k, size_t n, size_t leaf, size_t depth)
+{
+    if(!depth || !recurse(m, k, n, leaf))
+    {
+        return serial_scratch(m, k, n, leaf);
+    }
+    size_t m2 = m/2, k2 = k/2, n2 = n/2;
+    return 4 * m2 * k2 + 4 * k2 * n2 + 3 * m2 * n2 + 7 * parallel_scratch(m2, k2, n2, leaf, depth - 1);
+}
+
+// a rows x cols row-major temporary at p, advancing p past it
+template<typename T>
+matrix_view<T> take(T*& p, size_t rows, size_t cols)
+{
+    matrix_view<T> v(p, rows, cols, cols);
+    p += rows * cols;
+    return v;
+}
+
+template<typename V>
+V quadrant(V const& X, size_t i, size_t j)
+{
+    size_t r2 = X.rows()/2;
+    size_t c2 = X.cols()/2;
+    return X.sub_matrix(i * r2, r2, j * c2, c2);
+}
+
+/*
+ * The products the even leading part of C = A B leaves out, when a size is
+ * odd: the rank-1 term of the last column of A and row of B, the last
+ * column of C and the last row of C.
+ */
+template<typename T, typename... Pool>
+void peel(matrix_view<T const> const& A, matrix_view<T const> const& B, matrix_view<T> const& C, Pool&... pool)
+{
+    size_t m = C.rows(), k = A.cols(), n = C.cols();
+    size_t m2 = m & ~size_t(1), k2 = k & ~size_t(1), n2 = n & ~size_t(1);
+    T one = static_cast<T>(1);
+
+    if(k2 != k)
+    {
+        gemm_detail::mat_mul(one, A.sub_matrix(0, m2, k2, 1), B.sub_matrix(k2, 1, 0, n2), one, C.sub_matrix(0, m2, 0, n2), pool...);
+    }
+    if(n2 != n)
+    {
+        gemm_detail::mat_mul(one, A, B.sub_matrix(0, k, n2, 1), static_cast<T>(0), C.sub_matrix(0, m, n2, 1), pool...);
+    }
+    if(m2 != m)
+    {
+        gemm_detail::mat_mul(one, A.sub_matrix(m2, 1, 0, k), B.sub_matrix(0, k, 0, n2), static_cast<T>(0), C.sub_matrix(m2, 1, 0, n2), pool...);
+    }
+}
+
+// C <- A B on the calling thread, scratch holding serial_scratch() elements
+template<typename T>
+void serial(matrix_view<T const> const& A, matrix_view<T const> const& B, matrix_view<T> const& C, size_t leaf, T* scratch)
+{
+    size_t m = C.rows(), k = A.cols(), n = C.cols();
+    if(!recurse(m, k, n, leaf))
+    {
+        gemm_detail::mat_mul(static_cast<T>(1), A, B, static_cast<T>(0), C);
+        return;
+    }
+
+    size_t m2 = m/2, k2 = k/2, n2 = n/2;
+    matrix_view<T const> Ae = A.sub_matrix(0, 2 * m2, 0, 2 * k2);
+    matrix_view<T const> Be = B.sub_matrix(0, 2 * k2, 0, 2 * n2);
+    matrix_view<T> Ce = C.sub_matrix(0, 2 * m2, 0, 2 * n2);
+
+    auto A11 = quadrant(Ae, 0, 0), A12 = quadrant(Ae, 0, 1), A21 = quadrant(Ae, 1, 0), A22 = quadrant(Ae, 1, 1);
+    auto B11 = quadrant(Be, 0, 0), B12 = quadrant(Be, 0, 1), B21 = quadrant(Be, 1, 0), B22 = quadrant(Be, 1, 1);
+    auto C11 = quadrant(Ce, 0, 0), C12 = quadrant(Ce, 0, 1), C21 = quadrant(Ce, 1, 0), C22 = quadrant(Ce, 1, 1);
+
+    // X holds the S in turn and then P1, Y the T
+    matrix_view<T> X(scratch, m2, k2, k2);
+    matrix_view<T> P1(scratch, m2, n2, n2);
+    T* p = scratch + m2 * std::max(k2, n2);
+    matrix_view<T> Y = take(p, k2, n2);
+
+    X.assign(A11 - A21);
+    Y.assign(B22 - B12);
+    serial<T>(X, Y, C21, leaf, p);      // P7
+    X.assign(A21 + A22);
+    Y.assign(B12 - B11);
+    serial<T>(X, Y, C22, leaf, p);      // P5
+    X -= A11;
+    Y.assign(B22 - Y);
+    serial<T>(X, Y, C12, leaf, p);      // P6
+    X.assign(A12 - X);
+    Y -= B21;
+    serial<T>(X, B22, C11, leaf, p);    // P3
+    serial<T>(A11, B11, P1, leaf, p);
+
+    C12 += P1;      // U2
+    C21 += C12;     // U3
+    C12 += C22;     // U4
+    C22 += C21;     // U7 = C22
+    C12 += C11;     // U5 = C12
+    serial<T>(A22, Y, C11, leaf, p);    // P4
+    C21 -= C11;     // U6 = C21
+    serial<T>(A12, B21, C11, leaf, p);  // P2
+    C11 += P1;      // U1 = C11
+
+    peel(A, B, C);
+}
+
+// rows [r0, r1) of X
+template<typename V>
+V rows(V const& X, size_t r0, size_t r1)
+{
+    return X.sub_matrix(r0, r1 - r0, 0, X.cols());
+}
+
+// f(r0, r1) for a block of [0, n) per worker of pool, for the additions of the parallel levels
+template<typename F>
+void by_rows(size_t n, tdpool& pool, F const& f)
+{
+    size_t workers = std::max<size_t>(pool.size(), 1);
+    std::vector<std::future<void>> results;
+    for(size_t w=0; w < workers; w++)
+    {
+        results.emplace_back(pool.enqueue(f, n * w/workers, n * (w + 1)/workers));
+    }
+    for(auto& r : results)
+    {
+        r.get();
+    }
+}
+
+// a product left for a task, and the scratch of its serial recursion
+template<typename T>
+struct task
+{
+    matrix_view<T const> A;
+    matrix_view<T const> B;
+    matrix_view<T> C;
+    T* scratch;
+};
+
+// a parallel level, to be combined once the products below it are done
+template<typename T>
+struct level
+{
+    matrix_view<T const> A;
+    matrix_view<T const> B;
+    matrix_view<T> C;
+    matrix_view<T> P1;
+    matrix_view<T> P2;
+    matrix_view<T> P4;
+};
+
+/*
+ * Forms S and T of depth levels below C = A B and collects their products
+ * as tasks, levels in the order parents first. P3, P5, P6 and P7 go
+ * straight to the quadrants of C like in serial().
+ */
+template<typename T>
+void expand(matrix_view<T const> const& A, matrix_view<T const> const& B, matrix_view<T> const& C, size_t leaf, size_t depth,
+            T*& p, std::vector<level<T>>& levels, std::vector<task<T>>& tasks, tdpool& pool)
+{
+    size_t m = C.rows(), k = A.cols(), n = C.cols();
+    if(!depth || !recurse(m, k, n, leaf))
+    {
+        tasks.push_back({A, B, C, p});
+        p += serial_scratch(m, k, n, leaf);
+        return;
+    }
+
+    size_t m2 = m/2, k2 = k/2, n2 = n/2;
+    matrix_view<T const> Ae = A.sub_matrix(0, 2 * m2, 0, 2 * k2);
+    matrix_view<T const> Be = B.sub_matrix(0, 2 * k2, 0, 2 * n2);
+    matrix_view<T> Ce = C.sub_matrix(0, 2 * m2, 0, 2 * n2);
+
+    auto A11 = quadrant(Ae, 0, 0), A12 = quadrant(Ae, 0, 1), A21 = quadrant(Ae, 1, 0), A22 = quadrant(Ae, 1, 1);
+    auto B11 = quadrant(Be, 0, 0), B12 = quadrant(Be, 0, 1), B21 = quadrant(Be, 1, 0), B22 = quadrant(Be, 1, 1);
+
+    matrix_view<T> S1 = take(p, m2, k2), S2 = take(p, m2, k2), S3 = take(p, m2, k2), S4 = take(p, m2, k2);
+    matrix_view<T> T1 = take(p, k2, n2), T2 = take(p, k2, n2), T3 = take(p, k2, n2), T4 = take(p, k2, n2);
+
+    by_rows(m2, pool, [&](size_t r0, size_t r1)
+    {
+        rows(S1, r0, r1).assign(rows(A21, r0, r1) + rows(A22, r0, r1));
+        rows(S2, r0, r1).assign(rows(S1, r0, r1) - rows(A11, r0, r1));
+        rows(S3, r0, r1).assign(rows(A11, r0, r1) - rows(A21, r0, r1));
+        rows(S4, r0, r1).assign(rows(A12, r0, r1) - rows(S2, r0, r1));
+    });
+    by_rows(k2, pool, [&](size_t r0, size_t r1)
+    {
+        rows(T1, r0, r1).assign(rows(B12, r0, r1) - rows(B11, r0, r1));
+        rows(T2, r0, r1).assign(rows(B22, r0, r1) - rows(T1, r0, r1));
+        rows(T3, r0, r1).assign(rows(B22, r0, r1) - rows(B12, r0, r1));
+        rows(T4, r0, r1).assign(rows(T2, r0, r1) - rows(B21, r0, r1));
+    });
+
+    level<T> lv{A, B, C, take(p, m2, n2), take(p, m2, n2), take(p, m2, n2)};
+    levels.push_back(lv);
+
+    expand<T>(A11, B11, lv.P1, leaf, depth - 1, p, levels, tasks, pool);
+    expand<T>(A12, B21, lv.P2, leaf, depth - 1, p, levels, tasks, pool);
+    expand<T>(S4, B22, quadrant(Ce, 0, 0), leaf, depth - 1, p, levels, tasks, pool);
+    expand<T>(A22, T4, lv.P4, leaf, depth - 1, p, levels, tasks, pool);
+    expand<T>(S1, T1, quadrant(Ce, 1, 1), leaf, depth - 1, p, levels, tasks, pool);
+    expand<T>(S2, T2, quadrant(Ce, 0, 1), leaf, depth - 1, p, levels, tasks, pool);
+    expand<T>(S3, T3, quadrant(Ce, 1, 0), leaf, depth - 1, p, levels, tasks, pool);
+}
+
+// the U of serial(), for a block of rows of the quadrants at a time
+template<typename T>
+void combine(level<T> const& lv, tdpool& pool)
+{
+    matrix_view<T> Ce = lv.C.sub_matrix(0, 2 * lv.P1.rows(), 0, 2 * lv.P1.cols());
+    auto C11 = quadrant(Ce, 0, 0), C12 = quadrant(Ce, 0, 1), C21 = quadrant(Ce, 1, 0), C22 = quadrant(Ce, 1, 1);
+
+    by_rows(lv.P1.rows(), pool, [&](size_t r0, size_t r1)
+    {
+        rows(C12, r0, r1) += rows(lv.P1, r0, r1);
+        rows(C21, r0, r1) += rows(C12, r0, r1);
+        rows(C12, r0, r1) += rows(C22, r0, r1);
+        rows(C22, r0, r1) += rows(C21, r0, r1);
+        rows(C12, r0, r1) += rows(C11, r0, r1);
+        rows(C21, r0, r1) -= rows(lv.P4, r0, r1);
+        rows(C11, r0, r1).assign(rows(lv.P1, r0, r1) + rows(lv.P2, r0, r1));
+    });
+
+    peel(lv.A, lv.B, lv.C, pool);
+}
+
+template<typename T>
+void mat_mul(matrix_view<T const> const& A, matrix_view<T const> const& B, matrix_view<T> const& C, size_t leaf)
+{
+    workspace::frame frame;
+    ws_matrix<T> scratch(1, std::max<size_t>(serial_scratch(C.rows(), A.cols(), C.cols(), leaf), 1));
+    serial(A, B, C, leaf, scratch.data());
+}
+
+template<typename T>
+void mat_mul(matrix_view<T const> const& A, matrix_view<T const> const& B, matrix_view<T> const& C, size_t leaf, tdpool& pool)
+{
+    if(!recurse(C.rows(), A.cols(), C.cols(), leaf))
+    {
+        gemm_detail::mat_mul(static_cast<T>(1), A, B, static_cast<T>(0), C, pool);
+        return;
+    }
+
+    size_t depth = (pool.size() > 7) ? 2 : 1;
+
+    workspace::frame frame;
+    ws_matrix<T> scratch(1, std::max<size_t>(parallel_scratch(C.rows(), A.cols(), C.cols(), leaf, depth), 1));
+
+    T* p = scratch.data();
+    std::vector<level<T>> levels;
+    std::vector<task<T>> tasks;
+    expand(A, B, C, leaf, depth, p, levels, tasks, pool);
+
+    std::vector<std::future<void>> results;
+    for(task<T> const& t : tasks)
+    {
+        results.emplace_back(pool.enqueue([t, leaf]() { serial(t.A, t.B, t.C, leaf, t.scratch); }));
+    }
+    for(auto& r : results)
+    {
+        r.get();
+    }
+
+    for(size_t l = levels.size(); l-- > 0;)
+    {
+        combine(levels[l], pool);
+    }
+}
+
+}
@@ -0,0 +1,292 @@
+//
+//  symmetric_matrix.h
+//  Created by Ben Westcott on 10/17/26.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <stdexcept>
+#include <utility>
+#include "matrix.h"
+#include "matrix_expr.h"
+#include "matrix_view.h"
+
+using std::size_t;
+
+/*
+ * n x n symmetric matrix holding only its upper triangle, packed row by row:
+ *
+ *      a00 a01 a02 a03 | a11 a12 a13 | a22 a23 | a33
+ *
+ * i.e. n(n+1)/2 elements instead of n^2. (i, j) and (j, i) name the same
+ * element, so there is no second triangle to keep in sync, and row i right
+ * of the diagonal (upper_row_view) is contiguous.
+ *
+ * The packed storage is a matrix<T> row vector, so elementwise arithmetic
+ * runs on the simd kernels like it does for matrix<T>.
+ */
+template<typename T, typename Alloc = aligned_allocator<T>>
+class symmetric_matrix
+{
+public:
+    using value_type = T;
+
+    explicit symmetric_matrix(size_t n = 0);
+
+    // upper triangle of a square matrix or view, the lower triangle is not read
+    template<typename M>
+        requires matrix_like<M>
+    explicit symmetric_matrix(M const& full);
+
+    static constexpr size_t packed_size(size_t n) { return n * (n + 1)/2; }
+
+    size_t size(void) const { return m_n * m_n; }
+    size_t rows(void) const { return m_n; }
+    size_t cols(void) const { return m_n; }
+
+    // position of (i, j) in the packed storage, in either order
+    size_t offset(size_t i, size_t j) const;
+
+    T* data(void) { return m_packed.data(); }
+    T const* data(void) const { return m_packed.data(); }
+
+    T& operator()(size_t i, size_t j) { return m_packed.data()[offset(i, j)]; }
+    T const& operator()(size_t i, size_t j) const { return m_packed.data()[offset(i, j)]; }
+
+    // (i, i), (i, i + 1), ..., (i, n - 1), contiguous
+    matrix_view<T> upper_row_view(size_t i);
+    matrix_view<T const> upper_row_view(size_t i) const;
+
+    // the whole packed storage as one row
+    matrix_view<T> packed_view(void) { return m_packed.view(); }
+    matrix_view<T const> packed_view(void) const { return m_packed.view(); }
+
+    void fill(T value) { m_packed.fill(value); }
+    void zero(void) { fill(static_cast<T>(0.0)); }
+    void set_identity(void);
+
+    matrix<T> full(void) const;
+
+    symmetric_matrix<T, Alloc>& operator+=(symmetric_matrix<T, Alloc> const& rhs);
+    symmetric_matrix<T, Alloc>& operator-=(symmetric_matrix<T, Alloc> const& rhs);
+
+    template<typename R>
+    symmetric_matrix<T, Alloc>& operator*=(R scalar);
+
+    bool equals(symmetric_matrix<T, Alloc> const& rhs) const { return m_n == rhs.m_n && m_packed.content_equals(rhs.m_packed); }
+
+    static symmetric_matrix<T, Alloc> eye(size_t n);
+
+private:
+
+    size_t m_n;
+    matrix<T, layout_right, Alloc> m_packed;
+};
+
+template<typename T, typename Alloc>
+symmetric_matrix<T, Alloc>::symmetric_matrix(size_t n)
+: m_n(n), m_packed(1, packed_size(n))
+{
+}
+
+template<typename T, typename Alloc>
+template<typename M>
+    requires matrix_like<M>
+symmetric_matrix<T, Alloc>::symmetric_matrix(M const& full)
+: symmetric_matrix<T, Alloc>(full.rows())
+{
+    if(full.rows() != full.cols())
+    {
+        throw std::range_error("symmetric_matrix: matrix must be square.");
+    }
+
+    for(size_t i=0; i < m_n; i++)
+    {
+        T* row = m_packed.data() + offset(i, i);
+        for(size_t j=i; j < m_n; j++)
+        {
+            row[j - i] = static_cast<T>(full(i, j));
+        }
+    }
+}
+
+template<typename T, typename Alloc>
+inline size_t symmetric_matrix<T, Alloc>::offset(size_t i, size_t j) const
+{
+    if(i > j)
+    {
+        std::swap(i, j);
+    }
+
+    // rows 0 .. i-1 hold n + (n-1) + ... + (n-i+1) elements
+    return i * (2 * m_n - i + 1)/2 + (j - i);
+}
+
+template<typename T, typename Alloc>
+inline matrix_view<T> symmetric_matrix<T, Alloc>::upper_row_view(size_t i)
+{
+    return matrix_view<T>(m_packed.data() + offset(i, i), 1, m_n - i, m_n - i);
+}
+
+template<typename T, typename Alloc>
+inline matrix_view<T const> symmetric_matrix<T, Alloc>::upper_row_view(size_t i) const
+{
+    return matrix_view<T const>(m_packed.data() + offset(i, i), 1, m_n - i, m_n - i);
+}
+
+template<typename T, typename Alloc>
+void symmetric_matrix<T, Alloc>::set_identity(void)
+{
+    zero();
+    for(size_t i=0; i < m_n; i++)
+    {
+        (*this)(i, i) = static_cast<T>(1.0);
+    }
+}
+
+template<typename T, typename Alloc>
+matrix<T> symmetric_matrix<T, Alloc>::full(void) const
+{
+    matrix<T> res(m_n, m_n);
+    for(size_t i=0; i < m_n; i++)
+    {
+        T const* row = data() + offset(i, i);
+        for(size_t j=i; j < m_n; j++)
+        {
+            res(i, j) = res(j, i) = row[j - i];
+        }
+    }
+    return res;
+}
+
+template<typename T, typename Alloc>
+symmetric_matrix<T, Alloc>& symmetric_matrix<T, Alloc>::operator+=(symmetric_matrix<T, Alloc> const& rhs)
+{
+    if(m_n != rhs.m_n)
+    {
+        throw std::range_error("operator+=: sizes must be equal.");
+    }
+
+    m_packed += rhs.m_packed;
+    return *this;
+}
+
+template<typename T, typename Alloc>
+symmetric_matrix<T, Alloc>& symmetric_matrix<T, Alloc>::operator-=(symmetric_matrix<T, Alloc> const& rhs)
+{
+    if(m_n != rhs.m_n)
+    {
+        throw std::range_error("operator-=: sizes must be equal.");
+    }
+
+    m_packed -= rhs.m_packed;
+    return *this;
+}
+
+template<typename T, typename Alloc>
+template<typename R>
+symmetric_matrix<T, Alloc>& symmetric_matrix<T, Alloc>::operator*=(R scalar)
+{
+    m_packed *= scalar;
+    return *this;
+}
+
+template<typename T, typename Alloc>
+symmetric_matrix<T, Alloc> symmetric_matrix<T, Alloc>::eye(size_t n)
+{
+    symmetric_matrix<T, Alloc> I(n);
+    I.set_identity();
+    return I;
+}
+
+template<typename T, typename Alloc>
+inline bool operator==(symmetric_matrix<T, Alloc> const& lhs, symmetric_matrix<T, Alloc> const& rhs)
+{
+    return lhs.equals(rhs);
+}
+
+/*
+ * y <- alpha * A * x + beta * y for a symmetric A.
+ *
+ * One pass over the packed upper triangle: row i of it gives y(i) its
+ * inner product with x, and, through the symmetry, adds x(i) times the
+ * same row into y(i+1 .. n-1).
+ */
+template<typename T, typename Alloc, typename X>
+void sym_mat_vec(T alpha, symmetric_matrix<T, Alloc> const& A, X const& x, T beta, matrix_view<T> const& y)
+{
+    size_t n = A.rows();
+    if(x.size() != n || y.size() != n)
+    {
+        throw std::range_error("sym_mat_vec: incorrect dimensions.");
+    }
+
+    for(size_t i=0; i < n; i++)
+    {
+        y[i] = (beta == static_cast<T>(0.0)) ? static_cast<T>(0.0) : beta * y[i];
+    }
+
+    for(size_t i=0; i < n; i++)
+    {
+        T const* row = A.data() + A.offset(i, i);
+        T xi = alpha * x[i];
+
+        T acc = row[0] * x[i];
+        for(size_t j=i+1; j < n; j++)
+        {
+            acc += row[j - i] * x[j];
+            y[j] += xi * row[j - i];
+        }
+        y[i] += alpha * acc;
+    }
+}
+
+// A * x as a column vector
+template<typename T, typename Alloc, typename X>
+matrix<T> sym_mat_vec(symmetric_matrix<T, Alloc> const& A, X const& x)
+{
+    matrix<T> y(A.rows(), 1);
+    sym_mat_vec(static_cast<T>(1.0), A, x, static_cast<T>(0.0), y.view());
+    return y;
+}
+
+/*
+ * C <- alpha * V * V^T + beta * C, V is n x k.
+ *
+ * Only the upper triangle is computed, i.e. half the inner products of the
+ * dense update. Each is along a row of V, so V is best row-major.
+ */
+template<typename T, typename Alloc, typename M>
+void sym_rank_k_update(T alpha, M const& V, T beta, symmetric_matrix<T, Alloc>& C)
+{
+    size_t n = C.rows();
+    if(V.rows() != n)
+    {
+        throw std::range_error("sym_rank_k_update: incorrect dimensions.");
+    }
+
+    if(beta == static_cast<T>(0.0))
+    {
+        C.zero();
+    }
+    else if(beta != static_cast<T>(1.0))
+    {
+        C *= beta;
+    }
+
+    size_t k = V.cols();
+    for(size_t i=0; i < n; i++)
+    {
+        T* row = C.data() + C.offset(i, i);
+        for(size_t j=i; j < n; j++)
+        {
+            T acc = static_cast<T>(0.0);
+            for(size_t p=0; p < k; p++)
+            {
+                acc += V(i, p) * V(j, p);
+            }
+            row[j - i] += alpha * acc;
+        }
+    }
+}
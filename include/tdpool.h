@@ -108,6 +108,12 @@ public:
         return res;
     }
     
+    // number of worker threads
+    size_t size(void) const
+    {
+        return workers.size();
+    }
+    
     ~tdpool()
     {
         {
@@ -0,0 +1,282 @@
+//
+//  transpose.h
+//  Created by Ben Westcott on 10/17/26.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <future>
+#include <vector>
+#include "tdpool.h"
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+using std::size_t;
+
+/*
+ * Transpose kernels on raw storage, used by matrix<T>::transpose.
+ *
+ * A plain double loop writes (or reads) with a stride of a whole line per
+ * element, so on large matrices nearly every access misses the cache and
+ * the TLB. Here the matrix is cut into tiles small enough that a source and
+ * a destination tile both stay in L1, and each tile is transposed in small
+ * K x K blocks held in registers (4 x 4 with AVX for double, 4 x 4 with SSE
+ * for float, scalar otherwise), so that both sides are read and written
+ * along whole cache lines.
+ *
+ * Arguments are in storage terms: src has m lines of n elements, lines
+ * src_ld apart, and dst gets n lines of m elements, lines dst_ld apart. This
+ * is the same for row and column-major matrices.
+ */
+
+namespace transpose_detail
+{
+
+// tiles are tile x tile elements, 8KB (double) to 16KB (float)
+template<typename T>
+constexpr size_t tile = (sizeof(T) >= 8) ? 32 : 64;
+
+// in-register K x K transpose of full blocks
+template<typename T>
+struct micro
+{
+    static constexpr size_t K = 1;
+    static void run(T const* src, size_t, T* dst, size_t) { *dst = *src; }
+};
+
+#if defined(__AVX__)
+
+template<>
+struct micro<double>
+{
+    static constexpr size_t K = 4;
+
+    static void run(double const* src, size_t src_ld, double* dst, size_t dst_ld)
+    {
+        __m256d r0 = _mm256_loadu_pd(src);
+        __m256d r1 = _mm256_loadu_pd(src + src_ld);
+        __m256d r2 = _mm256_loadu_pd(src + 2 * src_ld);
+        __m256d r3 = _mm256_loadu_pd(src + 3 * src_ld);
+
+        // a0 b0 a2 b2, a1 b1 a3 b3, c0 d0 c2 d2, c1 d1 c3 d3
+        __m256d t0 = _mm256_unpacklo_pd(r0, r1);
+        __m256d t1 = _mm256_unpackhi_pd(r0, r1);
+        __m256d t2 = _mm256_unpacklo_pd(r2, r3);
+        __m256d t3 = _mm256_unpackhi_pd(r2, r3);
+
+        _mm256_storeu_pd(dst, _mm256_permute2f128_pd(t0, t2, 0x20));
+        _mm256_storeu_pd(dst + dst_ld, _mm256_permute2f128_pd(t1, t3, 0x20));
+        _mm256_storeu_pd(dst + 2 * dst_ld, _mm256_permute2f128_pd(t0, t2, 0x31));
+        _mm256_storeu_pd(dst + 3 * dst_ld, _mm256_permute2f128_pd(t1, t3, 0x31));
+    }
+};
+
+#elif defined(__SSE2__)
+
+template<>
+struct micro<double>
+{
+    static constexpr size_t K = 2;
+
+    static void run(double const* src, size_t src_ld, double* dst, size_t dst_ld)
+    {
+        __m128d r0 = _mm_loadu_pd(src);
+        __m128d r1 = _mm_loadu_pd(src + src_ld);
+
+        _mm_storeu_pd(dst, _mm_unpacklo_pd(r0, r1));
+        _mm_storeu_pd(dst + dst_ld, _mm_unpackhi_pd(r0, r1));
+    }
+};
+
+#endif
+
+#if defined(__SSE2__)
+
+template<>
+struct micro<float>
+{
+    static constexpr size_t K = 4;
+
+    static void run(float const* src, size_t src_ld, float* dst, size_t dst_ld)
+    {
+        __m128 r0 = _mm_loadu_ps(src);
+        __m128 r1 = _mm_loadu_ps(src + src_ld);
+        __m128 r2 = _mm_loadu_ps(src + 2 * src_ld);
+        __m128 r3 = _mm_loadu_ps(src + 3 * src_ld);
+
+        _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+
+        _mm_storeu_ps(dst, r0);
+        _mm_storeu_ps(dst + dst_ld, r1);
+        _mm_storeu_ps(dst + 2 * dst_ld, r2);
+        _mm_storeu_ps(dst + 3 * dst_ld, r3);
+    }
+};
+
+#endif
+
+// one tile (m, n <= tile<T>), full K x K blocks in registers, ragged edges scalar
+template<typename T>
+void transpose_tile(T const* src, size_t src_ld, T* dst, size_t dst_ld, size_t m, size_t n)
+{
+    constexpr size_t K = micro<T>::K;
+
+    size_t mk = m - m % K;
+    size_t nk = n - n % K;
+
+    for(size_t i=0; i < mk; i += K)
+    {
+        for(size_t j=0; j < nk; j += K)
+        {
+            micro<T>::run(src + i * src_ld + j, src_ld, dst + j * dst_ld + i, dst_ld);
+        }
+
+        for(size_t ii = i; ii < i + K; ii++)
+        {
+            for(size_t j = nk; j < n; j++)
+            {
+                dst[j * dst_ld + ii] = src[ii * src_ld + j];
+            }
+        }
+    }
+
+    for(size_t i = mk; i < m; i++)
+    {
+        for(size_t j=0; j < n; j++)
+        {
+            dst[j * dst_ld + i] = src[i * src_ld + j];
+        }
+    }
+}
+
+/*
+ * Tile rows [jb, je) of dst, i.e. tile columns of src. Going down dst line by
+ * line keeps the writes sequential, which matters more than the order of the
+ * reads (a partial line written to memory has to be read first).
+ */
+template<typename T>
+void transpose_bands(T const* src, size_t src_ld, T* dst, size_t dst_ld, size_t m, size_t n, size_t jb, size_t je)
+{
+    constexpr size_t B = tile<T>;
+
+    for(size_t j = jb * B; j < std::min(n, je * B); j += B)
+    {
+        size_t nb = std::min(B, n - j);
+        for(size_t i=0; i < m; i += B)
+        {
+            transpose_tile(src + i * src_ld + j, src_ld, dst + j * dst_ld + i, dst_ld, std::min(B, m - i), nb);
+        }
+    }
+}
+
+/*
+ * Tiles (I, J) and (J, I) for J >= I of an n x n matrix, tile row I.
+ * Off-diagonal pairs go through one tile of scratch.
+ */
+template<typename T>
+void transpose_square_band(T* a, size_t ld, size_t n, size_t I)
+{
+    constexpr size_t B = tile<T>;
+
+    size_t i = I * B;
+    size_t mb = std::min(B, n - i);
+
+    for(size_t r = i; r < i + mb; r++)
+    {
+        for(size_t c = r + 1; c < i + mb; c++)
+        {
+            std::swap(a[r * ld + c], a[c * ld + r]);
+        }
+    }
+
+    std::vector<T> buf(B * B);
+    for(size_t j = i + B; j < n; j += B)
+    {
+        size_t nb = std::min(B, n - j);
+
+        // buf <- (I, J)^T, (I, J) <- (J, I)^T, (J, I) <- buf
+        transpose_tile(a + i * ld + j, ld, buf.data(), B, mb, nb);
+        transpose_tile(a + j * ld + i, ld, a + i * ld + j, ld, nb, mb);
+
+        for(size_t r=0; r < nb; r++)
+        {
+            std::copy(buf.data() + r * B, buf.data() + r * B + mb, a + (j + r) * ld + i);
+        }
+    }
+}
+
+// tile rows per task in the parallel versions
+constexpr size_t bands_per_task = 4;
+
+}
+
+template<typename T>
+void transpose_block(T const* src, size_t src_ld, T* dst, size_t dst_ld, size_t m, size_t n)
+{
+    constexpr size_t B = transpose_detail::tile<T>;
+    transpose_detail::transpose_bands(src, src_ld, dst, dst_ld, m, n, 0, (n + B - 1)/B);
+}
+
+/*
+ * Same as above, bands of tile rows of dst are handed out to pool, so tasks
+ * never write the same lines. Returns once all are done.
+ */
+template<typename T>
+void transpose_block(T const* src, size_t src_ld, T* dst, size_t dst_ld, size_t m, size_t n, tdpool& pool)
+{
+    using namespace transpose_detail;
+
+    size_t bands = (n + tile<T> - 1)/tile<T>;
+
+    std::vector<std::future<void>> done;
+    for(size_t jb=0; jb < bands; jb += bands_per_task)
+    {
+        size_t je = std::min(bands, jb + bands_per_task);
+        done.emplace_back
+        (
+            pool.enqueue([=]() { transpose_bands(src, src_ld, dst, dst_ld, m, n, jb, je); })
+        );
+    }
+
+    for(auto& d : done)
+    {
+        d.get();
+    }
+}
+
+// in-place transpose of an n x n matrix whose lines are ld apart
+template<typename T>
+void transpose_square(T* a, size_t ld, size_t n)
+{
+    constexpr size_t B = transpose_detail::tile<T>;
+
+    for(size_t I=0; I < (n + B - 1)/B; I++)
+    {
+        transpose_detail::transpose_square_band(a, ld, n, I);
+    }
+}
+
+template<typename T>
+void transpose_square(T* a, size_t ld, size_t n, tdpool& pool)
+{
+    constexpr size_t B = transpose_detail::tile<T>;
+
+    // tile row I touches only tiles (I, J) and (J, I) with J >= I, so bands are independent
+    std::vector<std::future<void>> done;
+    for(size_t I=0; I < (n + B - 1)/B; I++)
+    {
+        done.emplace_back
+        (
+            pool.enqueue([=]() { transpose_detail::transpose_square_band(a, ld, n, I); })
+        );
+    }
+
+    for(auto& d : done)
+    {
+        d.get();
+    }
+}
@@ -0,0 +1,307 @@
+//
+//  triangular_matrix.h
+//  Created by Ben Westcott on 10/17/26.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <stdexcept>
+#include "matrix.h"
+#include "matrix_expr.h"
+#include "matrix_view.h"
+
+using std::size_t;
+
+enum class triangle { upper, lower };
+enum class diagonal { non_unit, unit };
+
+/*
+ * n x n triangular matrix holding only its triangle, packed row by row,
+ * e.g. for upper:
+ *
+ *      r00 r01 r02 | r11 r12 | r22
+ *
+ * A unit diagonal is implied and not stored either, so the packed size is
+ * n(n+1)/2, resp. n(n-1)/2. Each row of the triangle is contiguous.
+ *
+ * operator() may only be used inside the stored triangle, entry() reads
+ * anywhere, including the implied ones and zeros.
+ */
+template<typename T, triangle Uplo = triangle::upper, diagonal Diag = diagonal::non_unit, typename Alloc = aligned_allocator<T>>
+class triangular_matrix
+{
+public:
+    using value_type = T;
+
+    static constexpr size_t d = (Diag == diagonal::unit) ? 1 : 0;
+
+    explicit triangular_matrix(size_t n = 0);
+
+    // the triangle of a square matrix or view, nothing else is read
+    template<typename M>
+        requires matrix_like<M>
+    explicit triangular_matrix(M const& full);
+
+    static constexpr size_t packed_size(size_t n) { return n ? (n - d) * (n - d + 1)/2 : 0; }
+
+    size_t size(void) const { return m_n * m_n; }
+    size_t rows(void) const { return m_n; }
+    size_t cols(void) const { return m_n; }
+
+    bool stored(size_t i, size_t j) const { return (Uplo == triangle::upper) ? j >= i + d : i >= j + d; }
+
+    // columns stored in row i, [first_col, last_col)
+    size_t first_col(size_t i) const { return (Uplo == triangle::upper) ? i + d : 0; }
+    size_t last_col(size_t i) const { return (Uplo == triangle::upper) ? m_n : i + 1 - d; }
+
+    size_t offset(size_t i, size_t j) const;
+
+    T* data(void) { return m_packed.data(); }
+    T const* data(void) const { return m_packed.data(); }
+
+    T& operator()(size_t i, size_t j) { return m_packed.data()[offset(i, j)]; }
+    T const& operator()(size_t i, size_t j) const { return m_packed.data()[offset(i, j)]; }
+
+    T entry(size_t i, size_t j) const;
+
+    matrix<T> full(void) const;
+
+    template<typename R>
+    triangular_matrix<T, Uplo, Diag, Alloc>& operator*=(R scalar);
+
+    bool equals(triangular_matrix<T, Uplo, Diag, Alloc> const& rhs) const { return m_n == rhs.m_n && m_packed.content_equals(rhs.m_packed); }
+
+private:
+
+    size_t m_n;
+    matrix<T, layout_right, Alloc> m_packed;
+};
+
+template<typename T, triangle Uplo, diagonal Diag, typename Alloc>
+triangular_matrix<T, Uplo, Diag, Alloc>::triangular_matrix(size_t n)
+: m_n(n), m_packed(1, packed_size(n))
+{
+}
+
+template<typename T, triangle Uplo, diagonal Diag, typename Alloc>
+template<typename M>
+    requires matrix_like<M>
+triangular_matrix<T, Uplo, Diag, Alloc>::triangular_matrix(M const& full)
+: triangular_matrix<T, Uplo, Diag, Alloc>(full.rows())
+{
+    if(full.rows() != full.cols())
+    {
+        throw std::range_error("triangular_matrix: matrix must be square.");
+    }
+
+    for(size_t i=0; i < m_n; i++)
+    {
+        for(size_t j=first_col(i); j < last_col(i); j++)
+        {
+            (*this)(i, j) = static_cast<T>(full(i, j));
+        }
+    }
+}
+
+template<typename T, triangle Uplo, diagonal Diag, typename Alloc>
+inline size_t triangular_matrix<T, Uplo, Diag, Alloc>::offset(size_t i, size_t j) const
+{
+    if constexpr(Uplo == triangle::upper)
+    {
+        // rows 0 .. i-1 hold (n-d) + (n-d-1) + ... + (n-d-i+1) elements
+        return i * (2 * (m_n - d) - i + 1)/2 + (j - i - d);
+    }
+    else
+    {
+        // rows 0 .. i-1 hold (1-d) + (2-d) + ... + (i-d) elements
+        return (i * (i + 1) - 2 * d * i)/2 + j;
+    }
+}
+
+template<typename T, triangle Uplo, diagonal Diag, typename Alloc>
+T triangular_matrix<T, Uplo, Diag, Alloc>::entry(size_t i, size_t j) const
+{
+    if(stored(i, j))
+    {
+        return (*this)(i, j);
+    }
+    return (d && i == j) ? static_cast<T>(1.0) : static_cast<T>(0.0);
+}
+
+template<typename T, triangle Uplo, diagonal Diag, typename Alloc>
+matrix<T> triangular_matrix<T, Uplo, Diag, Alloc>::full(void) const
+{
+    matrix<T> res(m_n, m_n);
+    for(size_t i=0; i < m_n; i++)
+    {
+        T const* row = data() + offset(i, first_col(i));
+        for(size_t j=first_col(i); j < last_col(i); j++)
+        {
+            res(i, j) = row[j - first_col(i)];
+        }
+        if(d)
+        {
+            res(i, i) = static_cast<T>(1.0);
+        }
+    }
+    return res;
+}
+
+template<typename T, triangle Uplo, diagonal Diag, typename Alloc>
+template<typename R>
+triangular_matrix<T, Uplo, Diag, Alloc>& triangular_matrix<T, Uplo, Diag, Alloc>::operator*=(R scalar)
+{
+    static_assert(Diag == diagonal::non_unit, "operator*=: would scale the implied unit diagonal.");
+    m_packed *= scalar;
+    return *this;
+}
+
+template<typename T, triangle Uplo, diagonal Diag, typename Alloc>
+inline bool operator==(triangular_matrix<T, Uplo, Diag, Alloc> const& lhs, triangular_matrix<T, Uplo, Diag, Alloc> const& rhs)
+{
+    return lhs.equals(rhs);
+}
+
+/*
+ * The kernels below work in place on views (so e.g. on a column of a larger
+ * matrix), and in the order which only reads what is not yet overwritten:
+ * top down for upper A times x and lower A solves, bottom up otherwise.
+ * Each step is one contiguous row of the triangle.
+ */
+
+// x <- A x
+template<typename T, triangle Uplo, diagonal Diag, typename Alloc>
+void tri_mat_vec(triangular_matrix<T, Uplo, Diag, Alloc> const& A, matrix_view<T> const& x)
+{
+    size_t n = A.rows();
+    if(x.size() != n)
+    {
+        throw std::range_error("tri_mat_vec: incorrect dimensions.");
+    }
+
+    for(size_t s=0; s < n; s++)
+    {
+        size_t i = (Uplo == triangle::upper) ? s : n - 1 - s;
+        size_t j0 = A.first_col(i);
+        size_t j1 = A.last_col(i);
+        T const* row = A.data() + A.offset(i, j0);
+
+        T acc = A.d ? x[i] : static_cast<T>(0.0);
+        for(size_t j=j0; j < j1; j++)
+        {
+            acc += row[j - j0] * x[j];
+        }
+        x[i] = acc;
+    }
+}
+
+// x <- A^-1 x, i.e. solves A x = b with b passed in x
+template<typename T, triangle Uplo, diagonal Diag, typename Alloc>
+void tri_solve(triangular_matrix<T, Uplo, Diag, Alloc> const& A, matrix_view<T> const& x)
+{
+    size_t n = A.rows();
+    if(x.size() != n)
+    {
+        throw std::range_error("tri_solve: incorrect dimensions.");
+    }
+
+    for(size_t s=0; s < n; s++)
+    {
+        size_t i = (Uplo == triangle::upper) ? n - 1 - s : s;
+        size_t j0 = A.first_col(i);
+        size_t j1 = A.last_col(i);
+        T const* row = A.data() + A.offset(i, j0);
+
+        // the off diagonal part of the row, the diagonal is its first (upper) or last (lower) element
+        size_t o0 = (Uplo == triangle::upper && !A.d) ? j0 + 1 : j0;
+        size_t o1 = (Uplo == triangle::lower && !A.d) ? j1 - 1 : j1;
+
+        T sum = x[i];
+        for(size_t j=o0; j < o1; j++)
+        {
+            sum -= row[j - j0] * x[j];
+        }
+        x[i] = A.d ? sum : sum/A(i, i);
+    }
+}
+
+// B <- A B
+template<typename T, triangle Uplo, diagonal Diag, typename Alloc>
+void tri_mat_mul(triangular_matrix<T, Uplo, Diag, Alloc> const& A, matrix_view<T> const& B)
+{
+    size_t n = A.rows();
+    if(B.rows() != n)
+    {
+        throw std::range_error("tri_mat_mul: incorrect dimensions.");
+    }
+
+    size_t K = B.cols();
+    for(size_t s=0; s < n; s++)
+    {
+        size_t i = (Uplo == triangle::upper) ? s : n - 1 - s;
+        size_t j0 = A.first_col(i);
+        size_t j1 = A.last_col(i);
+        T const* row = A.data() + A.offset(i, j0);
+
+        matrix_view<T> bi = B.sub_row(i, 0, K);
+        if(!A.d)
+        {
+            bi *= A(i, i);
+        }
+
+        for(size_t j=j0; j < j1; j++)
+        {
+            if(j == i)
+            {
+                continue;
+            }
+
+            T a = row[j - j0];
+            for(size_t c=0; c < K; c++)
+            {
+                bi(0, c) += a * B(j, c);
+            }
+        }
+    }
+}
+
+// B <- A^-1 B, i.e. solves A X = B with B passed in B
+template<typename T, triangle Uplo, diagonal Diag, typename Alloc>
+void tri_mat_solve(triangular_matrix<T, Uplo, Diag, Alloc> const& A, matrix_view<T> const& B)
+{
+    size_t n = A.rows();
+    if(B.rows() != n)
+    {
+        throw std::range_error("tri_mat_solve: incorrect dimensions.");
+    }
+
+    size_t K = B.cols();
+    for(size_t s=0; s < n; s++)
+    {
+        size_t i = (Uplo == triangle::upper) ? n - 1 - s : s;
+        size_t j0 = A.first_col(i);
+        size_t j1 = A.last_col(i);
+        T const* row = A.data() + A.offset(i, j0);
+
+        matrix_view<T> bi = B.sub_row(i, 0, K);
+        for(size_t j=j0; j < j1; j++)
+        {
+            if(j == i)
+            {
+                continue;
+            }
+
+            T a = row[j - j0];
+            for(size_t c=0; c < K; c++)
+            {
+                bi(0, c) -= a * B(j, c);
+            }
+        }
+
+        if(!A.d)
+        {
+            bi *= static_cast<T>(1.0)/A(i, i);
+        }
+    }
+}
@@ -0,0 +1,241 @@
+//
+//  workspace.h
+//  Created by Ben Westcott on 10/17/26.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <vector>
+#include "aligned_allocator.h"
+#include "matrix.h"
+
+using std::size_t;
+
+/*
+ * Bump arena for the temporaries of factorizations (house vectors, products,
+ * working copies), so repeated calls in a service loop stop hitting the
+ * global heap.
+ *
+ * A workspace is made current for the calling thread with a scope:
+ *
+ *      workspace ws;
+ *      for(...)
+ *      {
+ *          workspace::scope use(ws);
+ *          auto res = transformation::house::QR(A);
+ *      }
+ *
+ * While a scope is active, ws_matrix<T> (i.e. matrix<T> with the
+ * workspace_allocator policy) takes its storage from the arena, otherwise
+ * from the heap like the default allocator. The routines in householder.h,
+ * gram_schmidt.h and jacobi.h hold their temporaries in ws_matrix (and
+ * jacobi.h its packed working copy in a symmetric_matrix with the same
+ * allocator) and open a frame, which hands everything they took from the
+ * arena back when they return (the givens.h kernels work in place and need
+ * none). Factors which are returned are allocated as usual.
+ *
+ * The arena only ever grows, by adding blocks. Once it has seen the largest
+ * problem, later calls of the same or smaller size reuse its blocks and make
+ * no allocations at all. Deallocation is a no-op, memory is reclaimed when a
+ * frame ends or on reset().
+ */
+class workspace
+{
+public:
+    static constexpr size_t alignment = 64;
+
+    explicit workspace(size_t bytes = 1 << 16);
+    ~workspace(void);
+
+    workspace(workspace const&) = delete;
+    workspace& operator=(workspace const&) = delete;
+
+    void* allocate(size_t bytes);
+
+    // position of the arena, see frame
+    struct mark
+    {
+        size_t block;
+        size_t offset;
+    };
+
+    mark position(void) const { return mark{m_block, m_offset}; }
+    void rewind(mark m) { m_block = m.block; m_offset = m.offset; }
+    void reset(void) { rewind(mark{0, 0}); }
+
+    size_t capacity(void) const;
+    size_t blocks(void) const { return m_blocks.size(); }
+
+    // the thread's current workspace, nullptr outside of a scope
+    static workspace*& current(void)
+    {
+        thread_local workspace* ws = nullptr;
+        return ws;
+    }
+
+    // makes ws current for this thread until the end of the scope
+    class scope
+    {
+    public:
+        explicit scope(workspace& ws) : m_prev(current()) { current() = &ws; }
+        ~scope(void) { current() = m_prev; }
+
+        scope(scope const&) = delete;
+        scope& operator=(scope const&) = delete;
+
+    private:
+        workspace* m_prev;
+    };
+
+    // rewinds the current workspace (if any) to where it was on construction
+    class frame
+    {
+    public:
+        frame(void) : m_ws(current()), m_mark(m_ws ? m_ws->position() : mark{0, 0}) {}
+        ~frame(void)
+        {
+            if(m_ws)
+            {
+                m_ws->rewind(m_mark);
+            }
+        }
+
+        frame(frame const&) = delete;
+        frame& operator=(frame const&) = delete;
+
+    private:
+        workspace* m_ws;
+        mark m_mark;
+    };
+
+private:
+
+    struct block
+    {
+        std::byte* data;
+        size_t size;
+    };
+
+    void add_block(size_t bytes);
+
+    std::vector<block> m_blocks;
+    size_t m_block;
+    size_t m_offset;
+};
+
+inline workspace::workspace(size_t bytes)
+: m_block(0), m_offset(0)
+{
+    add_block(bytes);
+}
+
+inline workspace::~workspace(void)
+{
+    for(block& b : m_blocks)
+    {
+        ::operator delete(b.data, std::align_val_t(alignment));
+    }
+}
+
+inline void workspace::add_block(size_t bytes)
+{
+    bytes = ((bytes + alignment - 1) / alignment) * alignment;
+
+    std::byte* data = static_cast<std::byte*>(::operator new(bytes, std::align_val_t(alignment)));
+    m_blocks.push_back(block{data, bytes});
+}
+
+inline void* workspace::allocate(size_t bytes)
+{
+    bytes = ((bytes + alignment - 1) / alignment) * alignment;
+
+    // first block from the current one on with room left, adding one if none has
+    while(m_offset + bytes > m_blocks[m_block].size)
+    {
+        if(m_block + 1 == m_blocks.size())
+        {
+            size_t grow = 2 * m_blocks.back().size;
+            add_block((grow < bytes) ? bytes : grow);
+        }
+
+        m_block++;
+        m_offset = 0;
+    }
+
+    void* p = m_blocks[m_block].data + m_offset;
+    m_offset += bytes;
+
+    return p;
+}
+
+inline size_t workspace::capacity(void) const
+{
+    size_t total = 0;
+    for(block const& b : m_blocks)
+    {
+        total += b.size;
+    }
+    return total;
+}
+
+/*
+ * Allocator policy for matrix<T> drawing from the workspace which is current
+ * when it is constructed, or from the heap (as aligned_allocator) when there
+ * is none. matrix<T> constructs its allocator on every allocation, so a
+ * matrix allocates from whichever workspace is current at the time.
+ *
+ * Storage from a workspace must not outlive the frame (or reset) it was
+ * taken in.
+ */
+template<typename T>
+struct workspace_allocator
+{
+    using value_type = T;
+
+    template<typename U>
+    struct rebind
+    {
+        using other = workspace_allocator<U>;
+    };
+
+    workspace_allocator(void) : m_ws(workspace::current()) {}
+
+    template<typename U>
+    workspace_allocator(workspace_allocator<U> const& rhs) noexcept : m_ws(rhs.m_ws) {}
+
+    T* allocate(size_t n)
+    {
+        if(m_ws)
+        {
+            return static_cast<T*>(m_ws->allocate(n * sizeof(T)));
+        }
+        return aligned_allocator<T, workspace::alignment>().allocate(n);
+    }
+
+    void deallocate(T* p, size_t n) noexcept
+    {
+        if(!m_ws)
+        {
+            aligned_allocator<T, workspace::alignment>().deallocate(p, n);
+        }
+    }
+
+    static constexpr size_t elements_per_line(void)
+    {
+        return aligned_allocator<T, workspace::alignment>::elements_per_line();
+    }
+
+    workspace* m_ws;
+};
+
+template<typename T, typename U>
+bool operator==(workspace_allocator<T> const& lhs, workspace_allocator<U> const& rhs) { return lhs.m_ws == rhs.m_ws; }
+
+template<typename T, typename U>
+bool operator!=(workspace_allocator<T> const& lhs, workspace_allocator<U> const& rhs) { return lhs.m_ws != rhs.m_ws; }
+
+// matrix for temporaries, see workspace
+template<typename T, typename Layout = layout_right>
+using ws_matrix = matrix<T, Layout, workspace_allocator<T>>;
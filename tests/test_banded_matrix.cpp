@@ -0,0 +1,157 @@
+//
+//  test_banded_matrix.cpp
+//  Created by Ben Westcott on 10/17/26.
+//
+
+// random n x n with bandwidths kl, ku, dense, made diagonally dominant if dominant
+matrix<double> random_banded(size_t n, size_t kl, size_t ku, bool dominant)
+{
+    matrix<double> A = matrix<double>::random_dense_matrix(n, n, -10, 10);
+    for(size_t i=0; i < n; i++)
+    {
+        for(size_t j=0; j < n; j++)
+        {
+            if(j + kl < i || i + ku < j)
+            {
+                A(i, j) = 0.0;
+            }
+        }
+        if(dominant)
+        {
+            A(i, i) = 10.0 * (kl + ku + 1);
+        }
+    }
+    return A;
+}
+
+TEST_CASE("banded matrix storage")
+{
+    double zero_tol = 1E-11;
+
+    auto kl = GENERATE(0, 1, 3);
+    auto ku = GENERATE(0, 2);
+    size_t N = 5 + S_RAND(40);
+
+    matrix<double> A = random_banded(N, kl, ku, false);
+    banded_matrix<double> B(A, kl, ku);
+
+    REQUIRE(B.full() == A);
+    REQUIRE(B.band_view().cols() == static_cast<size_t>(kl + ku + 1));
+    REQUIRE(B.entry(N - 1, 0) == 0.0);
+    REQUIRE(B.widened(kl + 1, ku + 2).full() == A);
+    if(kl + ku > 0)
+    {
+        REQUIRE_THROWS(B.widened(0, 0));
+    }
+    REQUIRE_THROWS(banded_matrix<double>(matrix<double>(3, 4), 1, 1));
+
+    // y = 2 A x - y, against the dense product
+    matrix<double> x = matrix<double>::random_dense_matrix(N, 1, -10, 10);
+    matrix<double> y = matrix<double>::random_dense_matrix(N, 1, -10, 10);
+    matrix<double> chk = inner_right_prod(A, x);
+    chk *= 2.0;
+    chk -= y;
+    band_mat_vec(2.0, B, x, -1.0, y.view());
+    REQUIRE(matrix<double>::abs_max_err(y, chk) < zero_tol);
+    REQUIRE(matrix<double>::abs_max_err(band_mat_vec(B, x), inner_right_prod(A, x)) < zero_tol);
+    REQUIRE_THROWS(band_mat_vec(B, matrix<double>(N + 1, 1)));
+}
+
+TEST_CASE("banded solves")
+{
+    using namespace transformation::banded;
+
+    double zero_tol = 1E-10;
+
+    auto kl = GENERATE(0, 1, 2, 5);
+    auto ku = GENERATE(0, 1, 3);
+    size_t N = 1 + S_RAND(60);
+
+    matrix<double> x = matrix<double>::random_dense_matrix(N, 1, -10, 10);
+
+    // not dominant, so LU has to pivot
+    matrix<double> A = random_banded(N, kl, ku, false);
+    banded_matrix<double> B(A, kl, ku);
+    matrix<double> b = inner_right_prod(A, x);
+
+    // random A can be badly conditioned, both are backward stable so check the residual
+    auto lu = LU(B);
+    if(!lu.degenerate)
+    {
+        REQUIRE(matrix<double>::abs_max_err(band_mat_vec(B, solve(lu, b)), b) < zero_tol);
+    }
+
+    banded_matrix<double> F = transformation::givens::band_QRfast(B);
+    REQUIRE(F.upper_bandwidth() == static_cast<size_t>(kl + ku));
+    if(!lu.degenerate)
+    {
+        REQUIRE(matrix<double>::abs_max_err(band_mat_vec(B, transformation::givens::band_QR_solve(F, b)), b) < zero_tol);
+    }
+
+    // symmetric positive definite from the lower band
+    matrix<double> S = random_banded(N, kl, kl, true);
+    for(size_t i=0; i < N; i++)
+    {
+        for(size_t j=0; j < i; j++)
+        {
+            S(j, i) = S(i, j);
+        }
+    }
+    banded_matrix<double> SB(S, kl, kl);
+    banded_matrix<double> L = cholesky(SB);
+    REQUIRE(L.upper_bandwidth() == 0);
+
+    matrix<double> Lf = L.full();
+    matrix<double> LT = Lf.transpose();
+    REQUIRE(matrix<double>::abs_max_err(mat_mul_alg1(&Lf, &LT, mult_pool), S) < zero_tol);
+    REQUIRE(matrix<double>::abs_max_err(cholesky_solve(L, inner_right_prod(S, x)), x) < zero_tol);
+
+    S(0, 0) = -1.0;
+    REQUIRE_THROWS(cholesky(banded_matrix<double>(S, kl, kl)));
+}
+
+TEST_CASE("tridiagonal and bidiagonal")
+{
+    using namespace transformation::banded;
+
+    double zero_tol = 1E-10;
+
+    size_t N = 1 + S_RAND(100);
+    matrix<double> x = matrix<double>::random_dense_matrix(N, 1, -10, 10);
+
+    tridiagonal_matrix<double> T(random_banded(N, 1, 1, true));
+    REQUIRE(T.lower_bandwidth() == 1);
+    REQUIRE(T.diag(0) == 30.0);
+
+    matrix<double> b = band_mat_vec(T, x);
+    REQUIRE(matrix<double>::abs_max_err(tridiagonal_solve(T, b), x) < zero_tol);
+    REQUIRE(matrix<double>::abs_max_err(solve(LU(T), b), x) < zero_tol);
+
+    T.diag(0) = 0.0;
+    if(N > 1)
+    {
+        T.super(0) = 0.0;
+        REQUIRE_THROWS(tridiagonal_solve(T, b));
+    }
+
+    bidiagonal_matrix<double> D(random_banded(N, 0, 1, true));
+    b = band_mat_vec(D, x);
+    REQUIRE(matrix<double>::abs_max_err(bidiagonal_solve(D, b), x) < zero_tol);
+
+    // Poisson at a size which is out of reach dense
+    size_t n = 100000;
+    tridiagonal_matrix<double> P(n);
+    for(size_t i=0; i < n; i++)
+    {
+        P.diag(i) = 2.0;
+        if(i > 0)
+        {
+            P.sub(i) = -1.0;
+            P.super(i - 1) = -1.0;
+        }
+    }
+    matrix<double> xp = matrix<double>::random_dense_matrix(n, 1, -1, 1);
+    matrix<double> bp = band_mat_vec(P, xp);
+    REQUIRE(matrix<double>::abs_max_err(tridiagonal_solve(P, bp), xp) < 1E-3);
+    REQUIRE(matrix<double>::abs_max_err(cholesky_solve(cholesky(P), bp), xp) < 1E-3);
+}
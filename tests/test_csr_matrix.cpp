@@ -0,0 +1,116 @@
+//
+//  test_csr_matrix.cpp
+//  Created by Ben Westcott on 10/17/26.
+//
+
+// M x N with about density * M * N nonzeros
+matrix<double> random_sparse_dense(size_t M, size_t N, double density)
+{
+    std::minstd_rand gen(std::random_device{}());
+    std::uniform_real_distribution<double> u(0.0, 1.0);
+
+    matrix<double> A = matrix<double>::random_dense_matrix(M, N, -10, 10);
+    for(size_t i=0; i < M; i++)
+    {
+        for(size_t j=0; j < N; j++)
+        {
+            if(u(gen) > density)
+            {
+                A(i, j) = 0.0;
+            }
+        }
+    }
+    return A;
+}
+
+TEST_CASE("csr matrix construction")
+{
+    // unordered, with duplicates which are summed
+    std::vector<triplet<double>> entries =
+    {
+        {2, 1, 1.0}, {0, 3, 2.0}, {2, 0, 3.0}, {0, 0, 4.0}, {2, 1, 5.0}, {1, 2, 6.0}
+    };
+    csr_matrix<double> S(3, 4, entries);
+
+    REQUIRE(S.nnz() == 5);
+    REQUIRE(S.row_ptr() == std::vector<size_t>{0, 2, 3, 5});
+    REQUIRE(S.col_idx() == std::vector<size_t>{0, 3, 2, 0, 1});
+    REQUIRE(S.entry(2, 1) == 6.0);
+    REQUIRE(S.entry(1, 1) == 0.0);
+    REQUIRE(S.full() == matrix<double>(3, 4, {4, 0, 0, 2, 0, 0, 6, 0, 3, 6, 0, 0}));
+
+    REQUIRE_THROWS(csr_matrix<double>(3, 4, {{3, 0, 1.0}}));
+    REQUIRE(csr_matrix<double>(5, 5).nnz() == 0);
+    REQUIRE(csr_matrix<double>(5, 5).full() == matrix<double>(5, 5));
+
+    auto rc = GENERATE(take(5, randmatsize(1, 80, false)));
+    matrix<double> A = random_sparse_dense(rc.M, rc.N, 0.05);
+    csr_matrix<double> C(A);
+    REQUIRE(C.full() == A);
+    REQUIRE(csr_matrix<double>(A.view()).full() == A);
+
+    csr_matrix<double> Ct = C.transpose();
+    REQUIRE(Ct.rows() == rc.N);
+    REQUIRE(Ct.full() == A.transpose());
+    REQUIRE(Ct.transpose().col_idx() == C.col_idx());
+
+    C *= 2.0;
+    matrix<double> A2(A);
+    A2 *= 2.0;
+    REQUIRE(C.full() == A2);
+}
+
+TEST_CASE("csr matrix products")
+{
+    double zero_tol = 1E-10;
+
+    auto rc = GENERATE(take(5, randmatsize(1, 200, false)));
+    matrix<double> A = random_sparse_dense(rc.M, rc.N, 0.1);
+    csr_matrix<double> S(A);
+
+    matrix<double> x = matrix<double>::random_dense_matrix(rc.N, 1, -10, 10);
+    matrix<double> y = matrix<double>::random_dense_matrix(rc.M, 1, -10, 10);
+
+    // y = 2 A x - y, serial and on the pool
+    matrix<double> chk = inner_right_prod(A, x);
+    chk *= 2.0;
+    chk -= y;
+    matrix<double> yp(y);
+    sp_mat_vec(2.0, S, x, -1.0, y.view());
+    sp_mat_vec(2.0, S, x, -1.0, yp.view(), mult_pool);
+    REQUIRE(matrix<double>::abs_max_err(y, chk) < zero_tol);
+    REQUIRE(matrix<double>::abs_max_err(yp, chk) < zero_tol);
+    REQUIRE(matrix<double>::abs_max_err(sp_mat_vec(S, x, mult_pool), inner_right_prod(A, x)) < zero_tol);
+    REQUIRE_THROWS(sp_mat_vec(S, matrix<double>(rc.N + 1, 1)));
+
+    matrix<double> B = matrix<double>::random_dense_matrix(rc.N, 7, -10, 10);
+    matrix<double> AB = mat_mul_alg1(&A, &B, mult_pool);
+    REQUIRE(matrix<double>::abs_max_err(sp_mat_mul(S, B), AB) < zero_tol);
+    REQUIRE(matrix<double>::abs_max_err(sp_mat_mul(S, B, mult_pool), AB) < zero_tol);
+    REQUIRE_THROWS(sp_mat_mul(S, matrix<double>(rc.N + 1, 2)));
+}
+
+TEST_CASE("csr spmv chunking")
+{
+    // one row heavy enough to be its own chunk, many empty rows, a long tail
+    size_t n = 100000;
+    std::vector<triplet<double>> entries;
+    for(size_t j=0; j < n; j++)
+    {
+        entries.push_back({7, j, 1.0});
+    }
+    for(size_t i=n/2; i < n; i++)
+    {
+        entries.push_back({i, i, static_cast<double>(i)});
+    }
+    csr_matrix<double> S(n, n, entries);
+
+    matrix<double> x(n, 1);
+    x.fill(1.0);
+    matrix<double> y = sp_mat_vec(S, x, mult_pool);
+
+    REQUIRE(y(7, 0) == static_cast<double>(n));
+    REQUIRE(y(0, 0) == 0.0);
+    REQUIRE(y(n - 1, 0) == static_cast<double>(n - 1));
+    REQUIRE(y == sp_mat_vec(S, x));
+}
@@ -0,0 +1,103 @@
+//
+//  test_fixed_matrix.cpp
+//  Created by Ben Westcott on 10/17/26.
+//
+
+TEST_CASE("fixed matrix basics")
+{
+    constexpr fixed_matrix<int, 2, 3> A = {1, 2, 3, 4, 5, 6};
+
+    static_assert(A.rows() == 2 && A.cols() == 3 && A.size() == 6);
+    static_assert(A(1, 2) == 6);
+    static_assert(A.transpose()(2, 1) == 6);
+    static_assert(fixed_matrix<int, 3, 3>::eye()(1, 1) == 1);
+
+    fixed_matrix<int, 2, 3> B = {{1, 2, 3}, {4, 5, 6}};
+    REQUIRE(A == B);
+
+    B += A;
+    REQUIRE(B == 2 * A);
+    B -= A;
+    REQUIRE(B == A);
+    REQUIRE(B + A - A == A);
+
+    REQUIRE(A.row(1) == fixed_matrix<int, 1, 3>{4, 5, 6});
+    REQUIRE(A.col(2) == fixed_matrix<int, 2, 1>{3, 6});
+    REQUIRE_THROWS(A.row(2));
+
+    fixed_matrix<int, 3, 2> C = {1, 2, 3, 4, 5, 6};
+    fixed_matrix<int, 2, 2> AC = mat_mul(A, C);
+    REQUIRE(AC == fixed_matrix<int, 2, 2>{22, 28, 49, 64});
+}
+
+TEST_CASE("fixed matrix interop")
+{
+    matrix<double> D = matrix<double>::random_dense_matrix(4, 4, -10, 10);
+
+    fixed_matrix<double, 4, 4> F(D);
+    REQUIRE(matrix<double>(F) == D);
+    REQUIRE_THROWS(fixed_matrix<double, 3, 4>(D));
+
+    // column-major source, and back through a const view
+    matrix<double, layout_left> L(D);
+    fixed_matrix<double, 4, 4> const FL(L);
+    REQUIRE(FL == F);
+    REQUIRE(matrix<double>(FL.view()) == D);
+
+    // generic products and view kernels accept fixed matrices
+    REQUIRE(inner_prod_1D(F.col(0), F.col(1)) == inner_prod_1D(D.col(0), D.col(1)));
+
+    fixed_matrix<double, 4, 4> G = mat_mul(F, F);
+    matrix<double> DD = mat_mul_alg1(&D, &D, mult_pool);
+    REQUIRE(matrix<double>::abs_max_err(matrix<double>(G), DD) < 1E-11);
+
+    F.view().sub_matrix(1, 1) *= 0.0;
+    REQUIRE(F(3, 3) == 0.0);
+    REQUIRE(F(0, 3) == D(0, 3));
+}
+
+template<size_t M, size_t N, typename QRfn>
+void check_fixed_QR(QRfn qr)
+{
+    double zero_tol = 1E-11;
+
+    fixed_matrix<double, M, N> A(matrix<double>::random_dense_matrix(M, N, -1000, 1000));
+    auto res = qr(A);
+
+    for(size_t c=0; c < N; c++)
+    {
+        for(size_t r = c + 1; r < M; r++)
+        {
+            REQUIRE(res.Y(r, c) == 0.0);
+        }
+    }
+
+    matrix<double> chk(mat_mul(res.Q, res.Y));
+    matrix<double> orth(mat_mul(res.Q.transpose(), res.Q));
+
+    REQUIRE(matrix<double>::abs_max_err(chk, matrix<double>(A)) < zero_tol);
+    REQUIRE(matrix<double>::abs_max_err(orth, matrix<double>::eye(M)) < zero_tol);
+}
+
+TEST_CASE("fixed householder QR")
+{
+    using namespace transformation::house;
+
+    check_fixed_QR<3, 3>(fixed::QR<3, 3>);
+    check_fixed_QR<4, 4>(fixed::QR<4, 4>);
+    check_fixed_QR<6, 6>(fixed::QR<6, 6>);
+    check_fixed_QR<6, 3>(fixed::QR<6, 3>);
+
+    auto res = fixed::QR(fixed_matrix<double, 2, 2>{-2, 0, 0, 3});
+    REQUIRE(mat_mul(res.Q, res.Y) == fixed_matrix<double, 2, 2>{-2, 0, 0, 3});
+}
+
+TEST_CASE("fixed givens QR")
+{
+    using namespace transformation::givens;
+
+    check_fixed_QR<3, 3>(fixed::QR<3, 3>);
+    check_fixed_QR<4, 4>(fixed::QR<4, 4>);
+    check_fixed_QR<6, 6>(fixed::QR<6, 6>);
+    check_fixed_QR<6, 3>(fixed::QR<6, 3>);
+}
@@ -0,0 +1,198 @@
+//
+//  test_gemm.cpp
+//  Created by Ben Westcott on 10/17/26.
+//
+
+// C <- alpha * A * B + beta * C the obvious way, accumulating in double
+template<typename T, typename L, typename R>
+matrix<T> naive_gemm(T alpha, L const& lhs, R const& rhs, T beta, matrix<T> const& C)
+{
+    matrix_view<T const> A = const_view(lhs);
+    matrix_view<T const> B = const_view(rhs);
+    matrix<T> X(C.rows(), C.cols());
+    for(size_t i=0; i < C.rows(); i++)
+    {
+        for(size_t j=0; j < C.cols(); j++)
+        {
+            double s = 0;
+            for(size_t k=0; k < A.cols(); k++)
+            {
+                s += static_cast<double>(A(i, k)) * static_cast<double>(B(k, j));
+            }
+            X(i, j) = static_cast<T>(alpha * s + ((beta == static_cast<T>(0)) ? 0 : beta * C(i, j)));
+        }
+    }
+    return X;
+}
+
+template<typename T>
+double gemm_err(matrix<T> const& X, matrix<T> const& Y)
+{
+    double err = 0;
+    for(size_t i=0; i < X.rows(); i++)
+    {
+        for(size_t j=0; j < X.cols(); j++)
+        {
+            err = std::max(err, std::abs(static_cast<double>(X(i, j)) - static_cast<double>(Y(i, j))));
+        }
+    }
+    return err;
+}
+
+template<typename T>
+matrix<T> small_ints(size_t rows, size_t cols, std::minstd_rand& gen)
+{
+    std::uniform_int_distribution<int> dist(-4, 4);
+    matrix<T> A(rows, cols);
+    for(size_t i=0; i < rows; i++)
+    {
+        for(size_t j=0; j < cols; j++)
+        {
+            A(i, j) = static_cast<T>(dist(gen));
+        }
+    }
+    return A;
+}
+
+/*
+ * Sizes around the micro-tile shapes (up to 12 x 32) and past one KC slice,
+ * on small integers so every kernel is exact whatever the summation order.
+ */
+template<typename T>
+void check_gemm(void)
+{
+    std::minstd_rand gen(std::random_device{}());
+
+    struct dims { size_t M, N, K; };
+    for(dims d : std::initializer_list<dims>{{1, 1, 1}, {3, 5, 7}, {12, 32, 16}, {13, 33, 17},
+                                             {25, 17, 300}, {100, 70, 513}, {97, 130, 64}})
+    {
+        matrix<T> A = small_ints<T>(d.M, d.K, gen);
+        matrix<T> B = small_ints<T>(d.K, d.N, gen);
+        matrix<T> C0 = small_ints<T>(d.M, d.N, gen);
+
+        for_each_isa([&](simd::isa)
+        {
+            matrix<T> C(C0);
+            mat_mul(static_cast<T>(1), A, B, static_cast<T>(0), C.view());
+            REQUIRE(C == naive_gemm<T>(1, A, B, 0, C0));
+
+            C = C0;
+            mat_mul(static_cast<T>(2), A, B, static_cast<T>(-3), C.view());
+            REQUIRE(C == naive_gemm<T>(2, A, B, -3, C0));
+
+            // column-major operands and result, and transposed views
+            matrix<T, layout_left> Af(A);
+            matrix<T, layout_left> Cf(C0);
+            matrix<T> Bt(B.transpose());
+            mat_mul(static_cast<T>(1), Af, Bt.view().transpose(), static_cast<T>(1), Cf.view());
+            REQUIRE(matrix<T>(Cf) == naive_gemm<T>(1, A, B, 1, C0));
+
+            // blocks of larger matrices
+            matrix<T> Cb(d.M + 3, d.N + 5);
+            mat_mul(static_cast<T>(1), A, B, static_cast<T>(0), Cb.view().sub_matrix(2, d.M, 3, d.N));
+            REQUIRE(matrix<T>(Cb.view().sub_matrix(2, d.M, 3, d.N)) == naive_gemm<T>(1, A, B, 0, C0));
+            REQUIRE(Cb(0, 0) == static_cast<T>(0));
+            REQUIRE(Cb(d.M + 2, d.N + 4) == static_cast<T>(0));
+
+            C = C0;
+            mat_mul(static_cast<T>(1), A, B, static_cast<T>(1), C.view(), mult_pool);
+            REQUIRE(C == naive_gemm<T>(1, A, B, 1, C0));
+        });
+    }
+}
+
+TEST_CASE("gemm")
+{
+    check_gemm<double>();
+    check_gemm<float>();
+    check_gemm<int>();
+}
+
+TEST_CASE("gemm rounding")
+{
+    std::minstd_rand gen(std::random_device{}());
+    size_t M = 150, N = 90, K = 700;
+
+    matrix<double> A = random_matrix::dense<double>(M, K, -1, 1, gen());
+    matrix<double> B = random_matrix::dense<double>(K, N, -1, 1, gen());
+    matrix<double> C0 = random_matrix::dense<double>(M, N, -1, 1, gen());
+    matrix<double> R = naive_gemm(0.5, A, B, 2.0, C0);
+
+    matrix<float> As = random_matrix::dense<float>(M, K, -1, 1, gen());
+    matrix<float> Bs = random_matrix::dense<float>(K, N, -1, 1, gen());
+    matrix<float> Rs = naive_gemm(1.0f, As, Bs, 0.0f, matrix<float>(M, N));
+
+    for_each_isa([&](simd::isa)
+    {
+        matrix<double> C(C0);
+        mat_mul(0.5, A, B, 2.0, C.view());
+        REQUIRE(gemm_err(C, R) < 1e-12);
+
+        matrix<float> Cs(M, N);
+        mat_mul(1.0f, As, Bs, 0.0f, Cs.view());
+        REQUIRE(gemm_err(Cs, Rs) < 1e-3);
+    });
+}
+
+TEST_CASE("gemm special cases")
+{
+    matrix<double> A = random_matrix::dense<double>(20, 30, -1, 1, 1);
+    matrix<double> B = random_matrix::dense<double>(30, 40, -1, 1, 2);
+
+    // beta = 0 does not read C
+    matrix<double> C(20, 40);
+    C.fill(std::numeric_limits<double>::quiet_NaN());
+    mat_mul(1.0, A, B, 0.0, C.view());
+    REQUIRE(gemm_err(C, naive_gemm(1.0, A, B, 0.0, C)) < 1e-12);
+
+    // alpha = 0 and K = 0 only scale C
+    matrix<double> C0 = random_matrix::dense<double>(20, 40, -1, 1, 3);
+    C = C0;
+    mat_mul(0.0, A, B, 2.0, C.view());
+    C0 *= 2.0;
+    REQUIRE(C == C0);
+
+    C = C0;
+    mat_mul(1.0, matrix<double>(size_t(20), size_t(0)), matrix<double>(size_t(0), size_t(40)), 0.0, C.view());
+    REQUIRE(C == matrix<double>(20, 40));
+
+    REQUIRE_THROWS(mat_mul(1.0, A, A, 0.0, C.view()));
+    REQUIRE_THROWS(mat_mul(1.0, A, B, 0.0, matrix<double>(20, 41).view()));
+    REQUIRE_THROWS(mat_mul(1.0, A, A, 0.0, C.view(), mult_pool));
+    REQUIRE_THROWS(mat_mul_alg1(&A, &A, mult_pool));
+
+    matrix<double, layout_left> Af(A);
+    REQUIRE(gemm_err(mat_mul_alg1(&Af, &B, mult_pool), naive_gemm(1.0, A, B, 0.0, C)) < 1e-12);
+}
+
+TEST_CASE("gemm on a pool")
+{
+    std::minstd_rand gen(std::random_device{}());
+
+    // tall-skinny, short-wide, past NC columns and KC depth
+    struct dims { size_t M, N, K; };
+    for(dims d : std::initializer_list<dims>{{2, 3, 4}, {500, 20, 40}, {7, 300, 600}, {5, 4500, 300}, {130, 130, 260}})
+    {
+        matrix<double> A = random_matrix::dense<double>(d.M, d.K, -1, 1, gen());
+        matrix<double> B = random_matrix::dense<double>(d.K, d.N, -1, 1, gen());
+        matrix<double> C0 = random_matrix::dense<double>(d.M, d.N, -1, 1, gen());
+
+        matrix<double> C(C0);
+        mat_mul(1.5, A, B, -1.0, C.view());
+
+        // the same bits for any number of workers
+        for(size_t workers : {1, 3, 8})
+        {
+            tdpool pool(workers);
+
+            matrix<double> Cp(C0);
+            mat_mul(1.5, A, B, -1.0, Cp.view(), pool);
+            REQUIRE(Cp == C);
+
+            matrix<double, layout_left> Cf(C0);
+            mat_mul(1.5, A, B, -1.0, Cf.view(), pool);
+            REQUIRE(gemm_err(matrix<double>(Cf), C) < 1e-12);
+        }
+    }
+}
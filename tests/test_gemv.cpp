@@ -0,0 +1,162 @@
+//
+//  test_gemv.cpp
+//  Created by Ben Westcott on 10/17/26.
+//
+
+/*
+ * Every path of gemv against a plain loop: A row- and column-major, op N
+ * and T, contiguous and strided x and y, sizes around the vector widths
+ * and the four row blocks, on small integers so all kernels are exact.
+ */
+template<typename T>
+void check_gemv(void)
+{
+    std::minstd_rand gen(std::random_device{}());
+
+    for(size_t m : {1, 3, 4, 5, 17, 33, 70})
+    {
+        for(size_t n : {1, 2, 7, 8, 16, 31, 65})
+        {
+            matrix<T> A = small_ints<T>(m, n, gen);
+            matrix<T, layout_left> Af(A);
+
+            // x and y as contiguous columns, and as strided columns of wider matrices
+            matrix<T> xn = small_ints<T>(n, 1, gen), xt = small_ints<T>(m, 1, gen);
+            matrix<T> X = small_ints<T>(std::max(m, n), 3, gen);
+            matrix<T> y0 = small_ints<T>(std::max(m, n), 1, gen);
+
+            for_each_isa([&](simd::isa)
+            {
+                for(trans op : {trans::N, trans::T})
+                {
+                    size_t rows = (op == trans::N) ? m : n;
+                    size_t cols = (op == trans::N) ? n : m;
+                    matrix<T> const& x = (op == trans::N) ? xn : xt;
+                    matrix<T> opA = (op == trans::N) ? A : matrix<T>(A.transpose());
+
+                    matrix<T> R(rows, 1);
+                    for(size_t i=0; i < rows; i++)
+                    {
+                        T s = 0;
+                        for(size_t j=0; j < cols; j++)
+                        {
+                            s += opA(i, j) * x(j, 0);
+                        }
+                        R(i, 0) = static_cast<T>(2 * s - 3 * y0(i, 0));
+                    }
+
+                    matrix<T> y(y0.view().sub_matrix(0, rows, 0, 1));
+                    gemv(static_cast<T>(2), A, x, static_cast<T>(-3), y.view(), op);
+                    REQUIRE(y == R);
+
+                    y = matrix<T>(y0.view().sub_matrix(0, rows, 0, 1));
+                    gemv(static_cast<T>(2), Af, x.view().transpose(), static_cast<T>(-3), y.view().transpose(), op);
+                    REQUIRE(y == R);
+
+                    // strided x and y
+                    matrix<T> Y(rows, 3);
+                    Y.view().col(1).assign(y0.view().sub_matrix(0, rows, 0, 1));
+                    matrix<T> Xs(X);
+                    Xs.view().sub_matrix(0, cols, 2, 1).assign(x);
+                    gemv(static_cast<T>(2), Af, Xs.view().sub_matrix(0, cols, 2, 1), static_cast<T>(-3), Y.view().col(1), op);
+                    REQUIRE(matrix<T>(Y.view().col(1)) == R);
+                }
+            });
+        }
+    }
+}
+
+TEST_CASE("gemv")
+{
+    check_gemv<double>();
+    check_gemv<float>();
+    check_gemv<int>();
+}
+
+TEST_CASE("gemv special cases")
+{
+    double zero_tol = 1E-12;
+    matrix<double> A = random_matrix::dense<double>(37, 23, -1, 1, 1);
+    matrix<double> x = random_matrix::dense<double>(23, 1, -1, 1, 2);
+    matrix<double> y(37, 1);
+
+    // beta = 0 does not read y
+    y.fill(std::numeric_limits<double>::quiet_NaN());
+    gemv(1.0, A, x, 0.0, y.view());
+    REQUIRE(matrix<double>::abs_max_err(y, inner_right_prod(A, x)) < zero_tol);
+
+    matrix<double> y0 = random_matrix::dense<double>(37, 1, -1, 1, 3);
+    y = y0;
+    gemv(0.0, A, x, 2.0, y.view());
+    y0 *= 2.0;
+    REQUIRE(y == y0);
+
+    // reversed views run forwards
+    matrix<double> yr(37, 1);
+    gemv(1.0, A.view().reverse_cols(), x.view().reverse_rows(), 0.0, yr.view());
+    REQUIRE(matrix<double>::abs_max_err(yr, inner_right_prod(A, x)) < zero_tol);
+
+    REQUIRE_THROWS(gemv(1.0, A, x, 0.0, y.view(), trans::T));
+    REQUIRE_THROWS(gemv(1.0, A, A, 0.0, y.view()));
+    REQUIRE_THROWS(inner_left_prod(x, A));
+    REQUIRE_THROWS(inner_right_prod(A, y));
+
+    // inner_left_prod is x^T A, in either layout
+    matrix<double> z = random_matrix::dense<double>(37, 1, -1, 1, 4);
+    matrix<double, layout_left> Af(A);
+    REQUIRE(matrix<double>::abs_max_err(inner_left_prod(z, A), inner_left_prod(z, Af)) < zero_tol);
+    REQUIRE(matrix<double>::abs_max_err(inner_left_prod(z, A), matrix<double>(inner_right_prod(Af.transpose(), z).transpose())) < zero_tol);
+}
+
+TEST_CASE("rank1_update and apply_reflector")
+{
+    double zero_tol = 1E-12;
+    std::minstd_rand gen(std::random_device{}());
+
+    for(size_t m : {1, 5, 33, 300})
+    {
+        for(size_t n : {1, 7, 40, 600})
+        {
+            matrix<double> A0 = random_matrix::dense<double>(m, n, -1, 1, gen());
+            matrix<double> x = random_matrix::dense<double>(m, 1, -1, 1, gen());
+            matrix<double> y = random_matrix::dense<double>(1, n, -1, 1, gen());
+
+            matrix<double> R(A0);
+            R -= 0.5 * outer(x, y);
+
+            for_each_isa([&](simd::isa)
+            {
+                matrix<double> A(A0);
+                rank1_update(A.view(), -0.5, x, y);
+                REQUIRE(matrix<double>::abs_max_err(A, R) < zero_tol);
+
+                matrix<double, layout_left> Af(A0);
+                rank1_update(Af.view(), -0.5, x, y.view().transpose());
+                REQUIRE(matrix<double>::abs_max_err(matrix<double>(Af), R) < zero_tol);
+
+                // P = I - beta v v^T from either side, in either layout and reversed
+                double beta = 2/inner_prod_1D(x, x);
+                matrix<double> PA(A0), AP(A0.transpose());
+                PA -= beta * outer(x, inner_left_prod(x, A0));
+                AP -= beta * outer(inner_right_prod(AP, x), x);
+
+                A = A0;
+                apply_reflector(A.view(), x, beta);
+                REQUIRE(matrix<double>::abs_max_err(A, PA) < zero_tol);
+
+                Af = matrix<double, layout_left>(A0);
+                apply_reflector(Af.view().reverse(), x.view().reverse(), beta);
+                REQUIRE(matrix<double>::abs_max_err(matrix<double>(Af), PA) < zero_tol);
+
+                matrix<double> At(A0.transpose());
+                apply_reflector(At.view(), x, beta, side::right);
+                REQUIRE(matrix<double>::abs_max_err(At, AP) < zero_tol);
+            });
+        }
+    }
+
+    matrix<double> A(4, 5);
+    REQUIRE_THROWS(rank1_update(A.view(), 1.0, matrix<double>(5, 1), matrix<double>(5, 1)));
+    REQUIRE_THROWS(apply_reflector(A.view(), matrix<double>(5, 1), 1.0));
+    REQUIRE_THROWS(apply_reflector(A.view(), matrix<double>(4, 1), 1.0, side::right));
+}
@@ -232,6 +232,29 @@ TEST_CASE("QRaccumulate rand, randsize")
     REQUIRE(errmax < zero_tol);
 }
 
+TEST_CASE("QR column-major")
+{
+    using namespace transformation::house;
+    
+    double zero_tol = 1E-11;
+    
+    auto S = GENERATE(take(5, rd_randmatsize(1, 100)));
+    
+    matrix<double> A = matrix<double>::random_dense_matrix(S.M, S.N, -1000, 1000);
+    matrix<double, layout_left> F(A);
+    matrix<double, layout_left> Q = matrix<double, layout_left>::eye(S.M);
+    
+    QRview(F);
+    QRaccumulate_view(Q, F, 0);
+    F.fill_lower_triangle(0.0);
+    
+    // mixed layout product
+    matrix<double> chk = mat_mul_alg1(&Q, &F, mult_pool);
+    
+    REQUIRE(matrix<double>::abs_max_excess_err(chk, A, zero_tol) == 0);
+    REQUIRE(matrix<double>::abs_max_err(chk, A) < zero_tol);
+}
+
 TEST_CASE("QR")
 {
     using namespace transformation::house;
@@ -643,6 +666,97 @@ TEST_CASE("QLH householder")
     REQUIRE(errmax < zero_tol);
 }
 
+TEST_CASE("LQ householder maybe square")
+{
+    using namespace transformation::house;
+
+    size_t cnt_tol = 0;
+    double zero_tol = 1E-11;
+    double errmax;
+    size_t errcnt;
+    
+    // LQ wants M <= N
+    auto S = GENERATE(take(10, rd_randmatsize(1, 100)));
+    size_t M = S.N;
+    size_t N = S.M;
+    
+#ifdef TEST_HOUSE_VERBOSE_OUTPUT
+    std::cout << "test transformation::house::LQ (rand, M = " << M << ", N = " << N << "): ";
+#endif
+    
+    matrix<double> b = matrix<double>::random_dense_matrix(M, N, -1000, 1000);
+    
+    auto result = LQ(b);
+    
+    for(size_t r=0; r < M; r++)
+    {
+        for(size_t c=r + 1; c < N; c++)
+        {
+            REQUIRE(result.Y(r, c) == 0.0);
+        }
+    }
+    
+    matrix<double> chk = mat_mul_alg1(&result.Y, &result.Q, mult_pool);
+    
+    errcnt = matrix<double>::abs_max_excess_err(chk, b, zero_tol);
+    errmax = matrix<double>::abs_max_err(chk, b);
+    
+#ifdef TEST_HOUSE_VERBOSE_OUTPUT
+    std::cout << "\terrcnt = " << errcnt;
+    std::cout << "\terrmax = " << errmax;
+    std::cout << "\n";
+#endif
+    
+    REQUIRE(errcnt <= cnt_tol);
+    REQUIRE(errmax < zero_tol);
+}
+
+TEST_CASE("RQ householder maybe square")
+{
+    using namespace transformation::house;
+
+    size_t cnt_tol = 0;
+    double zero_tol = 1E-11;
+    double errmax;
+    size_t errcnt;
+    
+    // RQ wants M <= N
+    auto S = GENERATE(take(10, rd_randmatsize(1, 100)));
+    size_t M = S.N;
+    size_t N = S.M;
+    
+#ifdef TEST_HOUSE_VERBOSE_OUTPUT
+    std::cout << "test transformation::house::RQ (rand, M = " << M << ", N = " << N << "): ";
+#endif
+    
+    matrix<double> b = matrix<double>::random_dense_matrix(M, N, -1000, 1000);
+    
+    auto result = RQ(b);
+    
+    // R is upper triangular, aligned to the right
+    for(size_t r=0; r < M; r++)
+    {
+        for(size_t c=0; c < r + N - M; c++)
+        {
+            REQUIRE(result.Y(r, c) == 0.0);
+        }
+    }
+    
+    matrix<double> chk = mat_mul_alg1(&result.Y, &result.Q, mult_pool);
+    
+    errcnt = matrix<double>::abs_max_excess_err(chk, b, zero_tol);
+    errmax = matrix<double>::abs_max_err(chk, b);
+    
+#ifdef TEST_HOUSE_VERBOSE_OUTPUT
+    std::cout << "\terrcnt = " << errcnt;
+    std::cout << "\terrmax = " << errmax;
+    std::cout << "\n";
+#endif
+    
+    REQUIRE(errcnt <= cnt_tol);
+    REQUIRE(errmax < zero_tol);
+}
+
 /*
 TEST_CASE("test")
 {
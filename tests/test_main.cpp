@@ -25,12 +25,25 @@ int* generate_random_ints(size_t nbr, size_t modulus)
 #include <catch2/reporters/catch_reporter_registrars.hpp>
 
 #include "matrix.h"
+#include "matrix_view.h"
+#include "fixed_matrix.h"
 #include "result.h"
 #include "products.h"
 #include "stats.h"
 #include "householder.h"
 #include "givens.h"
 #include "gram_schmidt.h"
+#include "workspace.h"
+#include "simd_kernels.h"
+#include "symmetric_matrix.h"
+#include "jacobi.h"
+#include "banded_matrix.h"
+#include "csr_matrix.h"
+#include "triangular_matrix.h"
+#include "matrix_file.h"
+#include "random_matrix.h"
+#include "gemm.h"
+#include "gemv.h"
 #include "tdpool.h"
 
 constexpr size_t mult_pool_size = 6;
@@ -174,6 +187,21 @@ TEST_CASE("qrhfast")
 #ifndef TEST_NONE
 
 //#include "test_mat.cpp"
+#include "test_matrix_storage.cpp"
+#include "test_matrix_view.cpp"
+#include "test_fixed_matrix.cpp"
+#include "test_matrix_expr.cpp"
+#include "test_workspace.cpp"
+#include "test_simd_kernels.cpp"
+#include "test_symmetric_matrix.cpp"
+#include "test_banded_matrix.cpp"
+#include "test_csr_matrix.cpp"
+#include "test_triangular_matrix.cpp"
+#include "test_matrix_file.cpp"
+#include "test_random_matrix.cpp"
+#include "test_gemm.cpp"
+#include "test_strassen.cpp"
+#include "test_gemv.cpp"
 //#include "test_stats.cpp"
 #include "test_householder.cpp"
 #include "test_givens.cpp"
@@ -0,0 +1,50 @@
+//
+//  test_matrix_expr.cpp
+//  Created by Ben Westcott on 10/17/26.
+//
+
+TEST_CASE("matrix expressions")
+{
+    matrix<int> A(3, 4, {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12});
+    matrix<int> B(3, 4, {2, 4, 6, 8, 10, 12, 14, 16, 18, 20, 22, 24});
+    
+    matrix<int> C = A + B - 2 * A;
+    REQUIRE(C == A);
+    
+    A = 2 * A;
+    REQUIRE(A == B);
+    
+    // mixed layouts, column-major destination
+    matrix<int, layout_left> L(A);
+    L -= A + B;
+    REQUIRE(matrix<int>(L) == matrix<int>(-1 * B));
+    
+    // views as operands and destinations
+    matrix_view<int> Asub = A.sub_view(1, 2, 1, 3);
+    Asub -= Asub + B.sub_view(0, 2, 0, 3);
+    REQUIRE(matrix<int>(Asub) == matrix<int>(-1 * B.sub_view(0, 2, 0, 3)));
+    REQUIRE(A(0, 0) == 2);
+    
+    REQUIRE_THROWS(matrix<int>(A + A.transpose()));
+}
+
+TEST_CASE("rank-1 expressions")
+{
+    matrix<double> u = matrix<double>::random_dense_matrix(7, 1, -10, 10);
+    matrix<double> v = matrix<double>::random_dense_matrix(1, 5, -10, 10);
+    matrix<double> X = matrix<double>::random_dense_matrix(7, 5, -10, 10);
+    
+    matrix<double> chk(X);
+    chk -= 0.5 * outer_prod_1D(u, v);
+    
+    matrix<double> Y(X);
+    Y -= 0.5 * outer(u, v);
+    REQUIRE(matrix<double>::abs_max_err(Y, chk) == 0.0);
+    
+    // strided vectors, column-major destination
+    matrix<double, layout_left> Z(X);
+    Z.view() -= 0.5 * outer(matrix<double>(u.transpose()).row_view(0), v.transpose().col_view(0));
+    REQUIRE(matrix<double>::abs_max_err(matrix<double>(Z), chk) == 0.0);
+    
+    REQUIRE_THROWS(outer(X, v));
+}
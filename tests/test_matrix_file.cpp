@@ -0,0 +1,174 @@
+//
+//  test_matrix_file.cpp
+//  Created by Ben Westcott on 10/17/26.
+//
+
+#include <filesystem>
+
+std::string matrix_file_path(char const* name)
+{
+    return (std::filesystem::temp_directory_path() / name).string();
+}
+
+TEST_CASE("matrix file save and map")
+{
+    using matrix_file::map_mode;
+
+    std::string path = matrix_file_path("linalg_test_matrix.bin");
+
+    auto rc = GENERATE(take(3, randmatsize(1, 80, false)));
+    matrix<double> A = matrix<double>::random_dense_matrix(rc.M, rc.N, -10, 10);
+    A.save(path);
+
+    // read only, copies share the mapping, writes detach and leave the file alone
+    matrix<double> R = matrix<double>::mapped(path);
+    REQUIRE(R == A);
+    REQUIRE(R.is_copy_on_write());
+
+    matrix<double> Rc(R);
+    REQUIRE(Rc.is_shared());
+    REQUIRE(std::as_const(Rc).data() == std::as_const(R).data());
+
+    R(0, 0) = 1E6;
+    REQUIRE(!Rc.is_shared());
+    REQUIRE(Rc == A);
+    REQUIRE(R(0, 0) == 1E6);
+
+    // the only user of a read only mapping still copies on its first write
+    Rc *= 2.0;
+    matrix<double> A2(A);
+    A2 *= 2.0;
+    REQUIRE(Rc == A2);
+    REQUIRE(matrix<double>::mapped(path) == A);
+
+    // reserving copies out of the mapping once, later writes stay in place
+    matrix<double> Rr = matrix<double>::mapped(path);
+    Rr.reserve(Rr.capacity() + 8);
+    double const* reserved = std::as_const(Rr).data();
+    Rr(0, 0) = 1E6;
+    REQUIRE(std::as_const(Rr).data() == reserved);
+
+    // private mapping, written in place
+    matrix<double> P = matrix<double>::mapped(path, map_mode::copy_on_write);
+    REQUIRE(P == A);
+    REQUIRE(!P.is_copy_on_write());
+    double const* mapped_data = std::as_const(P).data();
+    P(rc.M - 1, rc.N - 1) = -1E6;
+    REQUIRE(std::as_const(P).data() == mapped_data);
+    REQUIRE(matrix<double>::mapped(path) == A);
+
+    // padding and layout are kept
+    matrix<float, layout_left> F = matrix<float, layout_left>::padded(rc.M, rc.N);
+    F.view().assign(A.view());
+    F.save(path);
+    matrix<float, layout_left> Fm = matrix<float, layout_left>::mapped(path);
+    REQUIRE(Fm.stride() == F.stride());
+    REQUIRE(Fm == F);
+
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("matrix file streaming")
+{
+    std::string path = matrix_file_path("linalg_test_matrix_stream.bin");
+
+    auto rc = GENERATE(take(3, randmatsize(1, 120, false)));
+    matrix<double> A = matrix<double>::random_dense_matrix(rc.M, rc.N, -10, 10);
+
+    // bit exact, in one chunk or several with a short last one
+    A.save(path);
+    REQUIRE(matrix<double>::load(path) == A);
+
+    size_t chunk_lines = 1 + S_RAND(rc.M);
+    A.save(path, true, chunk_lines);
+    REQUIRE(matrix<double>::load(path) == A);
+    REQUIRE(matrix<double>::mapped(path) == A);
+
+    matrix<int, layout_left> I = matrix<int, layout_left>::padded(rc.M, rc.N);
+    I.view().assign(A.view());
+    I.save(path, true, 3);
+    matrix<int, layout_left> Il = matrix<int, layout_left>::load(path);
+    REQUIRE(Il.stride() == I.stride());
+    REQUIRE(Il == I);
+
+    // a flipped bit in the last element fails the last chunk's checksum
+    A.save(path, true, chunk_lines);
+    {
+        std::fstream f(path, std::ios::binary | std::ios::in | std::ios::out);
+        f.seekg(matrix_file::data_alignment + A.size() * sizeof(double) - 1);
+        char c = static_cast<char>(f.get() ^ 1);
+        f.seekp(matrix_file::data_alignment + A.size() * sizeof(double) - 1);
+        f.put(c);
+    }
+    REQUIRE_THROWS(matrix<double>::load(path));
+
+    // without checksums the damage goes unnoticed
+    A.save(path);
+    {
+        std::fstream f(path, std::ios::binary | std::ios::in | std::ios::out);
+        f.seekg(matrix_file::data_alignment + A.size() * sizeof(double) - 1);
+        char c = static_cast<char>(f.get() ^ 1);
+        f.seekp(matrix_file::data_alignment + A.size() * sizeof(double) - 1);
+        f.put(c);
+    }
+    REQUIRE(matrix<double>::load(path) != A);
+
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("matrix file errors")
+{
+    std::string path = matrix_file_path("linalg_test_matrix_err.bin");
+
+    REQUIRE_THROWS(matrix<double>::mapped(matrix_file_path("linalg_no_such_matrix.bin")));
+    REQUIRE_THROWS(matrix<double>::load(matrix_file_path("linalg_no_such_matrix.bin")));
+
+    matrix<double>(3, 4).save(path);
+    REQUIRE_THROWS(matrix<float>::mapped(path));
+    REQUIRE_THROWS(matrix<double, layout_left>::mapped(path));
+    REQUIRE_THROWS(matrix<float>::load(path));
+    REQUIRE(matrix<double>::mapped(path) == matrix<double>(3, 4));
+
+    // truncated
+    std::filesystem::resize_file(path, matrix_file::data_alignment + 8);
+    REQUIRE_THROWS(matrix<double>::mapped(path));
+    REQUIRE_THROWS(matrix<double>::load(path));
+
+    // header fields which don't match the data, with room for what they claim
+    auto corrupt = [&](auto field, auto value, size_t extra)
+    {
+        matrix<double>(3, 4).save(path);
+        std::fstream f(path, std::ios::binary | std::ios::in | std::ios::out);
+        f.seekp(field);
+        f.write(reinterpret_cast<char const*>(&value), sizeof(value));
+        f.seekp(0, std::ios::end);
+        std::vector<char> pad(extra);
+        f.write(pad.data(), pad.size());
+    };
+
+    corrupt(offsetof(matrix_file::header, elem_size), uint32_t(16), 4096);
+    REQUIRE_THROWS(matrix<double>::mapped(path));
+    REQUIRE_THROWS(matrix<double>::load(path));
+
+    corrupt(offsetof(matrix_file::header, elem_size), uint32_t(4), 0);
+    REQUIRE_THROWS(matrix<double>::mapped(path));
+    REQUIRE_THROWS(matrix<double>::load(path));
+
+    // lines * ld * elem_size wraps around to 0
+    corrupt(offsetof(matrix_file::header, ld), uint64_t(1) << 62, 0);
+    REQUIRE_THROWS(matrix<double>::mapped(path));
+    REQUIRE_THROWS(matrix<double>::load(path));
+
+    {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out << "not a matrix file, not at all, but long enough for a header to be read from it";
+    }
+    REQUIRE_THROWS(matrix<double>::mapped(path));
+
+    // empty matrices round trip
+    matrix<double>().save(path);
+    REQUIRE(matrix<double>::mapped(path).size() == 0);
+    REQUIRE(matrix<double>::load(path).size() == 0);
+
+    std::filesystem::remove(path);
+}
@@ -0,0 +1,407 @@
+//
+//  test_matrix_storage.cpp
+//  Created by Ben Westcott on 10/17/26.
+//
+
+TEST_CASE("padded storage")
+{
+    matrix<double> pm = matrix<double>::padded(37, 13);
+    
+    REQUIRE(pm.rows() == 37);
+    REQUIRE(pm.cols() == 13);
+    REQUIRE(pm.size() == 37 * 13);
+    REQUIRE(pm.stride() >= pm.cols());
+    REQUIRE(!pm.is_packed());
+    
+    for(size_t r=0; r < pm.rows(); r++)
+    {
+        REQUIRE(reinterpret_cast<std::uintptr_t>(pm.data() + pm.row_offset(r)) % 64 == 0);
+    }
+    
+    // power of two row lengths get an extra cache line
+    REQUIRE(matrix<double>::padded_stride(512) == 520);
+    REQUIRE(matrix<double>::padded_stride(13) == 16);
+    
+    matrix<double> rm = matrix<double>::random_dense_matrix(37, 13, 100, -100);
+    pm.view().assign(rm);
+    
+    REQUIRE(pm == rm);
+    REQUIRE(rm == pm);
+    
+    matrix<double> pcpy(pm);
+    REQUIRE(pcpy.stride() == pm.stride());
+    REQUIRE(pcpy == rm);
+    
+    pm += rm;
+    pm -= rm;
+    pm *= 2;
+    rm *= 2;
+    REQUIRE(pm == rm);
+    
+    pm.fill(3.0);
+    for(size_t r=0; r < pm.rows(); r++)
+    {
+        for(size_t c=0; c < pm.cols(); c++)
+        {
+            REQUIRE(pm(r, c) == 3.0);
+        }
+    }
+    
+    REQUIRE(pm.transpose().is_packed());
+    REQUIRE(pm.row(5).size() == 13);
+    REQUIRE_THROWS(pm.reshape(13, 37));
+    REQUIRE_THROWS(matrix<double>::with_stride(4, 8, 7));
+}
+
+TEST_CASE("column-major layout")
+{
+    matrix<int> rm(3, 4, {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12});
+    matrix<int, layout_left> cm(3, 4, {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12});
+    
+    const int cm_storage[12] = {1, 5, 9, 2, 6, 10, 3, 7, 11, 4, 8, 12};
+    
+    REQUIRE(cm.stride() == 3);
+    REQUIRE(cm.is_packed());
+    for(size_t i=0; i < cm.size(); i++)
+    {
+        REQUIRE(cm[i] == cm_storage[i]);
+    }
+    
+    for(size_t r=0; r < rm.rows(); r++)
+    {
+        for(size_t c=0; c < rm.cols(); c++)
+        {
+            REQUIRE(cm(r, c) == rm(r, c));
+        }
+    }
+    
+    // conversions go through views
+    REQUIRE(matrix<int>(cm) == rm);
+    REQUIRE(matrix<int, layout_left>(rm) == cm);
+    REQUIRE(matrix<int, layout_left>({{1, 2, 3, 4}, {5, 6, 7, 8}, {9, 10, 11, 12}}) == cm);
+    
+    REQUIRE(matrix<int>(cm.col(2)) == rm.col(2));
+    REQUIRE(matrix<int>(cm.row(1)) == rm.row(1));
+    REQUIRE(matrix<int>(cm.transpose()) == rm.transpose());
+    
+    cm.swap_rows(0, 2);
+    rm.swap_rows(0, 2);
+    cm.sub_rows(1, 0, 2);
+    rm.sub_rows(1, 0, 2);
+    REQUIRE(matrix<int>(cm) == rm);
+    
+    // mixed layouts
+    cm += rm;
+    rm *= 2;
+    REQUIRE(matrix<int>(cm) == rm);
+    
+    auto split = cm.split_cols(1);
+    REQUIRE(matrix<int>(split.first) == rm.sub_matrix(0, 3, 0, 2));
+    REQUIRE(matrix<int>(split.second) == rm.sub_matrix(0, 3, 2, 2));
+    
+    matrix<double, layout_left> pm = matrix<double, layout_left>::padded(13, 37);
+    REQUIRE(pm.stride() == 16);
+    for(size_t c=0; c < pm.cols(); c++)
+    {
+        REQUIRE(reinterpret_cast<std::uintptr_t>(pm.data() + pm.offset(0, c)) % 64 == 0);
+    }
+}
+
+TEST_CASE("assignment reuses storage")
+{
+    matrix<int> m1(6, 4, {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24});
+    
+    // same size reuses the buffer, also across a reshape
+    matrix<int> m2(4, 6);
+    int *m2_ptr = m2.data();
+    m2 = m1;
+    REQUIRE(m2.data() == m2_ptr);
+    REQUIRE(m2.rows() == 6);
+    REQUIRE(m2 == m1);
+    
+    m2 = m2;
+    REQUIRE(m2 == m1);
+    
+    matrix<double> pm = matrix<double>::padded(7, 9);
+    pm.fill(2.0);
+    matrix<double> pcpy = matrix<double>::padded(7, 9);
+    double *pcpy_ptr = pcpy.data();
+    pcpy = pm;
+    REQUIRE(pcpy.data() == pcpy_ptr);
+    REQUIRE(pcpy.stride() == pm.stride());
+    REQUIRE(pcpy == pm);
+    
+    // moves take the buffer and leave the source empty
+    matrix<int> m3(2, 2);
+    int *m1_ptr = m1.data();
+    m3 = std::move(m1);
+    REQUIRE(m3.data() == m1_ptr);
+    REQUIRE(m3 == m2);
+    REQUIRE(m1.size() == 0);
+    REQUIRE(m1.data() == nullptr);
+}
+
+TEST_CASE("resize")
+{
+    matrix<int> m(3, 4, {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12});
+    
+    m.resize(4, 5);
+    REQUIRE(m == matrix<int>(4, 5, {1, 2, 3, 4, 0, 5, 6, 7, 8, 0, 9, 10, 11, 12, 0, 0, 0, 0, 0, 0}));
+    REQUIRE(m.is_packed());
+    
+    // shrinking stays in the same buffer
+    int *ptr = m.data();
+    m.resize(2, 3);
+    REQUIRE(m.data() == ptr);
+    REQUIRE(m == matrix<int>(2, 3, {1, 2, 3, 5, 6, 7}));
+    
+    m.resize(2, 4);
+    REQUIRE(m.data() == ptr);
+    REQUIRE(m == matrix<int>(2, 4, {1, 2, 3, 0, 5, 6, 7, 0}));
+    REQUIRE_THROWS(m.resize(0, 4));
+    
+    m.shrink_to_fit();
+    REQUIRE(m.capacity() == m.size());
+    REQUIRE(m == matrix<int>(2, 4, {1, 2, 3, 0, 5, 6, 7, 0}));
+    
+    matrix<int, layout_left> cm(3, 2, {1, 2, 3, 4, 5, 6});
+    cm.resize(4, 3);
+    REQUIRE(matrix<int>(cm.view()) == matrix<int>(4, 3, {1, 2, 0, 3, 4, 0, 5, 6, 0, 0, 0, 0}));
+    cm.resize(2, 2);
+    REQUIRE(matrix<int>(cm.view()) == matrix<int>(2, 2, {1, 2, 3, 4}));
+    
+    matrix<double> pm = matrix<double>::padded(5, 3);
+    pm.fill(1.0);
+    size_t ld = pm.stride();
+    pm.resize(6, 4);
+    REQUIRE(pm.stride() == ld);
+    REQUIRE(pm(4, 2) == 1.0);
+    REQUIRE(pm(4, 3) == 0.0);
+    REQUIRE(pm(5, 0) == 0.0);
+}
+
+TEST_CASE("append row")
+{
+    matrix<double> X;
+    matrix<double> obs = matrix<double>::random_dense_matrix(200, 7, -10, 10);
+    
+    size_t reallocs = 0;
+    for(size_t r=0; r < obs.rows(); r++)
+    {
+        double *ptr = X.data();
+        X.append_row(obs.row_view(r));
+        reallocs += (X.data() != ptr);
+    }
+    
+    REQUIRE(X == obs);
+    REQUIRE(reallocs < 10);
+    
+    X.append_row(matrix<double>(1, 7));
+    REQUIRE(X.rows() == 201);
+    REQUIRE_THROWS(X.append_row(matrix<double>(1, 6)));
+    
+    // no reallocation at all once reserved
+    matrix<double> Y;
+    Y.reserve(obs.size());
+    double *ptr = Y.data();
+    for(size_t r=0; r < obs.rows(); r++)
+    {
+        Y.append_row(obs.row_view(r));
+    }
+    REQUIRE(Y.data() == ptr);
+    REQUIRE(Y == obs);
+}
+
+TEST_CASE("copy on write")
+{
+    matrix<double> A = matrix<double>::random_dense_matrix(20, 30, -10, 10);
+    matrix<double> const ref(A);
+    
+    // deep copies unless enabled
+    matrix<double> deep(A);
+    REQUIRE(deep.data() != A.data());
+    REQUIRE(!A.is_shared());
+    
+    A.copy_on_write();
+    matrix<double> const B(A);
+    matrix<double> C = B;
+    
+    REQUIRE(C.is_copy_on_write());
+    REQUIRE(std::as_const(C).data() == std::as_const(A).data());
+    REQUIRE(A.is_shared());
+    
+    // reads through const members don't copy, and can't write
+    static_assert(std::is_same_v<decltype(B.data()), double const*>);
+    static_assert(std::is_same_v<decltype(std::as_const(C).col_view(0)), matrix_view<double const>>);
+    REQUIRE(B == ref);
+    REQUIRE(B(3, 4) == ref(3, 4));
+    REQUIRE(std::as_const(C).data() == B.data());
+    
+    // the first write detaches the writer only
+    C(3, 4) = 1000.0;
+    REQUIRE(C.data() != B.data());
+    REQUIRE(B(3, 4) == ref(3, 4));
+    REQUIRE(A == ref);
+    
+    matrix<double> D(B);
+    D.fill(2.0);
+    REQUIRE(B == ref);
+    
+    matrix<double> E(B);
+    E.view().sub_matrix(0, 0) *= 0.0;
+    E += ref;
+    REQUIRE(E == ref);
+    REQUIRE(B == ref);
+    
+    // assignment into a shared matrix doesn't write its buffer
+    matrix<double> F(B);
+    F = deep;
+    REQUIRE(!F.is_copy_on_write());
+    REQUIRE(B == ref);
+    
+    matrix<double> G(B);
+    G.copy_on_write(false);
+    REQUIRE(!G.is_shared());
+    G[0] = 5.0;
+    REQUIRE(B == ref);
+    
+    // shrinking a shared matrix gives it a buffer of its own
+    matrix<double> K(B);
+    K.reserve(2 * K.size());
+    matrix<double> const Kc(K);
+    K.shrink_to_fit();
+    REQUIRE(K.capacity() == K.size());
+    REQUIRE(!K.is_shared());
+    REQUIRE(Kc.capacity() == 2 * K.size());
+    REQUIRE(K == ref);
+    
+    // resizing a shared matrix leaves the others alone
+    matrix<double> H(B);
+    H.resize(10, 10);
+    REQUIRE(B == ref);
+    REQUIRE(H(9, 9) == ref(9, 9));
+}
+
+template<typename M>
+bool is_transpose_of(M const& t, M const& a)
+{
+    if(t.rows() != a.cols() || t.cols() != a.rows())
+    {
+        return false;
+    }
+
+    for(size_t r=0; r < a.rows(); r++)
+    {
+        for(size_t c=0; c < a.cols(); c++)
+        {
+            if(t(c, r) != a(r, c))
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+TEST_CASE("blocked transpose")
+{
+    // sizes around the tile and register block edges
+    size_t sizes[][2] = {{1, 1}, {1, 9}, {9, 1}, {3, 70}, {67, 33}, {64, 64}, {100, 100}, {129, 31}};
+
+    for(auto& s : sizes)
+    {
+        matrix<double> A = matrix<double>::random_dense_matrix(s[0], s[1], -10, 10);
+        REQUIRE(is_transpose_of(A.transpose(), A));
+        REQUIRE(is_transpose_of(A.transpose(mult_pool), A));
+
+        matrix<float> F(matrix<float>::random_dense_matrix(s[0], s[1], -10, 10));
+        REQUIRE(is_transpose_of(F.transpose(), F));
+
+        matrix<int> I = matrix<int>::random_dense_matrix(s[0], s[1], -10, 10);
+        REQUIRE(is_transpose_of(I.transpose(), I));
+
+        matrix<double> P = matrix<double>::padded(s[0], s[1]);
+        P.view().assign(A.view());
+        REQUIRE(is_transpose_of(P.transpose(), P));
+
+        matrix<double, layout_left> L(A.view());
+        REQUIRE(is_transpose_of(L.transpose(), L));
+        REQUIRE(is_transpose_of(L.transpose(mult_pool), L));
+
+        matrix<double> B(A);
+        B.transpose_in_place();
+        REQUIRE(is_transpose_of(B, A));
+
+        matrix<double> C(P);
+        C.transpose_in_place(mult_pool);
+        REQUIRE(is_transpose_of(C, P));
+        if(P.is_square())
+        {
+            REQUIRE(C.stride() == P.stride());
+        }
+    }
+
+    // shared buffers are left alone
+    matrix<double> S = matrix<double>::random_dense_matrix(40, 40, -10, 10);
+    matrix<double> const orig(S);
+    S.copy_on_write();
+    matrix<double> const shared(S);
+    S.transpose_in_place();
+    REQUIRE(is_transpose_of(S, orig));
+    REQUIRE(shared == orig);
+}
+
+template<typename M>
+void check_permutations(M A, size_t M_, size_t N_)
+{
+    M const ref(A.view());
+    
+    std::minstd_rand gen(std::random_device{}());
+    matrix<size_t> rp = matrix<size_t>::unit_permutation_matrix(M_);
+    matrix<size_t> cp = matrix<size_t>::unit_permutation_matrix(N_);
+    std::shuffle(rp.data(), rp.data() + M_, gen);
+    std::shuffle(cp.data(), cp.data() + N_, gen);
+    
+    // rows gather, cols scatter
+    A.permute_rows(rp);
+    A.permute_cols(cp);
+    
+    for(size_t r=0; r < M_; r++)
+    {
+        for(size_t c=0; c < N_; c++)
+        {
+            REQUIRE(A(r, cp(c, 0)) == ref(rp(r, 0), c));
+        }
+    }
+}
+
+TEST_CASE("permute rows and cols")
+{
+    size_t M = S_RAND(100) + 1;
+    size_t N = S_RAND(100) + 1;
+    
+    matrix<double> A = matrix<double>::random_dense_matrix(M, N, -10, 10);
+    check_permutations(A, M, N);
+    check_permutations(matrix<double, layout_left>(A.view()), M, N);
+    
+    matrix<double> P = matrix<double>::padded(M, N);
+    P.view().assign(A.view());
+    check_permutations(P, M, N);
+    
+    matrix<size_t> twice = {0, 0, 1};
+    matrix<size_t> out_of_range = {0, 3, 1};
+    matrix<int> B(3, 3);
+    REQUIRE_THROWS(B.permute_rows(twice));
+    REQUIRE_THROWS(B.permute_cols(out_of_range));
+    REQUIRE_THROWS(B.permute_rows(matrix<size_t>::unit_permutation_matrix(2)));
+    
+    // a shared matrix is copied before permuting
+    matrix<double> S(A);
+    S.copy_on_write();
+    matrix<double> const shared(S);
+    matrix<size_t> rev = matrix<size_t>::unit_permutation_matrix(M);
+    std::reverse(rev.data(), rev.data() + M);
+    S.permute_rows(rev);
+    REQUIRE(shared == A);
+    REQUIRE(S(0, 0) == A(M - 1, 0));
+}
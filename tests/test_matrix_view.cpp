@@ -0,0 +1,162 @@
+//
+//  test_matrix_view.cpp
+//  Created by Ben Westcott on 10/17/26.
+//
+
+TEST_CASE("matrix view read/write")
+{
+    int data[16] = {2, 4, 6, 8, 10, 12, 14, 16, 18, 20, 22, 24, 26, 28, 30, 32};
+    matrix<int> mat(4, 4, data);
+    
+    matrix_view<int> v = mat.view();
+    
+    REQUIRE(v.rows() == 4);
+    REQUIRE(v.cols() == 4);
+    REQUIRE(v.stride() == 4);
+    REQUIRE(v.data() == mat.data());
+    
+    v(1, 2) = -1;
+    REQUIRE(mat(1, 2) == -1);
+    
+    matrix_view<int> sub = mat.sub_view(1, 2, 1, 3);
+    
+    REQUIRE(sub.rows() == 2);
+    REQUIRE(sub.cols() == 3);
+    REQUIRE(sub(0, 0) == 12);
+    REQUIRE(sub(1, 2) == 24);
+    
+    REQUIRE_THROWS(mat.sub_view(3, 2, 0, 1));
+    REQUIRE_THROWS(mat.sub_view(0, 1, 2, 3));
+    
+    sub.fill(0);
+    for(size_t r=0; r < mat.rows(); r++)
+    {
+        for(size_t c=0; c < mat.cols(); c++)
+        {
+            bool inside = (r >= 1 && r < 3 && c >= 1);
+            REQUIRE((mat(r, c) == 0) == inside);
+        }
+    }
+}
+
+TEST_CASE("matrix view row, col, diag")
+{
+    int data[16] = {2, 4, 6, 8, 10, 12, 14, 16, 18, 20, 22, 24, 26, 28, 30, 32};
+    matrix<int> mat(4, 4, data);
+    
+    matrix_view<int> c2 = mat.col_view(2);
+    matrix_view<int> r3 = mat.row_view(3);
+    matrix_view<int> d = mat.diag_view();
+    
+    int cdat[4] = {6, 14, 22, 30};
+    int ddat[4] = {2, 12, 22, 32};
+    
+    for(size_t i=0; i < 4; i++)
+    {
+        REQUIRE(c2[i] == cdat[i]);
+        REQUIRE(r3[i] == data[12 + i]);
+        REQUIRE(d[i] == ddat[i]);
+    }
+    
+    REQUIRE(matrix<int>(c2) == mat.col(2));
+    REQUIRE(matrix<int>(r3) == mat.row(3));
+    
+    matrix_view<int> sc = mat.sub_col_view(1, 2, 3);
+    matrix_view<int> sr = mat.sub_row_view(2, 1, 2);
+    
+    REQUIRE(sc.rows() == 2);
+    REQUIRE(sc[0] == 16);
+    REQUIRE(sc[1] == 24);
+    REQUIRE(sr.cols() == 2);
+    REQUIRE(sr[0] == 20);
+    REQUIRE(sr[1] == 22);
+    
+    d *= 2;
+    REQUIRE(mat(0, 0) == 4);
+    REQUIRE(mat(3, 3) == 64);
+    REQUIRE(mat(0, 1) == 4);
+}
+
+TEST_CASE("matrix view arithmetic")
+{
+    size_t M = S_RAND(50) + 2;
+    size_t N = S_RAND(50) + 2;
+    
+    matrix<int> A = matrix<int>::random_dense_matrix(M, N, -1000, 1000);
+    matrix<int> Acpy(A);
+    matrix<int> B = matrix<int>::random_dense_matrix(M - 1, N - 1, -1000, 1000);
+    
+    A.sub_view(1, 1) += B;
+    
+    for(size_t r=0; r < M; r++)
+    {
+        for(size_t c=0; c < N; c++)
+        {
+            int expected = Acpy(r, c) + ((r && c) ? B(r - 1, c - 1) : 0);
+            REQUIRE(A(r, c) == expected);
+        }
+    }
+    
+    A.sub_view(1, 1) -= B;
+    REQUIRE(A == Acpy);
+    
+    REQUIRE_THROWS(A.sub_view(0, 0) += B);
+    
+    A.sub_view(1, 1).assign(B);
+    REQUIRE(A.sub_matrix(1, 1) == B);
+    REQUIRE(A.row(0) == Acpy.row(0));
+}
+
+TEST_CASE("products on views")
+{
+    size_t M = S_RAND(50) + 2;
+    size_t N = S_RAND(50) + 2;
+    
+    matrix<double> A = matrix<double>::random_dense_matrix(M, N, -1000, 1000);
+    matrix<double> x = matrix<double>::random_dense_matrix(M - 1, 1, -1000, 1000);
+    matrix<double> y = matrix<double>::random_dense_matrix(N - 1, 1, -1000, 1000);
+    
+    matrix<double> Asub = A.sub_matrix(1, 1);
+    matrix_view<double> Aview = A.sub_view(1, 1);
+    
+    REQUIRE(inner_left_prod(x, Aview) == inner_left_prod(x, Asub));
+    REQUIRE(inner_right_prod(Aview, y) == inner_right_prod(Asub, y));
+    REQUIRE(outer_prod_1D(Aview.col(0), y) == outer_prod_1D(Asub.col(0), y));
+    REQUIRE(inner_prod_1D(A.sub_col_view(1, M - 1, 1), x) == inner_prod_1D(Asub.col(0), x));
+    REQUIRE(col_norm2sq(Aview, 0) == col_norm2sq(Asub, 0));
+}
+
+TEST_CASE("matrix view transpose, reverse")
+{
+    int data[12] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12};
+    matrix<int> mat(3, 4, data);
+    
+    matrix_view<int> t = mat.view().transpose();
+    REQUIRE(t.rows() == 4);
+    REQUIRE(t.cols() == 3);
+    REQUIRE(matrix<int>(t) == mat.transpose());
+    
+    matrix_view<int> rr = mat.view().reverse_rows();
+    matrix_view<int> rc = mat.view().reverse_cols();
+    matrix_view<int> rv = mat.view().reverse();
+    
+    for(size_t r=0; r < 3; r++)
+    {
+        for(size_t c=0; c < 4; c++)
+        {
+            REQUIRE(rr(r, c) == mat(2 - r, c));
+            REQUIRE(rc(r, c) == mat(r, 3 - c));
+            REQUIRE(rv(r, c) == mat(2 - r, 3 - c));
+        }
+    }
+    
+    // views of transformed views keep pointing at the original storage
+    rv.sub_matrix(0, 2, 0, 2).fill(0);
+    REQUIRE(mat(2, 3) == 0);
+    REQUIRE(mat(1, 2) == 0);
+    REQUIRE(mat(0, 3) == 4);
+    
+    t.col(0)[1] = -2;
+    REQUIRE(mat(0, 1) == -2);
+    REQUIRE(t.row(1)[0] == -2);
+}
@@ -0,0 +1,150 @@
+//
+//  test_random_matrix.cpp
+//  Created by Ben Westcott on 10/17/26.
+//
+
+// eigenvalues of A^T A, i.e. the squared singular values of A
+matrix<double> squared_singular_values(matrix<double> const& A)
+{
+    matrix<double> At = A.transpose();
+    return transformation::jacobi::eigen(symmetric_matrix<double>(mat_mul_alg1(&At, &A, mult_pool))).values;
+}
+
+TEST_CASE("philox")
+{
+    // known answers from the Random123 distribution
+    REQUIRE(philox::block({0, 0, 0, 0}, {0, 0}) == philox::counter{0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8});
+    REQUIRE(philox::block({0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff}, {0xffffffff, 0xffffffff})
+            == philox::counter{0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd});
+    REQUIRE(philox::block({0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344}, {0xa4093822, 0x299f31d0})
+            == philox::counter{0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1});
+
+    // lanes are the blocks of consecutive counters
+    uint32_t lanes[4][5];
+    philox::blocks<5>(0xfffffffe, 1, 2, 3, {4, 5}, lanes);
+    for(uint32_t l=0; l < 5; l++)
+    {
+        philox::counter c = philox::block({0xfffffffe + l, 1, 2, 3}, {4, 5});
+        REQUIRE(c == philox::counter{lanes[0][l], lanes[1][l], lanes[2][l], lanes[3][l]});
+    }
+
+    philox::engine a(42, 7);
+    philox::engine b(42, 7);
+    philox::engine c(42, 8);
+    for(int i=0; i < 10; i++)
+    {
+        a();
+    }
+    b.seek(2);
+    REQUIRE(a() == (b(), b(), b()));
+    REQUIRE(philox::engine(42, 7)() != c());
+
+    double u = philox::unit(0xffffffff, 0xffffffff);
+    REQUIRE(u < 1.0);
+    REQUIRE(philox::unit(0, 0) == 0.0);
+}
+
+TEST_CASE("random matrix generators")
+{
+    using namespace random_matrix;
+
+    uint64_t seed = std::rand();
+    auto rc = GENERATE(take(3, randmatsize(1, 300, false)));
+
+    // the same on the pool as serially, different for another seed
+    matrix<double> D = dense<double>(rc.M, rc.N, -3, 5, seed);
+    REQUIRE(D == dense<double>(rc.M, rc.N, -3, 5, seed, mult_pool));
+    REQUIRE(D != dense<double>(rc.M, rc.N, -3, 5, seed + 1));
+    for(size_t i=0; i < D.size(); i++)
+    {
+        REQUIRE(D[i] >= -3.0);
+        REQUIRE(D[i] < 5.0);
+    }
+
+    matrix<float> Df = dense<float>(rc.M, rc.N, -3, 5, seed, mult_pool);
+    REQUIRE(Df(rc.M - 1, rc.N - 1) == static_cast<float>(D(rc.M - 1, rc.N - 1)));
+
+    matrix<double> S = symmetric<double>(rc.M, -1, 1, seed, mult_pool);
+    REQUIRE(S.is_symmetric());
+    REQUIRE(S == symmetric<double>(rc.M, -1, 1, seed));
+
+    matrix<double> K = skew_symmetric<double>(rc.M, -1, 1, seed, mult_pool);
+    matrix<double> KKt = K + K.transpose();
+    REQUIRE(KKt == matrix<double>(rc.M, rc.M));
+
+    banded_matrix<double> B = banded<double>(rc.M, 2, 1, -1, 1, seed, mult_pool);
+    REQUIRE(B.full() == banded<double>(rc.M, 2, 1, -1, 1, seed).full());
+    REQUIRE(B.lower_bandwidth() == 2);
+}
+
+TEST_CASE("random matrix distributions")
+{
+    using namespace random_matrix;
+
+    uint64_t seed = std::rand();
+
+    matrix<double> G = normal<double>(400, 500, seed, mult_pool);
+    REQUIRE(G == normal<double>(400, 500, seed));
+
+    double mean = 0.0;
+    double sq = 0.0;
+    for(size_t i=0; i < G.size(); i++)
+    {
+        mean += G[i];
+        sq += G[i] * G[i];
+    }
+    mean /= G.size();
+    sq /= G.size();
+
+    // 2E5 samples, so about 5 standard errors
+    REQUIRE(std::abs(mean) < 0.01);
+    REQUIRE(std::abs(sq - 1.0) < 0.02);
+}
+
+TEST_CASE("random structured matrices")
+{
+    using namespace random_matrix;
+
+    double zero_tol = 1E-10;
+    uint64_t seed = std::rand();
+    size_t N = 2 + S_RAND(30);
+
+    matrix<double> P = spd<double>(N, seed, mult_pool);
+    matrix<double> Pe = transformation::jacobi::eigen(symmetric_matrix<double>(P)).values;
+    for(size_t i=0; i < N; i++)
+    {
+        REQUIRE(Pe[i] > 0.0);
+    }
+
+    matrix<double> Q = orthogonal(N, seed, mult_pool);
+    REQUIRE(Q == orthogonal(N, seed));
+    matrix<double> Qt = Q.transpose();
+    REQUIRE(matrix<double>::abs_max_err(mat_mul_alg1(&Qt, &Q, mult_pool), matrix<double>::eye(N)) < zero_tol);
+
+    // rank r: N - r of the squared singular values vanish
+    size_t r = 1 + S_RAND(N - 1);
+    matrix<double> L = low_rank(N + 3, N, r, seed, mult_pool);
+    REQUIRE(matrix<double>::abs_max_err(L, low_rank(N + 3, N, r, seed)) < zero_tol);
+    matrix<double> Ls = squared_singular_values(L);
+    double lmax = *std::max_element(Ls.data(), Ls.data() + N);
+    size_t nonzero = 0;
+    for(size_t i=0; i < N; i++)
+    {
+        nonzero += (Ls[i] > 1E-8 * lmax);
+    }
+    REQUIRE(nonzero == r);
+    REQUIRE_THROWS(low_rank(4, 3, 4, seed));
+
+    double cond = 1E4;
+    matrix<double> C = with_condition(N, cond, seed, mult_pool);
+    matrix<double> Cs = squared_singular_values(C);
+    double smax = 0.0;
+    double smin = INFINITY;
+    for(size_t i=0; i < N; i++)
+    {
+        smax = std::max(smax, Cs[i]);
+        smin = std::min(smin, Cs[i]);
+    }
+    REQUIRE(std::abs(std::sqrt(smax/smin)/cond - 1.0) < 1E-6);
+    REQUIRE_THROWS(with_condition(N, 0.5, seed));
+}
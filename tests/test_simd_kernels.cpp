@@ -0,0 +1,163 @@
+//
+//  test_simd_kernels.cpp
+//  Created by Ben Westcott on 10/17/26.
+//
+
+// runs f once for every instruction set the cpu has, restores the default after
+template<typename F>
+void for_each_isa(F&& f)
+{
+    simd::isa best = simd::detected_isa();
+    for(simd::isa level : {simd::isa::scalar, simd::isa::sse2, simd::isa::avx2, simd::isa::avx512})
+    {
+        if(level <= best)
+        {
+            simd::set_isa(level);
+            f(level);
+        }
+    }
+    simd::set_isa(best);
+}
+
+template<typename T>
+void check_elementwise_kernels(void)
+{
+    std::minstd_rand gen(std::random_device{}());
+    std::uniform_int_distribution<int> dist(-100, 100);
+
+    // lengths around every vector width and the equal() group size
+    for(size_t n : {0, 1, 3, 7, 8, 15, 16, 17, 31, 33, 63, 64, 65, 127, 200})
+    {
+        std::vector<T> a(n), b(n);
+        for(size_t i=0; i < n; i++)
+        {
+            a[i] = static_cast<T>(dist(gen));
+            b[i] = static_cast<T>(dist(gen));
+        }
+
+        for_each_isa([&](simd::isa)
+        {
+            std::vector<T> x(a);
+
+            simd::add(x.data(), b.data(), n);
+            for(size_t i=0; i < n; i++)
+            {
+                REQUIRE(x[i] == static_cast<T>(a[i] + b[i]));
+            }
+
+            simd::sub(x.data(), b.data(), n);
+            REQUIRE(x == a);
+
+            simd::scale(x.data(), n, static_cast<T>(3));
+            for(size_t i=0; i < n; i++)
+            {
+                REQUIRE(x[i] == static_cast<T>(a[i] * 3));
+            }
+
+            simd::fill(x.data(), n, static_cast<T>(7));
+            REQUIRE(std::count(x.begin(), x.end(), static_cast<T>(7)) == static_cast<ptrdiff_t>(n));
+
+            simd::absdiff(x.data(), a.data(), b.data(), n);
+            for(size_t i=0; i < n; i++)
+            {
+                REQUIRE(x[i] == (a[i] < b[i] ? b[i] - a[i] : a[i] - b[i]));
+            }
+
+            if constexpr(std::is_signed_v<T>)
+            {
+                simd::abs(x.data(), a.data(), n);
+                for(size_t i=0; i < n; i++)
+                {
+                    REQUIRE(x[i] == static_cast<T>(std::abs(a[i])));
+                }
+            }
+
+            REQUIRE(simd::equal(a.data(), a.data(), n));
+
+            // a difference anywhere is found
+            std::vector<T> y(a);
+            for(size_t i=0; i < n; i++)
+            {
+                y[i] += 1;
+                REQUIRE(!simd::equal(a.data(), y.data(), n));
+                y[i] = a[i];
+            }
+        });
+    }
+}
+
+TEST_CASE("simd elementwise kernels")
+{
+    std::cout << "simd: " << simd::isa_name(simd::detected_isa()) << "\n";
+
+    check_elementwise_kernels<double>();
+    check_elementwise_kernels<float>();
+    check_elementwise_kernels<int>();
+    check_elementwise_kernels<int64_t>();
+    check_elementwise_kernels<int16_t>();
+    check_elementwise_kernels<uint8_t>();
+
+    // abs clears the sign like std::abs, also of -0.0 and NaN
+    double nan = std::numeric_limits<double>::quiet_NaN();
+    std::vector<double> s(20, -0.0), t(20);
+    s[3] = -nan;
+    for_each_isa([&](simd::isa)
+    {
+        simd::abs(t.data(), s.data(), s.size());
+        REQUIRE(!std::signbit(t[0]));
+        REQUIRE(!std::signbit(t[19]));
+        REQUIRE(std::isnan(t[3]));
+        REQUIRE(!std::signbit(t[3]));
+        REQUIRE(!simd::equal(s.data(), s.data(), s.size()));
+    });
+}
+
+TEST_CASE("simd matrix elementwise")
+{
+    matrix<double> A = matrix<double>::random_dense_matrix(37, 29, -10, 10);
+    matrix<double> B = matrix<double>::random_dense_matrix(37, 29, -10, 10);
+
+    matrix<double> PA = matrix<double>::padded(37, 29);
+    PA.view().assign(A.view());
+    matrix<double> PB = matrix<double>::padded(37, 29);
+    PB.view().assign(B.view());
+
+    for_each_isa([&](simd::isa)
+    {
+        // packed and padded take different paths, and must agree with the views
+        matrix<double> sum(A);
+        sum += B;
+        matrix<double> psum(PA);
+        psum += PB;
+        matrix<double> vsum(A);
+        vsum.view() += B.view();
+        REQUIRE(sum == vsum);
+        REQUIRE(psum == vsum);
+
+        psum -= PB;
+        vsum.view() -= B.view();
+        REQUIRE(psum == vsum);
+
+        psum *= 2.0;
+        vsum.view() *= 2.0;
+        REQUIRE(psum == vsum);
+
+        matrix<double> ad = matrix<double>::absdiff(PA, PB);
+        REQUIRE(ad.is_packed());
+        REQUIRE(ad == matrix<double>::abs(A - B));
+        REQUIRE(matrix<double>::abs(PA) == matrix<double>::abs(A));
+
+        PA.fill(1.5);
+        REQUIRE(PA(36, 28) == 1.5);
+        PA.view().assign(A.view());
+        REQUIRE(PA == A);
+
+        matrix<int, layout_left> L(matrix<int>::random_dense_matrix(17, 5, -10, 10).view());
+        matrix<int, layout_left> L2(L);
+        L2 += L;
+        L2 -= L;
+        REQUIRE(L2 == L);
+    });
+
+    REQUIRE_THROWS(matrix<double>::absdiff(A, matrix<double>(29, 37)));
+}
@@ -0,0 +1,84 @@
+//
+//  test_strassen.cpp
+//  Created by Ben Westcott on 10/17/26.
+//
+
+/*
+ * Small leaf sizes, so that a few levels and every kind of peeling run on
+ * small matrices. Integers are exact, which checks the schedule itself.
+ */
+TEST_CASE("strassen")
+{
+    std::minstd_rand gen(std::random_device{}());
+
+    struct dims { size_t M, N, K; };
+    for(dims d : std::initializer_list<dims>{{1, 1, 1}, {8, 8, 8}, {16, 16, 16}, {33, 17, 25}, {40, 41, 39}, {64, 9, 100}})
+    {
+        matrix<int> A = small_ints<int>(d.M, d.K, gen);
+        matrix<int> B = small_ints<int>(d.K, d.N, gen);
+        matrix<int> R = naive_gemm<int>(1, A, B, 0, matrix<int>(d.M, d.N));
+
+        for(size_t leaf : {1, 2, 4, 7, 512})
+        {
+            REQUIRE(mat_mul_strassen(A, B, leaf) == R);
+
+            matrix<int, layout_left> Af(A);
+            matrix<int, layout_left> Cf(d.M, d.N);
+            mat_mul_strassen(Af, B, Cf.view(), leaf);
+            REQUIRE(matrix<int>(Cf) == R);
+
+            // 1, 7 and 49 parallel products
+            for(size_t workers : {1, 3, 8})
+            {
+                tdpool pool(workers);
+                REQUIRE(mat_mul_strassen(A, B, pool, leaf) == R);
+            }
+        }
+    }
+
+    matrix<int> A(4, 5), B(4, 5);
+    REQUIRE_THROWS(mat_mul_strassen(A, B));
+    REQUIRE_THROWS(mat_mul_strassen(A, B, mult_pool));
+    REQUIRE_THROWS(mat_mul_strassen(A, A.transpose(), matrix<int>(4, 5).view()));
+}
+
+TEST_CASE("strassen error")
+{
+    std::minstd_rand gen(std::random_device{}());
+    size_t n = 300;
+
+    matrix<double> A = random_matrix::dense<double>(n, n, -1, 1, gen());
+    matrix<double> B = random_matrix::dense<double>(n, n, -1, 1, gen());
+    matrix<double> C(n, n);
+    mat_mul(1.0, A, B, 0.0, C.view());
+
+    // normwise, relative to n max|A| max|B| <= n, a few levels in
+    double scale = static_cast<double>(n);
+    for(size_t leaf : {16, 64})
+    {
+        REQUIRE(strassen_detail::levels(n, n, n, leaf) >= 2);
+        REQUIRE(gemm_err(mat_mul_strassen(A, B, leaf), C)/scale < 1e-13);
+        REQUIRE(gemm_err(mat_mul_strassen(A, B, mult_pool, leaf), C)/scale < 1e-13);
+    }
+}
+
+TEST_CASE("strassen workspace")
+{
+    matrix<double> A = random_matrix::dense<double>(200, 150, -1, 1, 1);
+    matrix<double> B = random_matrix::dense<double>(150, 170, -1, 1, 2);
+    matrix<double> C(200, 170);
+
+    workspace ws;
+    workspace::scope use(ws);
+
+    mat_mul_strassen(A, B, C.view(), 32);
+    mat_mul_strassen(A, B, C.view(), mult_pool, 32);
+    size_t blocks = ws.blocks();
+    size_t capacity = ws.capacity();
+
+    // later calls reuse the arena
+    mat_mul_strassen(A, B, C.view(), 32);
+    mat_mul_strassen(A, B, C.view(), mult_pool, 32);
+    REQUIRE(ws.blocks() == blocks);
+    REQUIRE(ws.capacity() == capacity);
+}
@@ -0,0 +1,140 @@
+//
+//  test_symmetric_matrix.cpp
+//  Created by Ben Westcott on 10/17/26.
+//
+
+matrix<double> random_symmetric(size_t N)
+{
+    matrix<double> A = matrix<double>::random_dense_matrix(N, N, -100, 100);
+    return A + A.transpose();
+}
+
+// largest |a_ij|, to scale rounding error bounds
+double abs_max(matrix<double> const& A)
+{
+    return matrix<double>::abs_max_err(A, matrix<double>(A.rows(), A.cols()));
+}
+
+TEST_CASE("symmetric matrix storage")
+{
+    symmetric_matrix<double> E(0);
+    REQUIRE(E.rows() == 0);
+    REQUIRE(symmetric_matrix<double>::packed_size(5) == 15);
+
+    // offsets walk the packed upper triangle row by row
+    symmetric_matrix<int> P(5);
+    size_t o = 0;
+    for(size_t i=0; i < 5; i++)
+    {
+        for(size_t j=i; j < 5; j++, o++)
+        {
+            REQUIRE(P.offset(i, j) == o);
+            REQUIRE(P.offset(j, i) == o);
+        }
+        REQUIRE(P.upper_row_view(i).cols() == 5 - i);
+    }
+
+    P(3, 1) = 7;
+    REQUIRE(P(1, 3) == 7);
+    REQUIRE(P.upper_row_view(1)(0, 2) == 7);
+
+    size_t N = 2 + S_RAND(40);
+    matrix<double> A = random_symmetric(N);
+    symmetric_matrix<double> S(A);
+    REQUIRE(S.full() == A);
+
+    // the lower triangle is not read
+    matrix<double> U(A);
+    U.fill_lower_triangle(0.0);
+    REQUIRE(symmetric_matrix<double>(U) == S);
+    REQUIRE(symmetric_matrix<double>(A.view()) == S);
+    REQUIRE_THROWS(symmetric_matrix<double>(matrix<double>(3, 4)));
+
+    symmetric_matrix<double> T(S);
+    T += S;
+    T *= 0.5;
+    REQUIRE(T == S);
+    T -= S;
+    REQUIRE(T.full() == matrix<double>(N, N));
+    REQUIRE(symmetric_matrix<double>::eye(N).full() == matrix<double>::eye(N));
+    REQUIRE_THROWS(T += symmetric_matrix<double>(N + 1));
+
+    // y = 2 A x - y, against the dense product. The two sum in different
+    // orders, so they agree to about n eps |A| |x|
+    matrix<double> x = matrix<double>::random_dense_matrix(N, 1, -10, 10);
+    matrix<double> y = matrix<double>::random_dense_matrix(N, 1, -10, 10);
+    double eps = std::numeric_limits<double>::epsilon();
+    double zero_tol = 4 * N * eps * abs_max(A) * (2 * abs_max(x) + abs_max(y));
+    matrix<double> chk = inner_right_prod(A, x);
+    chk *= 2.0;
+    chk -= y;
+    sym_mat_vec(2.0, S, x, -1.0, y.view());
+    REQUIRE(matrix<double>::abs_max_err(y, chk) < zero_tol);
+    REQUIRE(matrix<double>::abs_max_err(sym_mat_vec(S, x), inner_right_prod(A, x)) < zero_tol);
+    REQUIRE_THROWS(sym_mat_vec(S, matrix<double>(N + 1, 1)));
+}
+
+TEST_CASE("symmetric rank k update")
+{
+    double zero_tol = 1E-10;
+
+    size_t N = 2 + S_RAND(40);
+    size_t K = 1 + S_RAND(20);
+    matrix<double> V = matrix<double>::random_dense_matrix(N, K, -10, 10);
+    matrix<double> Vt = V.transpose();
+    matrix<double> VVt = mat_mul_alg1(&V, &Vt, mult_pool);
+
+    matrix<double> A = random_symmetric(N);
+
+    symmetric_matrix<double> C(A);
+    sym_rank_k_update(1.0, V, 0.0, C);
+    REQUIRE(matrix<double>::abs_max_err(C.full(), VVt) < zero_tol);
+
+    C = symmetric_matrix<double>(A);
+    sym_rank_k_update(1.0, V, 1.0, C);
+    REQUIRE(matrix<double>::abs_max_err(C.full(), A + VVt) < zero_tol);
+
+    C = symmetric_matrix<double>(A);
+    sym_rank_k_update(-2.0, V, 0.5, C);
+    matrix<double> chk(A);
+    chk *= 0.5;
+    VVt *= 2.0;
+    chk -= VVt;
+    REQUIRE(matrix<double>::abs_max_err(C.full(), chk) < zero_tol);
+
+    symmetric_matrix<double> W(N + 1);
+    REQUIRE_THROWS(sym_rank_k_update(1.0, V, 1.0, W));
+}
+
+TEST_CASE("jacobi eigen")
+{
+    using namespace transformation::jacobi;
+
+    double zero_tol = 1E-10;
+
+    auto N = GENERATE(1, 2, 3, 17, 60);
+    matrix<double> A = random_symmetric(N);
+
+    auto res = eigen(symmetric_matrix<double>(A));
+    matrix<double> Q = res.vectors;
+    matrix<double> QT = Q.transpose();
+
+    // A Q = Q diag(values), Q^T Q = I
+    matrix<double> AQ = mat_mul_alg1(&A, &Q, mult_pool);
+    matrix<double> QL(Q);
+    for(size_t j=0; j < QL.cols(); j++)
+    {
+        for(size_t i=0; i < QL.rows(); i++)
+        {
+            QL(i, j) *= res.values(0, j);
+        }
+    }
+
+    REQUIRE(matrix<double>::abs_max_err(AQ, QL) < zero_tol);
+    REQUIRE(matrix<double>::abs_max_err(mat_mul_alg1(&QT, &Q, mult_pool), matrix<double>::eye(N)) < zero_tol);
+
+    // the dense overload reads only the upper triangle
+    matrix<double> U(A);
+    U.fill_lower_triangle(0.0);
+    REQUIRE(eigen(U).values == res.values);
+}
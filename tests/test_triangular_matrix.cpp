@@ -0,0 +1,121 @@
+//
+//  test_triangular_matrix.cpp
+//  Created by Ben Westcott on 10/17/26.
+//
+
+// dense copy of A's triangle, with a unit diagonal if unit, well conditioned
+matrix<double> random_triangle(size_t N, triangle uplo, bool unit)
+{
+    matrix<double> A = matrix<double>::random_dense_matrix(N, N, -1, 1);
+    for(size_t i=0; i < N; i++)
+    {
+        for(size_t j=0; j < N; j++)
+        {
+            if((uplo == triangle::upper) ? j < i : j > i)
+            {
+                A(i, j) = 0.0;
+            }
+        }
+        A(i, i) = unit ? 1.0 : 4.0 + A(i, i);
+    }
+    return A;
+}
+
+template<triangle Uplo, diagonal Diag>
+void check_triangular(size_t N)
+{
+    double zero_tol = 1E-10;
+    bool unit = (Diag == diagonal::unit);
+
+    matrix<double> A = random_triangle(N, Uplo, unit);
+    triangular_matrix<double, Uplo, Diag> T(A);
+
+    REQUIRE(T.full() == A);
+    REQUIRE(triangular_matrix<double, Uplo, Diag>::packed_size(N) == (unit ? N * (N - 1)/2 : N * (N + 1)/2));
+
+    // offsets walk the packed triangle row by row
+    size_t o = 0;
+    for(size_t i=0; i < N; i++)
+    {
+        for(size_t j=T.first_col(i); j < T.last_col(i); j++, o++)
+        {
+            REQUIRE(T.offset(i, j) == o);
+            REQUIRE(T.entry(i, j) == A(i, j));
+        }
+    }
+    REQUIRE(o == T.packed_size(N));
+
+    // only the triangle is read
+    matrix<double> D = A;
+    D += matrix<double>::random_dense_matrix(N, N, 1, 2);
+    for(size_t i=0; i < N; i++)
+    {
+        for(size_t j=T.first_col(i); j < T.last_col(i); j++)
+        {
+            D(i, j) = A(i, j);
+        }
+    }
+    REQUIRE(triangular_matrix<double, Uplo, Diag>(D) == T);
+
+    matrix<double> x = matrix<double>::random_dense_matrix(N, 1, -10, 10);
+    matrix<double> Ax = inner_right_prod(A, x);
+
+    matrix<double> y(x);
+    tri_mat_vec(T, y.view());
+    REQUIRE(matrix<double>::abs_max_err(y, Ax) < zero_tol);
+    tri_solve(T, y.view());
+    REQUIRE(matrix<double>::abs_max_err(y, x) < zero_tol);
+
+    matrix<double> B = matrix<double>::random_dense_matrix(N, 5, -10, 10);
+    matrix<double> AB = mat_mul_alg1(&A, &B, mult_pool);
+
+    matrix<double> C(B);
+    tri_mat_mul(T, C.view());
+    REQUIRE(matrix<double>::abs_max_err(C, AB) < zero_tol);
+    tri_mat_solve(T, C.view());
+    REQUIRE(matrix<double>::abs_max_err(C, B) < zero_tol);
+
+    // a column of a larger matrix
+    matrix<double, layout_left> W(N, 3);
+    W.col_view(1).assign(x.view());
+    tri_mat_vec(T, W.col_view(1));
+    REQUIRE(matrix<double>::abs_max_err(matrix<double>(W.col_view(1)), Ax) < zero_tol);
+
+    REQUIRE_THROWS(tri_solve(T, matrix<double>(N + 1, 1).view()));
+}
+
+TEST_CASE("triangular matrix")
+{
+    size_t N = 1 + S_RAND(60);
+
+    check_triangular<triangle::upper, diagonal::non_unit>(N);
+    check_triangular<triangle::upper, diagonal::unit>(N);
+    check_triangular<triangle::lower, diagonal::non_unit>(N);
+    check_triangular<triangle::lower, diagonal::unit>(N);
+
+    REQUIRE_THROWS(triangular_matrix<double>(matrix<double>(3, 4)));
+}
+
+TEST_CASE("QR with packed R")
+{
+    using namespace transformation::house;
+
+    double zero_tol = 1E-11;
+
+    auto rc = GENERATE(take(5, rd_randmatsize(2, 80)));
+    matrix<double> A = matrix<double>::random_dense_matrix(rc.M, rc.N, -100, 100);
+
+    auto full = QR(A);
+    auto packed = QR_packed(A);
+
+    REQUIRE(packed.R.rows() == rc.N);
+    REQUIRE(packed.Q == full.Q);
+    REQUIRE(packed.R.full() == matrix<double>(full.Y.view().sub_matrix(0, rc.N, 0, rc.N)));
+
+    // A = Q(:, 0:N) R
+    matrix<double> QR1(full.Q.view().sub_matrix(0, rc.M, 0, rc.N));
+    matrix<double> R1 = packed.R.full();
+    REQUIRE(matrix<double>::abs_max_err(mat_mul_alg1(&QR1, &R1, mult_pool), A) < zero_tol * 1E3);
+
+    REQUIRE_THROWS(QR_packed(matrix<double>(3, 4)));
+}
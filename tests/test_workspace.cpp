@@ -0,0 +1,94 @@
+//
+//  test_workspace.cpp
+//  Created by Ben Westcott on 10/17/26.
+//
+
+TEST_CASE("workspace arena")
+{
+    workspace ws(1024);
+    
+    void* p = ws.allocate(100);
+    void* q = ws.allocate(8);
+    REQUIRE(reinterpret_cast<std::uintptr_t>(p) % workspace::alignment == 0);
+    REQUIRE(reinterpret_cast<std::uintptr_t>(q) % workspace::alignment == 0);
+    REQUIRE(q != p);
+    
+    // grows by adding blocks, and reuses them after a rewind
+    workspace::mark m = ws.position();
+    ws.allocate(4096);
+    REQUIRE(ws.blocks() == 2);
+    
+    ws.rewind(m);
+    REQUIRE(ws.allocate(8) == static_cast<std::byte*>(q) + workspace::alignment);
+    ws.allocate(4096);
+    REQUIRE(ws.blocks() == 2);
+    
+    ws.reset();
+    REQUIRE(ws.allocate(8) == p);
+    
+    // ws_matrix takes storage from the current workspace only
+    REQUIRE(workspace::current() == nullptr);
+    {
+        workspace::scope use(ws);
+        REQUIRE(workspace::current() == &ws);
+        
+        workspace::mark before = ws.position();
+        {
+            workspace::frame frame;
+            ws_matrix<double> A(4, 4);
+            A.set_identity();
+            REQUIRE(ws.position().offset > before.offset);
+            REQUIRE(A == ws_matrix<double>::eye(4));
+        }
+        REQUIRE(ws.position().offset == before.offset);
+    }
+    REQUIRE(workspace::current() == nullptr);
+    
+    ws_matrix<double> B = ws_matrix<double>::eye(3);
+    REQUIRE(B(2, 2) == 1.0);
+}
+
+TEST_CASE("factorizations in a workspace")
+{
+    matrix<double> A = matrix<double>::random_dense_matrix(60, 40, -100, 100);
+    
+    result::QR<double> expected = transformation::house::QR(A);
+    result::QL<double> expected_ql = transformation::house::QL(A);
+    result::QR<double> expected_gs = transformation::GS::QR(A);
+    
+    matrix<double> S = matrix<double>::random_dense_matrix(30, 30, -10, 10);
+    transformation::eigen_result expected_eig = transformation::jacobi::eigen(S);
+    
+    workspace ws;
+    size_t blocks = 0;
+    
+    for(size_t i=0; i < 5; i++)
+    {
+        workspace::scope use(ws);
+        
+        result::QR<double> res = transformation::house::QR(A);
+        REQUIRE(res.Y == expected.Y);
+        REQUIRE(res.Q == expected.Q);
+        
+        result::QL<double> ql = transformation::house::QL(A);
+        REQUIRE(ql.Y == expected_ql.Y);
+        
+        result::QR<double> gs = transformation::GS::QR(A);
+        REQUIRE(gs.Q == expected_gs.Q);
+        
+        transformation::eigen_result eig = transformation::jacobi::eigen(S);
+        REQUIRE(eig.values == expected_eig.values);
+        REQUIRE(eig.vectors == expected_eig.vectors);
+        
+        // every call hands its temporaries back
+        REQUIRE(ws.position().block == 0);
+        REQUIRE(ws.position().offset == 0);
+        
+        // and after the first round the arena doesn't grow any more
+        if(i == 0)
+        {
+            blocks = ws.blocks();
+        }
+        REQUIRE(ws.blocks() == blocks);
+    }
+}